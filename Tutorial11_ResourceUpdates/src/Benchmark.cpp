@@ -0,0 +1,205 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#include "Benchmark.hpp"
+
+namespace Diligent
+{
+
+void ScriptedPlayerPath::Initialize(Uint32 Seed, float HalfExtent)
+{
+    m_Gen.seed(Seed);
+    m_HalfExtent = HalfExtent;
+    NextWaypoint();
+}
+
+void ScriptedPlayerPath::NextWaypoint()
+{
+    std::uniform_real_distribution<float> Coord{-m_HalfExtent, m_HalfExtent};
+    m_Waypoint.x = Coord(m_Gen);
+    m_Waypoint.y = Coord(m_Gen);
+}
+
+float2 ScriptedPlayerPath::GetMoveDirection(float PlayerX, float PlayerZ)
+{
+    float dx   = m_Waypoint.x - PlayerX;
+    float dz   = m_Waypoint.y - PlayerZ;
+    float Dist = std::sqrt(dx * dx + dz * dz);
+    if (Dist < 0.5f)
+    {
+        NextWaypoint();
+        dx   = m_Waypoint.x - PlayerX;
+        dz   = m_Waypoint.y - PlayerZ;
+        Dist = std::sqrt(dx * dx + dz * dz);
+    }
+    return Dist > 1e-4f ? float2{dx / Dist, dz / Dist} : float2{0, 0};
+}
+
+void BenchmarkRecorder::Reset(Uint32 NumFrames, Uint32 WarmupFrames)
+{
+    m_NumFrames    = NumFrames;
+    m_WarmupFrames = WarmupFrames;
+    m_NumAdded     = 0;
+    m_Samples.clear();
+    m_Samples.reserve(NumFrames);
+}
+
+void BenchmarkRecorder::AddFrame(const FrameSample& Sample)
+{
+    if (m_NumAdded++ >= m_WarmupFrames && m_Samples.size() < m_NumFrames)
+        m_Samples.push_back(Sample);
+}
+
+namespace
+{
+
+struct Summary
+{
+    double Min = 0, Avg = 0, P50 = 0, P95 = 0, P99 = 0, Max = 0;
+};
+
+// #Percentiles por rango mas cercano
+Summary Summarize(std::vector<double> Values)
+{
+    Summary S;
+    if (Values.empty())
+        return S;
+
+    std::sort(Values.begin(), Values.end());
+    const auto Percentile = [&](double p) {
+        const size_t Rank = static_cast<size_t>(std::ceil(p * Values.size()));
+        return Values[std::min(std::max(Rank, size_t{1}), Values.size()) - 1];
+    };
+
+    S.Min = Values.front();
+    S.Max = Values.back();
+    for (double v : Values)
+        S.Avg += v;
+    S.Avg /= Values.size();
+    S.P50 = Percentile(0.50);
+    S.P95 = Percentile(0.95);
+    S.P99 = Percentile(0.99);
+    return S;
+}
+
+void WriteSummary(std::ofstream& File, const char* Name, const Summary& S, bool Last, const char* Indent = "    ")
+{
+    File << Indent << "\"" << Name << "\": {"
+         << "\"min\": " << S.Min << ", \"avg\": " << S.Avg << ", \"p50\": " << S.P50
+         << ", \"p95\": " << S.P95 << ", \"p99\": " << S.P99 << ", \"max\": " << S.Max << "}"
+         << (Last ? "\n" : ",\n");
+}
+
+} // namespace
+
+bool BenchmarkRecorder::WriteJSON(const std::string& Path, const std::vector<std::pair<std::string, std::string>>& Info) const
+{
+    std::ofstream File{Path};
+    if (!File)
+        return false;
+
+    std::vector<double> CPUTime, FrameTime, DrawCalls, UploadBytes, BentTufts, TrampleRegions, TrampleBytes, InteractionMs, TuftTests;
+    std::vector<double> FrameSlotWait, InputToPresent, InputToGpu, GpuMemory;
+    for (const auto& Sample : m_Samples)
+    {
+        CPUTime.push_back(Sample.CPUTimeMs);
+        FrameTime.push_back(Sample.FrameTimeMs);
+        DrawCalls.push_back(Sample.DrawCalls);
+        UploadBytes.push_back(static_cast<double>(Sample.UploadBytes));
+        BentTufts.push_back(Sample.BentTufts);
+        TrampleRegions.push_back(Sample.TrampleRegions);
+        TrampleBytes.push_back(static_cast<double>(Sample.TrampleUploadBytes));
+        InteractionMs.push_back(Sample.InteractionMs);
+        TuftTests.push_back(Sample.TuftTests);
+        FrameSlotWait.push_back(Sample.FrameSlotWaitMs);
+        GpuMemory.push_back(static_cast<double>(Sample.GpuMemoryBytes));
+        if (Sample.InputToPresentMs >= 0)
+            InputToPresent.push_back(Sample.InputToPresentMs);
+        if (Sample.InputToGpuMs >= 0)
+            InputToGpu.push_back(Sample.InputToGpuMs);
+    }
+
+    File << "{\n  \"config\": {\n";
+    for (size_t i = 0; i < Info.size(); ++i)
+        File << "    \"" << Info[i].first << "\": " << Info[i].second << (i + 1 < Info.size() ? ",\n" : "\n");
+    File << "  },\n";
+    File << "  \"frames\": " << m_Samples.size() << ",\n";
+    File << "  \"warmup_frames\": " << m_WarmupFrames << ",\n";
+    File << "  \"stats\": {\n";
+    WriteSummary(File, "cpu_frame_time_ms", Summarize(std::move(CPUTime)), false);
+    WriteSummary(File, "frame_time_ms", Summarize(std::move(FrameTime)), false);
+    WriteSummary(File, "draw_calls", Summarize(std::move(DrawCalls)), false);
+    WriteSummary(File, "upload_bytes", Summarize(std::move(UploadBytes)), false);
+    WriteSummary(File, "bent_tufts", Summarize(std::move(BentTufts)), false);
+    WriteSummary(File, "trample_regions", Summarize(std::move(TrampleRegions)), false);
+    WriteSummary(File, "trample_upload_bytes", Summarize(std::move(TrampleBytes)), false);
+    WriteSummary(File, "interaction_ms", Summarize(std::move(InteractionMs)), false);
+    WriteSummary(File, "interaction_tuft_tests", Summarize(std::move(TuftTests)), false);
+    WriteSummary(File, "frame_slot_wait_ms", Summarize(std::move(FrameSlotWait)), false);
+    WriteSummary(File, "input_to_present_ms", Summarize(std::move(InputToPresent)), false);
+    WriteSummary(File, "input_to_gpu_ms", Summarize(std::move(InputToGpu)), false);
+    WriteSummary(File, "gpu_memory_bytes", Summarize(std::move(GpuMemory)), true);
+    File << "  },\n";
+
+    // #Solo cuentan los frames que ya tenian resultado de la query
+    File << "  \"gpu_passes\": {\n";
+    for (Uint32 p = 0; p < GpuPassQueries::PASS_COUNT; ++p)
+    {
+        const auto          Pass = static_cast<GpuPassQueries::PASS>(p);
+        std::vector<double> GPUTime, VSInvocations, Primitives, PSInvocations;
+        for (const auto& Sample : m_Samples)
+        {
+            const auto& PassStats = Sample.GPUPasses[p];
+            if (PassStats.GPUTimeMs >= 0)
+                GPUTime.push_back(PassStats.GPUTimeMs);
+            if (PassStats.HasPipelineStats)
+            {
+                VSInvocations.push_back(static_cast<double>(PassStats.VSInvocations));
+                Primitives.push_back(static_cast<double>(PassStats.ClippingPrimitives));
+                PSInvocations.push_back(static_cast<double>(PassStats.PSInvocations));
+            }
+        }
+
+        File << "    \"" << GpuPassQueries::GetPassName(Pass) << "\": {\n";
+        File << "      \"timed_frames\": " << GPUTime.size() << ",\n";
+        File << "      \"pipeline_stats_frames\": " << PSInvocations.size() << ",\n";
+        WriteSummary(File, "gpu_time_ms", Summarize(std::move(GPUTime)), false, "      ");
+        WriteSummary(File, "vs_invocations", Summarize(std::move(VSInvocations)), false, "      ");
+        WriteSummary(File, "primitives", Summarize(std::move(Primitives)), false, "      ");
+        WriteSummary(File, "ps_invocations", Summarize(std::move(PSInvocations)), true, "      ");
+        File << "    }" << (p + 1 < GpuPassQueries::PASS_COUNT ? ",\n" : "\n");
+    }
+    File << "  }\n}\n";
+
+    return static_cast<bool>(File);
+}
+
+} // namespace Diligent
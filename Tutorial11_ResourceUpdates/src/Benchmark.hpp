@@ -0,0 +1,102 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "BasicMath.hpp"
+#include "GpuPassQueries.hpp"
+
+namespace Diligent
+{
+
+// #Camino del jugador para el benchmark: va de un punto al azar a otro dentro del campo.
+// Con la misma semilla siempre sale el mismo camino
+class ScriptedPlayerPath
+{
+public:
+    void Initialize(Uint32 Seed, float HalfExtent);
+
+    // #Direccion (normalizada) hacia el punto actual desde (PlayerX, PlayerZ). Al llegar pasa al siguiente
+    float2 GetMoveDirection(float PlayerX, float PlayerZ);
+
+private:
+    void NextWaypoint();
+
+    std::mt19937 m_Gen;
+    float        m_HalfExtent = 0;
+    float2       m_Waypoint;
+};
+
+// #Junta las estadisticas de cada frame del benchmark y las escribe como JSON
+class BenchmarkRecorder
+{
+public:
+    struct FrameSample
+    {
+        double CPUTimeMs   = 0; // #Update() + Render() de la muestra
+        double FrameTimeMs = 0; // #Entre un Update() y el siguiente (incluye Present)
+        Uint32 DrawCalls   = 0;
+        Uint64 UploadBytes = 0; // #UpdateBuffer() + Map()
+        Uint32 BentTufts   = 0;
+
+        Uint32 TrampleRegions     = 0; // #Rectangulos del trample mask subidos en el frame
+        Uint64 TrampleUploadBytes = 0; // #Ya estan incluidos en UploadBytes
+
+        double InteractionMs = 0; // #Bend de los cuerpos sobre el pasto, sumado en los ticks del frame
+        Uint32 TuftTests     = 0; // #Del ultimo tick
+
+        double FrameSlotWaitMs  = 0;  // #Lo que se espero a la GPU por el limite de frames en vuelo
+        double InputToPresentMs = -1; // #-1 si en la muestra no termino ningun frame medido (ver FramePacer)
+        double InputToGpuMs     = -1;
+
+        Uint64 GpuMemoryBytes = 0; // #Estimacion de GpuMemoryRegistry al principio del frame
+
+        // #Resultados de las queries de GPU de cada pasada (llegan con unos frames de retraso)
+        GpuPassQueries::PassStats GPUPasses[GpuPassQueries::PASS_COUNT];
+    };
+
+    void Reset(Uint32 NumFrames, Uint32 WarmupFrames);
+
+    // #Los primeros WarmupFrames no cuentan
+    void AddFrame(const FrameSample& Sample);
+    bool IsComplete() const { return m_NumAdded >= m_WarmupFrames + m_NumFrames; }
+
+    // #Info son pares nombre/valor (ya en JSON) que se copian tal cual en "config"
+    bool WriteJSON(const std::string& Path, const std::vector<std::pair<std::string, std::string>>& Info) const;
+
+private:
+    Uint32                   m_NumFrames    = 0;
+    Uint32                   m_WarmupFrames = 0;
+    Uint32                   m_NumAdded     = 0;
+    std::vector<FrameSample> m_Samples;
+};
+
+} // namespace Diligent
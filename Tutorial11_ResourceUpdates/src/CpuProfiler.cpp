@@ -0,0 +1,239 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include <algorithm>
+#include <fstream>
+
+#include "CpuProfiler.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+const auto ProfilerEpoch = std::chrono::steady_clock::now();
+
+void WriteJSONString(std::ofstream& File, const char* Str)
+{
+    File << '"';
+    for (; *Str != '\0'; ++Str)
+    {
+        if (*Str == '"' || *Str == '\\')
+            File << '\\';
+        File << *Str;
+    }
+    File << '"';
+}
+
+} // namespace
+
+std::atomic<bool> CpuProfiler::sm_Enabled{true};
+
+CpuProfiler& CpuProfiler::Get()
+{
+    static CpuProfiler Profiler;
+    return Profiler;
+}
+
+Uint64 CpuProfiler::Now()
+{
+    return static_cast<Uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - ProfilerEpoch).count());
+}
+
+// #El buffer se crea y se registra la primera vez que el hilo graba un evento. Cuando el hilo
+// termina queda marcado como retirado y EndFrame() lo borra despues de leer lo que quedaba
+CpuProfiler::ThreadBuffer& CpuProfiler::GetThreadBuffer()
+{
+    struct Holder
+    {
+        std::shared_ptr<ThreadBuffer> pBuffer = std::make_shared<ThreadBuffer>();
+
+        Holder()
+        {
+            auto&                       Profiler = Get();
+            std::lock_guard<std::mutex> Lock{Profiler.m_ThreadsMtx};
+            pBuffer->ThreadIdx = Profiler.m_NextThreadIdx++;
+            Profiler.m_ThreadNames.push_back("Thread " + std::to_string(pBuffer->ThreadIdx));
+            Profiler.m_Threads.push_back(pBuffer);
+        }
+        ~Holder()
+        {
+            pBuffer->Retired.store(true, std::memory_order_release);
+        }
+    };
+    thread_local Holder ThisThread;
+    return *ThisThread.pBuffer;
+}
+
+void CpuProfiler::Record(const char* Name, Uint64 Start, Uint64 End)
+{
+    auto&        Buffer = GetThreadBuffer();
+    const Uint64 Write  = Buffer.WriteIndex.load(std::memory_order_relaxed);
+    Buffer.Events[Write & (ThreadBufferSize - 1)] = {Name, Start, End};
+    Buffer.WriteIndex.store(Write + 1, std::memory_order_release);
+}
+
+void CpuProfiler::SetThreadName(const char* Name)
+{
+    auto&                       Buffer   = GetThreadBuffer();
+    auto&                       Profiler = Get();
+    std::lock_guard<std::mutex> Lock{Profiler.m_ThreadsMtx};
+    Profiler.m_ThreadNames[Buffer.ThreadIdx] = Name;
+}
+
+void CpuProfiler::EndFrame()
+{
+    std::vector<std::shared_ptr<ThreadBuffer>> Threads;
+    {
+        std::lock_guard<std::mutex> Lock{m_ThreadsMtx};
+        Threads = m_Threads;
+    }
+
+    std::vector<TraceEvent> FrameEvents;
+    for (const auto& pBuffer : Threads)
+    {
+        // #Retired se lee antes que WriteIndex: si el hilo ya termino, todos sus eventos son visibles
+        const bool   Retired = pBuffer->Retired.load(std::memory_order_acquire);
+        const Uint64 Write   = pBuffer->WriteIndex.load(std::memory_order_acquire);
+        Uint64       Read    = pBuffer->ReadIndex;
+        if (Write - Read > ThreadBufferSize)
+        {
+            m_DroppedEvents += Write - ThreadBufferSize - Read;
+            Read = Write - ThreadBufferSize;
+        }
+
+        const size_t FirstEvent = FrameEvents.size();
+        const Uint64 FirstRead  = Read;
+        for (; Read < Write; ++Read)
+        {
+            const auto& Evt = pBuffer->Events[Read & (ThreadBufferSize - 1)];
+            FrameEvents.push_back({Evt.Name, Evt.Start, Evt.End, pBuffer->ThreadIdx});
+        }
+
+        // #Si el hilo dio la vuelta al buffer mientras se copiaba, los primeros eventos copiados
+        // pueden estar pisados y se descartan
+        const Uint64 WriteAfter = pBuffer->WriteIndex.load(std::memory_order_acquire);
+        if (WriteAfter > ThreadBufferSize && WriteAfter - ThreadBufferSize > FirstRead)
+        {
+            const size_t NumOverwritten = static_cast<size_t>(std::min(WriteAfter - ThreadBufferSize - FirstRead, Write - FirstRead));
+            FrameEvents.erase(FrameEvents.begin() + FirstEvent, FrameEvents.begin() + FirstEvent + NumOverwritten);
+            m_DroppedEvents += NumOverwritten;
+        }
+        pBuffer->ReadIndex = Write;
+
+        if (Retired)
+        {
+            std::lock_guard<std::mutex> Lock{m_ThreadsMtx};
+            m_Threads.erase(std::find(m_Threads.begin(), m_Threads.end(), pBuffer));
+        }
+    }
+
+    const Uint32 Slot = static_cast<Uint32>(m_Frame % StatsWindow);
+    for (auto& Zone : m_Zones)
+    {
+        Zone.second.FrameMs[Slot]    = 0;
+        Zone.second.FrameCalls[Slot] = 0;
+    }
+    for (const auto& Evt : FrameEvents)
+    {
+        auto& Zone = m_Zones[Evt.Name];
+        Zone.FrameMs[Slot] += static_cast<float>((Evt.End - Evt.Start) * 1e-6);
+        ++Zone.FrameCalls[Slot];
+    }
+
+    m_History.push_back(std::move(FrameEvents));
+    while (m_History.size() > MaxHistoryFrames)
+        m_History.pop_front();
+
+    ++m_Frame;
+}
+
+void CpuProfiler::GetZoneStats(std::vector<ZoneStats>& Stats) const
+{
+    Stats.clear();
+
+    const Uint32 NumFrames = static_cast<Uint32>(std::min<Uint64>(m_Frame, StatsWindow));
+    if (NumFrames == 0)
+        return;
+
+    for (const auto& Zone : m_Zones)
+    {
+        ZoneStats ZoneStat;
+        ZoneStat.Name = Zone.first;
+        for (Uint32 f = 0; f < NumFrames; ++f)
+        {
+            ZoneStat.AvgMs += Zone.second.FrameMs[f];
+            ZoneStat.MaxMs = std::max(ZoneStat.MaxMs, static_cast<double>(Zone.second.FrameMs[f]));
+            ZoneStat.CallsPerFrame += Zone.second.FrameCalls[f];
+        }
+        ZoneStat.AvgMs /= NumFrames;
+        ZoneStat.CallsPerFrame /= NumFrames;
+        Stats.push_back(ZoneStat);
+    }
+
+    std::sort(Stats.begin(), Stats.end(), [](const ZoneStats& a, const ZoneStats& b) { return a.AvgMs > b.AvgMs; });
+}
+
+bool CpuProfiler::ExportChromeTrace(const std::string& Path, Uint32 NumFrames) const
+{
+    std::ofstream File{Path};
+    if (!File)
+        return false;
+
+    File << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+
+    {
+        std::lock_guard<std::mutex> Lock{m_ThreadsMtx};
+        for (Uint32 t = 0; t < m_ThreadNames.size(); ++t)
+        {
+            File << "{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 1, \"tid\": " << t << ", \"args\": {\"name\": ";
+            WriteJSONString(File, m_ThreadNames[t].c_str());
+            File << "}},\n";
+        }
+    }
+
+    const size_t FirstFrame = m_History.size() - std::min<size_t>(NumFrames, m_History.size());
+    File.precision(3);
+    File << std::fixed;
+    for (size_t f = FirstFrame; f < m_History.size(); ++f)
+    {
+        for (const auto& Evt : m_History[f])
+        {
+            File << "{\"ph\": \"X\", \"pid\": 1, \"tid\": " << Evt.ThreadIdx << ", \"name\": ";
+            WriteJSONString(File, Evt.Name);
+            File << ", \"ts\": " << Evt.Start * 1e-3 << ", \"dur\": " << (Evt.End - Evt.Start) * 1e-3 << "},\n";
+        }
+    }
+
+    // #El ultimo elemento no puede llevar coma
+    File << "{\"ph\": \"M\", \"name\": \"process_name\", \"pid\": 1, \"args\": {\"name\": \"Tutorial11_ResourceUpdates\"}}\n]}\n";
+
+    return static_cast<bool>(File);
+}
+
+} // namespace Diligent
@@ -0,0 +1,168 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "BasicMath.hpp"
+
+// #Con 0 los GRASS_PROFILE_SCOPE desaparecen del todo
+#ifndef GRASS_PROFILER_ENABLED
+#    define GRASS_PROFILER_ENABLED 1
+#endif
+
+namespace Diligent
+{
+
+// #Profiler de CPU por zonas. Cada hilo escribe sus eventos en su propio ring buffer (sin locks,
+// un solo productor) y el hilo principal los junta una vez por frame en EndFrame()
+class CpuProfiler
+{
+public:
+    struct ZoneStats
+    {
+        const char* Name          = nullptr;
+        double      AvgMs         = 0; // #Por frame, sumando todos los hilos
+        double      MaxMs         = 0;
+        double      CallsPerFrame = 0;
+    };
+
+    static CpuProfiler& Get();
+
+    static bool IsEnabled() { return sm_Enabled.load(std::memory_order_relaxed); }
+    static void SetEnabled(bool Enabled) { sm_Enabled.store(Enabled, std::memory_order_relaxed); }
+
+    // #Nombre del hilo actual en el trace
+    static void SetThreadName(const char* Name);
+
+    // #Solo el hilo principal: junta los eventos de todos los hilos y cierra el frame
+    void EndFrame();
+
+    // #Promedio y maximo de las ultimas StatsWindow frames, de mayor a menor
+    void GetZoneStats(std::vector<ZoneStats>& Stats) const;
+
+    // #Escribe los ultimos NumFrames frames como trace-event JSON (chrome://tracing, Perfetto)
+    bool ExportChromeTrace(const std::string& Path, Uint32 NumFrames) const;
+
+    Uint32 GetHistorySize() const { return static_cast<Uint32>(m_History.size()); }
+    Uint64 GetDroppedEvents() const { return m_DroppedEvents; }
+
+    static constexpr Uint32 StatsWindow      = 120;
+    static constexpr Uint32 MaxHistoryFrames = 300;
+
+    class Scope
+    {
+    public:
+        explicit Scope(const char* Name) :
+            m_Name{IsEnabled() ? Name : nullptr}
+        {
+            if (m_Name != nullptr)
+                m_Start = Now();
+        }
+        ~Scope()
+        {
+            if (m_Name != nullptr)
+                Record(m_Name, m_Start, Now());
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* m_Name;
+        Uint64      m_Start = 0;
+    };
+
+private:
+    struct Event
+    {
+        const char* Name;
+        Uint64      Start; // #ns desde que arranco el profiler
+        Uint64      End;
+    };
+
+    struct TraceEvent
+    {
+        const char* Name;
+        Uint64      Start;
+        Uint64      End;
+        Uint32      ThreadIdx;
+    };
+
+    static constexpr Uint32 ThreadBufferSize = 1u << 15; // #Eventos por hilo entre dos EndFrame()
+
+    struct ThreadBuffer
+    {
+        std::unique_ptr<Event[]> Events{new Event[ThreadBufferSize]};
+        std::atomic<Uint64>      WriteIndex{0};
+        std::atomic<bool>        Retired{false}; // #El hilo termino; se borra despues de leerlo
+        Uint64                   ReadIndex = 0;  // #Solo lo toca EndFrame()
+        Uint32                   ThreadIdx = 0;
+    };
+
+    struct ZoneHistory
+    {
+        float  FrameMs[StatsWindow]    = {};
+        Uint32 FrameCalls[StatsWindow] = {};
+    };
+
+    static Uint64        Now();
+    static void          Record(const char* Name, Uint64 Start, Uint64 End);
+    static ThreadBuffer& GetThreadBuffer();
+
+    static std::atomic<bool> sm_Enabled;
+
+    mutable std::mutex                         m_ThreadsMtx; // #Registro de hilos y sus nombres
+    std::vector<std::shared_ptr<ThreadBuffer>> m_Threads;
+    std::vector<std::string>                   m_ThreadNames; // #Por ThreadIdx
+    Uint32                                     m_NextThreadIdx = 0;
+
+    Uint64                                       m_Frame         = 0;
+    Uint64                                       m_DroppedEvents = 0;
+    std::deque<std::vector<TraceEvent>>          m_History;
+    std::unordered_map<const char*, ZoneHistory> m_Zones;
+};
+
+} // namespace Diligent
+
+#if GRASS_PROFILER_ENABLED
+#    define GRASS_PROFILE_CONCAT_IMPL(a, b) a##b
+#    define GRASS_PROFILE_CONCAT(a, b)      GRASS_PROFILE_CONCAT_IMPL(a, b)
+#    define GRASS_PROFILE_SCOPE(Name)       ::Diligent::CpuProfiler::Scope GRASS_PROFILE_CONCAT(GrassProfileScope, __LINE__){Name}
+#else
+#    define GRASS_PROFILE_SCOPE(Name) \
+        do                            \
+        {                             \
+        } while (false)
+#endif
@@ -0,0 +1,377 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+#include "FrameCapture.hpp"
+#include "GpuMemoryRegistry.hpp"
+#include "CpuProfiler.hpp"
+#include "GraphicsAccessories.hpp"
+#include "FileSystem.hpp"
+#include "Image.h"
+#include "Errors.hpp"
+
+namespace Diligent
+{
+
+FrameCapture::~FrameCapture()
+{
+    // #Sin contexto no se puede desmapear; Stop() ya deberia haber vaciado el ring
+    if (m_EncoderThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> Lock{m_QueueMtx};
+            m_StopEncoder = true;
+        }
+        m_QueueCV.notify_all();
+        m_EncoderThread.join();
+    }
+}
+
+void FrameCapture::Start(IRenderDevice* pDevice, const Config& Cfg)
+{
+    if (m_Active)
+        return;
+
+    m_pDevice         = pDevice;
+    m_Config          = Cfg;
+    m_Config.Every    = std::max(m_Config.Every, 1u);
+    m_Config.RingSize = std::max(m_Config.RingSize, 2u);
+    m_Stats           = {};
+    m_FrameIndex      = 0;
+
+    if (!FileSystem::PathExists(m_Config.Directory.c_str()))
+        FileSystem::CreateDirectory(m_Config.Directory.c_str());
+
+    FenceDesc Desc;
+    Desc.Name = "Frame capture fence";
+    m_pFence.Release();
+    pDevice->CreateFence(Desc, &m_pFence);
+    m_FenceValue = 0;
+
+    m_StopEncoder   = false;
+    m_EncoderThread = std::thread(EncoderThreadFunc, this);
+    m_Active        = true;
+    LOG_INFO_MESSAGE("Capturing every ", m_Config.Every, " frames to ", m_Config.Directory, " (", GetFormatName(m_Config.Format), ")");
+}
+
+void FrameCapture::Stop(IDeviceContext* pCtx)
+{
+    if (!m_Active)
+        return;
+
+    ReleaseRing(pCtx);
+    {
+        std::lock_guard<std::mutex> Lock{m_QueueMtx};
+        m_StopEncoder = true;
+    }
+    m_QueueCV.notify_all();
+    m_EncoderThread.join();
+    m_Active = false;
+    LOG_INFO_MESSAGE("Frame capture: ", m_Stats.Written, " frames written, ", m_Stats.Dropped, " dropped, ", m_Stats.Failed, " failed");
+}
+
+void FrameCapture::Capture(IDeviceContext* pCtx, ITexture* pSrc, bool FlipY)
+{
+    if (!m_Active || pSrc == nullptr)
+        return;
+
+    GRASS_PROFILE_SCOPE("FrameCapture::Capture");
+    m_Stats.WaitMs = 0;
+
+    // #Si cambio el back buffer (resize) se vacia el ring y se crea de nuevo, esperando esta vez
+    const auto& SrcDesc = pSrc->GetDesc();
+    if (m_Slots.empty() || SrcDesc.Width != m_Width || SrcDesc.Height != m_Height || SrcDesc.Format != m_TexFormat || FlipY != m_FlipY)
+        CreateRing(pCtx, SrcDesc, FlipY);
+
+    CollectSlots(pCtx, false);
+
+    if (m_FrameIndex++ % m_Config.Every != 0)
+        return;
+    ++m_Stats.Requested;
+
+    int SlotIdx = FindFreeSlot();
+    if (SlotIdx < 0 && !m_Config.DropWhenBusy)
+    {
+        const auto WaitStart = std::chrono::high_resolution_clock::now();
+        WaitForFreeSlot(pCtx);
+        m_Stats.WaitMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - WaitStart).count();
+        SlotIdx        = FindFreeSlot();
+    }
+    if (SlotIdx < 0)
+    {
+        ++m_Stats.Dropped;
+        return;
+    }
+
+    auto&              Slot = m_Slots[SlotIdx];
+    CopyTextureAttribs CopyAttribs{pSrc, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, Slot.pStaging, RESOURCE_STATE_TRANSITION_MODE_TRANSITION};
+    pCtx->CopyTexture(CopyAttribs);
+    pCtx->EnqueueSignal(m_pFence, ++m_FenceValue);
+
+    Slot.State      = SLOT_COPYING;
+    Slot.FenceValue = m_FenceValue;
+    Slot.Frame      = m_FrameIndex - 1;
+    m_CopyQueue.push_back(static_cast<Uint32>(SlotIdx));
+    ++m_Stats.Copied;
+    ++m_Stats.Copying;
+}
+
+FrameCapture::Stats FrameCapture::GetStats() const
+{
+    std::lock_guard<std::mutex> Lock{m_QueueMtx};
+    return m_Stats;
+}
+
+const char* FrameCapture::GetFormatName(FORMAT Format)
+{
+    switch (Format)
+    {
+        case FORMAT_PNG: return "PNG";
+        case FORMAT_RAW: return "Raw";
+        default: return "Unknown";
+    }
+}
+
+void FrameCapture::CreateRing(IDeviceContext* pCtx, const TextureDesc& SrcDesc, bool FlipY)
+{
+    ReleaseRing(pCtx);
+
+    const auto& FmtAttribs = GetTextureFormatAttribs(SrcDesc.Format);
+    m_Width                = SrcDesc.Width;
+    m_Height               = SrcDesc.Height;
+    m_TexFormat            = SrcDesc.Format;
+    m_TexelSize            = Uint32{FmtAttribs.ComponentSize} * FmtAttribs.NumComponents;
+    m_FlipY                = FlipY;
+    // #Image::Encode solo sabe de 8 bits por canal
+    m_CanEncodePNG = FmtAttribs.ComponentType != COMPONENT_TYPE_COMPRESSED && FmtAttribs.ComponentSize == 1 && FmtAttribs.NumComponents == 4;
+    if (m_Config.Format == FORMAT_PNG && !m_CanEncodePNG)
+        LOG_WARNING_MESSAGE("Frame capture: ", FmtAttribs.Name, " can't be written as PNG, writing raw files instead");
+
+    TextureDesc Desc;
+    Desc.Name           = "Frame capture staging texture";
+    Desc.Type           = RESOURCE_DIM_TEX_2D;
+    Desc.Width          = m_Width;
+    Desc.Height         = m_Height;
+    Desc.MipLevels      = 1;
+    Desc.Format         = m_TexFormat;
+    Desc.Usage          = USAGE_STAGING;
+    Desc.CPUAccessFlags = CPU_ACCESS_READ;
+
+    m_Slots.resize(m_Config.RingSize);
+    for (auto& Slot : m_Slots)
+    {
+        GpuMemoryRegistry::Get().CreateTexture(m_pDevice, Desc, nullptr, GpuMemoryRegistry::CATEGORY_STAGING, &Slot.pStaging);
+        Slot.State = SLOT_FREE;
+    }
+}
+
+// #Espera a la GPU y al encoder hasta que no quede nada pendiente y suelta las texturas
+void FrameCapture::ReleaseRing(IDeviceContext* pCtx)
+{
+    if (m_Slots.empty())
+        return;
+
+    if (!m_CopyQueue.empty())
+    {
+        pCtx->Flush();
+        m_pFence->Wait(m_FenceValue);
+    }
+    CollectSlots(pCtx, true);
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> Lock{m_QueueMtx};
+            m_QueueCV.wait(Lock, [this] { return !m_EncodedSlots.empty() || m_Stats.Encoding == 0; });
+        }
+        CollectSlots(pCtx, true);
+        if (m_Stats.Encoding == 0)
+            break;
+    }
+
+    // #Una copia que no se pudo mapear se pierde con el ring
+    m_CopyQueue.clear();
+    {
+        std::lock_guard<std::mutex> Lock{m_QueueMtx};
+        m_Stats.Copying = 0;
+    }
+    m_Slots.clear();
+}
+
+// #Desmapea lo que el encoder ya escribio y le pasa las copias que la GPU termino. Con Wait = false
+// nada espera: un Map que todavia no esta listo se vuelve a intentar en el frame siguiente
+void FrameCapture::CollectSlots(IDeviceContext* pCtx, bool Wait)
+{
+    {
+        std::lock_guard<std::mutex> Lock{m_QueueMtx};
+        m_EncodedScratch.swap(m_EncodedSlots);
+    }
+    for (Uint32 SlotIdx : m_EncodedScratch)
+    {
+        pCtx->UnmapTextureSubresource(m_Slots[SlotIdx].pStaging, 0, 0);
+        m_Slots[SlotIdx].State = SLOT_FREE;
+        std::lock_guard<std::mutex> Lock{m_QueueMtx};
+        --m_Stats.Encoding;
+    }
+    m_EncodedScratch.clear();
+
+    const Uint64 Completed = m_pFence->GetCompletedValue();
+    while (!m_CopyQueue.empty() && m_Slots[m_CopyQueue.front()].FenceValue <= Completed)
+    {
+        auto& Slot = m_Slots[m_CopyQueue.front()];
+
+        MappedTextureSubresource Mapped;
+        pCtx->MapTextureSubresource(Slot.pStaging, 0, 0, MAP_READ, Wait ? MAP_FLAG_NONE : MAP_FLAG_DO_NOT_WAIT, nullptr, Mapped);
+        if (Mapped.pData == nullptr)
+            break;
+
+        EncodeJob Job;
+        Job.Slot   = m_CopyQueue.front();
+        Job.Frame  = Slot.Frame;
+        Job.pData  = Mapped.pData;
+        Job.Stride = Mapped.Stride;
+        Slot.State = SLOT_ENCODING;
+        m_CopyQueue.pop_front();
+        {
+            std::lock_guard<std::mutex> Lock{m_QueueMtx};
+            m_Jobs.push_back(Job);
+            --m_Stats.Copying;
+            ++m_Stats.Encoding;
+        }
+        m_QueueCV.notify_all();
+    }
+}
+
+// #Sin DropWhenBusy: espera la copia mas vieja y despues al encoder hasta que se libere un slot
+void FrameCapture::WaitForFreeSlot(IDeviceContext* pCtx)
+{
+    GRASS_PROFILE_SCOPE("FrameCapture::WaitForFreeSlot");
+    if (!m_CopyQueue.empty())
+    {
+        pCtx->Flush();
+        m_pFence->Wait(m_Slots[m_CopyQueue.front()].FenceValue);
+    }
+    CollectSlots(pCtx, true);
+    while (FindFreeSlot() < 0)
+    {
+        {
+            std::unique_lock<std::mutex> Lock{m_QueueMtx};
+            m_QueueCV.wait(Lock, [this] { return !m_EncodedSlots.empty(); });
+        }
+        CollectSlots(pCtx, true);
+    }
+}
+
+int FrameCapture::FindFreeSlot() const
+{
+    for (size_t s = 0; s < m_Slots.size(); ++s)
+    {
+        if (m_Slots[s].State == SLOT_FREE)
+            return static_cast<int>(s);
+    }
+    return -1;
+}
+
+// #Corre en el hilo del encoder. El ring no cambia mientras haya trabajos en la cola
+bool FrameCapture::WriteFrame(const EncodeJob& Job) const
+{
+    char Name[32];
+    std::snprintf(Name, sizeof(Name), "frame_%06llu", static_cast<unsigned long long>(Job.Frame));
+    const std::string Path = m_Config.Directory + "/" + Name;
+
+    if (m_Config.Format == FORMAT_PNG && m_CanEncodePNG)
+    {
+        Image::EncodeInfo Info;
+        Info.Width      = m_Width;
+        Info.Height     = m_Height;
+        Info.TexFormat  = m_TexFormat;
+        Info.KeepAlpha  = false;
+        Info.FlipY      = m_FlipY;
+        Info.pData      = Job.pData;
+        Info.Stride     = static_cast<Uint32>(Job.Stride);
+        Info.FileFormat = IMAGE_FILE_FORMAT_PNG;
+
+        RefCntAutoPtr<IDataBlob> pEncoded;
+        Image::Encode(Info, &pEncoded);
+        if (!pEncoded)
+            return false;
+
+        std::ofstream File{Path + ".png", std::ios::binary};
+        File.write(static_cast<const char*>(pEncoded->GetConstDataPtr()), static_cast<std::streamsize>(pEncoded->GetSize()));
+        return static_cast<bool>(File);
+    }
+
+    // #El tamano y el formato van en el nombre: frame_000042_1280x720_RGBA8_UNORM_SRGB.raw
+    std::ofstream File{Path + "_" + std::to_string(m_Width) + "x" + std::to_string(m_Height) + "_" + GetTextureFormatAttribs(m_TexFormat).Name + ".raw",
+                       std::ios::binary};
+    const size_t RowBytes = size_t{m_Width} * m_TexelSize;
+    for (Uint32 y = 0; y < m_Height && File; ++y)
+    {
+        const Uint32 SrcRow = m_FlipY ? m_Height - 1 - y : y;
+        File.write(static_cast<const char*>(Job.pData) + SrcRow * Job.Stride, static_cast<std::streamsize>(RowBytes));
+    }
+    return static_cast<bool>(File);
+}
+
+void FrameCapture::EncoderThreadFunc(FrameCapture* pThis)
+{
+    CpuProfiler::SetThreadName("Frame capture");
+
+    for (;;)
+    {
+        EncodeJob Job;
+        {
+            std::unique_lock<std::mutex> Lock{pThis->m_QueueMtx};
+            pThis->m_QueueCV.wait(Lock, [pThis] { return pThis->m_StopEncoder || !pThis->m_Jobs.empty(); });
+            if (pThis->m_Jobs.empty())
+                return;
+            Job = pThis->m_Jobs.front();
+            pThis->m_Jobs.pop_front();
+        }
+
+        GRASS_PROFILE_SCOPE("FrameCapture::WriteFrame");
+        const auto StartTime = std::chrono::high_resolution_clock::now();
+        const bool Written   = pThis->WriteFrame(Job);
+        const auto EncodeMs  = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+        {
+            std::lock_guard<std::mutex> Lock{pThis->m_QueueMtx};
+            pThis->m_EncodedSlots.push_back(Job.Slot);
+            pThis->m_Stats.EncodeMs = EncodeMs;
+            if (Written)
+                ++pThis->m_Stats.Written;
+            else
+                ++pThis->m_Stats.Failed;
+        }
+        pThis->m_QueueCV.notify_all();
+    }
+}
+
+} // namespace Diligent
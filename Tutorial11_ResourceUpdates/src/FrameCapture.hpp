@@ -0,0 +1,161 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "Texture.h"
+#include "Fence.h"
+#include "RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+// #Captura de frames sin trabar la GPU: cada frame elegido se copia a una textura de staging de un
+// ring y se senala un fence. Unos frames despues, cuando el fence ya paso, la textura se mapea y el
+// puntero se le pasa a un hilo que escribe el PNG o el raw; recien cuando termina se desmapea y el
+// slot vuelve al ring. Si no hay slot libre el frame se descarta (o, sin DropWhenBusy, se espera).
+// Funciona con cualquier textura de origen, asi que sirve con un device por software u offscreen
+class FrameCapture
+{
+public:
+    enum FORMAT : Uint32
+    {
+        FORMAT_PNG = 0,
+        FORMAT_RAW, // #Filas sin padding, la de arriba primero, en el formato del back buffer
+        FORMAT_COUNT
+    };
+
+    struct Config
+    {
+        std::string Directory    = "Tutorial11_capture";
+        Uint32      Every        = 1; // #Captura uno de cada Every frames
+        FORMAT      Format       = FORMAT_PNG;
+        Uint32      RingSize     = 4; // #Texturas de staging; tiene que pasar los frames en vuelo
+        bool        DropWhenBusy = true;
+    };
+
+    struct Stats
+    {
+        Uint64 Requested = 0; // #Frames que tocaba capturar
+        Uint64 Copied    = 0;
+        Uint64 Written   = 0;
+        Uint64 Dropped   = 0; // #Sin slot libre
+        Uint64 Failed    = 0; // #Error al codificar o escribir
+        Uint32 Copying   = 0; // #Esperando a la GPU
+        Uint32 Encoding  = 0; // #Mapeados, en el hilo del encoder
+        double EncodeMs  = 0; // #Del ultimo frame escrito
+        double WaitMs    = 0; // #Lo que Capture() espero sin DropWhenBusy en este frame
+    };
+
+    ~FrameCapture();
+
+    void Start(IRenderDevice* pDevice, const Config& Cfg);
+    // #Espera a que se escriban todos los frames pendientes
+    void Stop(IDeviceContext* pCtx);
+    bool IsActive() const { return m_Active; }
+
+    // #Al final de Render(), con la imagen terminada en pSrc. FlipY si la primera fila es la de
+    // abajo (OpenGL). Puede dejar pSrc en RESOURCE_STATE_COPY_SOURCE
+    void Capture(IDeviceContext* pCtx, ITexture* pSrc, bool FlipY);
+
+    const Config& GetConfig() const { return m_Config; }
+    Stats         GetStats() const;
+
+    static const char* GetFormatName(FORMAT Format);
+
+private:
+    enum SLOT_STATE : Uint8
+    {
+        SLOT_FREE = 0,
+        SLOT_COPYING,
+        SLOT_ENCODING
+    };
+
+    struct Slot
+    {
+        RefCntAutoPtr<ITexture> pStaging;
+        SLOT_STATE              State      = SLOT_FREE;
+        Uint64                  FenceValue = 0;
+        Uint64                  Frame      = 0;
+    };
+
+    struct EncodeJob
+    {
+        Uint32      Slot   = 0;
+        Uint64      Frame  = 0;
+        const void* pData  = nullptr;
+        Uint64      Stride = 0;
+    };
+
+    void CreateRing(IDeviceContext* pCtx, const TextureDesc& SrcDesc, bool FlipY);
+    void ReleaseRing(IDeviceContext* pCtx);
+    void CollectSlots(IDeviceContext* pCtx, bool Wait);
+    void WaitForFreeSlot(IDeviceContext* pCtx);
+    int  FindFreeSlot() const;
+    bool WriteFrame(const EncodeJob& Job) const;
+
+    static void EncoderThreadFunc(FrameCapture* pThis);
+
+    Config                       m_Config;
+    bool                         m_Active = false;
+    RefCntAutoPtr<IRenderDevice> m_pDevice;
+    RefCntAutoPtr<IFence>        m_pFence;
+    Uint64                       m_FenceValue = 0;
+    Uint64                       m_FrameIndex = 0;
+    std::vector<Slot>            m_Slots;
+    std::deque<Uint32>           m_CopyQueue; // #Slots en SLOT_COPYING, en orden de copia
+    std::vector<Uint32>          m_EncodedScratch;
+    Stats                        m_Stats;
+
+    // #Lo que el encoder necesita del ring; solo cambia con el ring vacio
+    Uint32         m_Width        = 0;
+    Uint32         m_Height       = 0;
+    TEXTURE_FORMAT m_TexFormat    = TEX_FORMAT_UNKNOWN;
+    Uint32         m_TexelSize    = 0;
+    bool           m_FlipY        = false;
+    bool           m_CanEncodePNG = false;
+
+    // #Cola del encoder. m_EncodedSlots son los slots que ya se escribieron y hay que desmapear
+    std::thread             m_EncoderThread;
+    mutable std::mutex      m_QueueMtx;
+    std::condition_variable m_QueueCV;
+    std::deque<EncodeJob>   m_Jobs;
+    std::vector<Uint32>     m_EncodedSlots;
+    bool                    m_StopEncoder = false;
+};
+
+} // namespace Diligent
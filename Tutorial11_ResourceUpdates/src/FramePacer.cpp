@@ -0,0 +1,184 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#include <algorithm>
+
+#include "FramePacer.hpp"
+#include "CpuProfiler.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+double ToMs(FramePacer::Clock::duration Duration)
+{
+    return std::chrono::duration<double, std::milli>(Duration).count();
+}
+
+} // namespace
+
+void FramePacer::Initialize(IRenderDevice* pDevice)
+{
+    FenceDesc Desc;
+    Desc.Name = "Frame pacing fence";
+    m_pFence.Release();
+    pDevice->CreateFence(Desc, &m_pFence);
+
+    m_SignaledValue  = 0;
+    m_FramesInFlight = 0;
+    m_Pending.clear();
+    m_Stats        = {};
+    m_WindowSum    = {};
+    m_WindowMax    = {};
+    m_WindowFrames = 0;
+}
+
+double FramePacer::BeginFrame(IDeviceContext* pCtx, Uint32 MaxFramesInFlight)
+{
+    GRASS_PROFILE_SCOPE("FramePacer::BeginFrame");
+    const auto Now = Clock::now();
+
+    // #Update() corre despues de que volvio el Present del frame anterior
+    if (!m_Pending.empty() && m_Pending.back().FenceValue != 0 && !m_Pending.back().HasPresent)
+    {
+        m_Pending.back().Present    = Now;
+        m_Pending.back().HasPresent = true;
+    }
+
+    m_WaitMs = 0;
+    if (m_pFence && MaxFramesInFlight > 0 && m_SignaledValue >= MaxFramesInFlight)
+    {
+        // #Con MaxFramesInFlight = 1 se espera al frame anterior entero
+        const Uint64 WaitValue = m_SignaledValue - MaxFramesInFlight + 1;
+        if (m_pFence->GetCompletedValue() < WaitValue)
+        {
+            // #Present ya envio la senal; el Flush es por si el framework no presento el frame
+            pCtx->Flush();
+            m_pFence->Wait(WaitValue);
+            m_WaitMs = ToMs(Clock::now() - Now);
+        }
+    }
+
+    CollectCompletedFrames();
+    return m_WaitMs;
+}
+
+void FramePacer::MarkInput()
+{
+    if (!m_MeasureLatency)
+        return;
+
+    // #Un frame sin Render() (p. ej. con la ventana minimizada) reusa la entrada
+    if (m_Pending.empty() || m_Pending.back().FenceValue != 0)
+        m_Pending.emplace_back();
+    m_Pending.back()       = {};
+    m_Pending.back().Input = Clock::now();
+
+    if (m_Pending.size() > MaxPending)
+        m_Pending.pop_front();
+}
+
+void FramePacer::MarkLatch()
+{
+    if (m_Pending.empty() || m_Pending.back().FenceValue != 0)
+        return;
+    m_Pending.back().Latch    = Clock::now();
+    m_Pending.back().HasLatch = true;
+}
+
+void FramePacer::EndFrame(IDeviceContext* pCtx)
+{
+    if (!m_pFence)
+        return;
+
+    pCtx->EnqueueSignal(m_pFence, ++m_SignaledValue);
+    if (!m_Pending.empty() && m_Pending.back().FenceValue == 0)
+    {
+        auto& Frame  = m_Pending.back();
+        Frame.Submit = Clock::now();
+        if (!Frame.HasLatch)
+            Frame.Latch = Frame.Submit;
+        Frame.FenceValue = m_SignaledValue;
+    }
+}
+
+void FramePacer::SetMeasureLatency(bool Measure)
+{
+    m_MeasureLatency = Measure;
+    if (!Measure)
+        m_Pending.clear();
+}
+
+void FramePacer::CollectCompletedFrames()
+{
+    const Uint64 Completed = m_pFence ? m_pFence->GetCompletedValue() : m_SignaledValue;
+    m_FramesInFlight       = static_cast<Uint32>(m_SignaledValue - std::min(Completed, m_SignaledValue));
+
+    const auto Now = Clock::now();
+    while (!m_Pending.empty() && m_Pending.front().FenceValue != 0 && m_Pending.front().FenceValue <= Completed)
+    {
+        const auto& Frame = m_Pending.front();
+
+        FrameLatency Latency;
+        Latency.Frame            = Frame.FenceValue;
+        Latency.InputToLatchMs   = ToMs(Frame.Latch - Frame.Input);
+        Latency.InputToSubmitMs  = ToMs(Frame.Submit - Frame.Input);
+        Latency.InputToPresentMs = ToMs((Frame.HasPresent ? Frame.Present : Now) - Frame.Input);
+        Latency.InputToGpuMs     = std::max(ToMs(Now - Frame.Input), Latency.InputToPresentMs);
+        m_Pending.pop_front();
+
+        m_Stats.Last = Latency;
+        m_WindowSum.InputToLatchMs += Latency.InputToLatchMs;
+        m_WindowSum.InputToSubmitMs += Latency.InputToSubmitMs;
+        m_WindowSum.InputToPresentMs += Latency.InputToPresentMs;
+        m_WindowSum.InputToGpuMs += Latency.InputToGpuMs;
+        m_WindowMax.InputToLatchMs   = std::max(m_WindowMax.InputToLatchMs, Latency.InputToLatchMs);
+        m_WindowMax.InputToSubmitMs  = std::max(m_WindowMax.InputToSubmitMs, Latency.InputToSubmitMs);
+        m_WindowMax.InputToPresentMs = std::max(m_WindowMax.InputToPresentMs, Latency.InputToPresentMs);
+        m_WindowMax.InputToGpuMs     = std::max(m_WindowMax.InputToGpuMs, Latency.InputToGpuMs);
+
+        if (++m_WindowFrames == LatencyWindow)
+        {
+            const double Scale = 1.0 / LatencyWindow;
+            m_Stats.Frames     = LatencyWindow;
+            m_Stats.Avg        = m_WindowSum;
+            m_Stats.Avg.InputToLatchMs *= Scale;
+            m_Stats.Avg.InputToSubmitMs *= Scale;
+            m_Stats.Avg.InputToPresentMs *= Scale;
+            m_Stats.Avg.InputToGpuMs *= Scale;
+            m_Stats.Max    = m_WindowMax;
+            m_WindowSum    = {};
+            m_WindowMax    = {};
+            m_WindowFrames = 0;
+        }
+    }
+}
+
+} // namespace Diligent
@@ -0,0 +1,121 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "Fence.h"
+#include "RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+// #Ritmo de los frames: cada frame senala un fence al final de Render() y, antes de leer el
+// input del frame siguiente, se espera a que la GPU no tenga mas de MaxFramesInFlight frames
+// pendientes. Con menos frames en cola el input llega antes a la pantalla, a costa de que el CPU
+// espere a la GPU.
+// #En modo latencia tambien se toma el tiempo de cada frame desde que se lee el input hasta que
+// se escriben las constantes del jugador, termina Render(), vuelve Present y la GPU termina.
+// Present lo llama el framework despues de Render(), asi que su vuelta se toma al principio del
+// Update() siguiente, y el fin de la GPU cuando se ve el fence completo (una cota superior)
+class FramePacer
+{
+public:
+    using Clock = std::chrono::high_resolution_clock;
+
+    struct FrameLatency
+    {
+        Uint64 Frame            = 0; // #Valor del fence del frame, 0 = todavia ninguno
+        double InputToLatchMs   = 0;
+        double InputToSubmitMs  = 0;
+        double InputToPresentMs = 0;
+        double InputToGpuMs     = 0;
+    };
+
+    struct LatencyStats
+    {
+        Uint32       Frames = 0; // #Frames de la ultima ventana
+        FrameLatency Avg;
+        FrameLatency Max;
+        FrameLatency Last;
+    };
+
+    void Initialize(IRenderDevice* pDevice);
+
+    // #Al principio de Update(). MaxFramesInFlight = 0 no espera. Devuelve los ms esperados
+    double BeginFrame(IDeviceContext* pCtx, Uint32 MaxFramesInFlight);
+
+    // #Cuando se lee el input del frame y cuando se escriben las constantes que dependen de el
+    void MarkInput();
+    void MarkLatch();
+
+    // #Al final de Render()
+    void EndFrame(IDeviceContext* pCtx);
+
+    void SetMeasureLatency(bool Measure);
+
+    Uint32              GetFramesInFlight() const { return m_FramesInFlight; }
+    double              GetWaitMs() const { return m_WaitMs; }
+    const LatencyStats& GetLatencyStats() const { return m_Stats; }
+
+private:
+    void CollectCompletedFrames();
+
+    struct PendingFrame
+    {
+        Uint64            FenceValue = 0; // #0 hasta EndFrame()
+        Clock::time_point Input;
+        Clock::time_point Latch;
+        Clock::time_point Submit;
+        Clock::time_point Present;
+        bool              HasLatch   = false;
+        bool              HasPresent = false;
+    };
+
+    // #Promedios y maximos de a LatencyWindow frames
+    static constexpr Uint32 LatencyWindow = 60;
+    static constexpr size_t MaxPending    = 16;
+
+    RefCntAutoPtr<IFence>    m_pFence;
+    Uint64                   m_SignaledValue  = 0;
+    Uint32                   m_FramesInFlight = 0;
+    double                   m_WaitMs         = 0;
+    bool                     m_MeasureLatency = false;
+    std::deque<PendingFrame> m_Pending;
+
+    LatencyStats m_Stats;
+    FrameLatency m_WindowSum;
+    FrameLatency m_WindowMax;
+    Uint32       m_WindowFrames = 0;
+};
+
+} // namespace Diligent
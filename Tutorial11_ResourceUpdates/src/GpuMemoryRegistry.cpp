@@ -0,0 +1,209 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#include <algorithm>
+
+#include "GpuMemoryRegistry.hpp"
+#include "GraphicsAccessories.hpp"
+#include "Errors.hpp"
+
+namespace Diligent
+{
+
+GpuMemoryRegistry& GpuMemoryRegistry::Get()
+{
+    static GpuMemoryRegistry Registry;
+    return Registry;
+}
+
+void GpuMemoryRegistry::SetDynamicCopies(Uint32 NumCopies)
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    m_DynamicCopies = std::max(NumCopies, 1u);
+}
+
+void GpuMemoryRegistry::CreateBuffer(IRenderDevice* pDevice, const BufferDesc& Desc, const BufferData* pData, CATEGORY Category, IBuffer** ppBuffer)
+{
+    pDevice->CreateBuffer(Desc, pData, ppBuffer);
+    Track(*ppBuffer, Category);
+}
+
+void GpuMemoryRegistry::CreateTexture(IRenderDevice* pDevice, const TextureDesc& Desc, const TextureData* pData, CATEGORY Category, ITexture** ppTexture)
+{
+    pDevice->CreateTexture(Desc, pData, ppTexture);
+    Track(*ppTexture, Category);
+}
+
+void GpuMemoryRegistry::Track(IBuffer* pBuffer, CATEGORY Category)
+{
+    if (pBuffer == nullptr)
+        return;
+
+    Uint32 DynamicCopies;
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        DynamicCopies = m_DynamicCopies;
+    }
+    Add(pBuffer, Category, EstimateBufferBytes(pBuffer->GetDesc(), DynamicCopies));
+}
+
+void GpuMemoryRegistry::Track(ITexture* pTexture, CATEGORY Category)
+{
+    if (pTexture != nullptr)
+        Add(pTexture, Category, EstimateTextureBytes(pTexture->GetDesc()));
+}
+
+void GpuMemoryRegistry::Add(IDeviceObject* pObject, CATEGORY Category, Uint64 Bytes)
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    m_Entries.push_back({RefCntWeakPtr<IDeviceObject>{pObject}, Category, Bytes});
+
+    auto& Stats = m_Stats[Category];
+    Stats.Bytes += Bytes;
+    Stats.PeakBytes = std::max(Stats.PeakBytes, Stats.Bytes);
+    ++Stats.Resources;
+    m_Total.Bytes += Bytes;
+    m_Total.PeakBytes = std::max(m_Total.PeakBytes, m_Total.Bytes);
+    ++m_Total.Resources;
+}
+
+void GpuMemoryRegistry::Update()
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+
+    // #Swap-and-pop: el orden de las entradas no importa
+    for (size_t i = 0; i < m_Entries.size();)
+    {
+        auto& Entry = m_Entries[i];
+        if (Entry.pObject.IsValid())
+        {
+            ++i;
+            continue;
+        }
+
+        auto& Stats = m_Stats[Entry.Category];
+        Stats.Bytes -= Entry.Bytes;
+        --Stats.Resources;
+        m_Total.Bytes -= Entry.Bytes;
+        --m_Total.Resources;
+
+        Entry = std::move(m_Entries.back());
+        m_Entries.pop_back();
+    }
+
+    // #Un aviso cada vez que se pasa, no uno por frame
+    const bool OverBudget = m_Budget > 0 && m_Total.Bytes > m_Budget;
+    if (OverBudget && !m_OverBudget)
+    {
+        LOG_WARNING_MESSAGE("Estimated GPU memory (", m_Total.Bytes >> 20, " MB) exceeds the budget of ", m_Budget >> 20, " MB. Geometry: ",
+                            m_Stats[CATEGORY_GEOMETRY].Bytes >> 10, " KB, textures: ", m_Stats[CATEGORY_TEXTURES].Bytes >> 10,
+                            " KB, staging: ", m_Stats[CATEGORY_STAGING].Bytes >> 10, " KB, constants: ", m_Stats[CATEGORY_CONSTANTS].Bytes >> 10,
+                            " KB, per-instance: ", m_Stats[CATEGORY_PER_INSTANCE].Bytes >> 10, " KB");
+    }
+    m_OverBudget = OverBudget;
+}
+
+void GpuMemoryRegistry::Reset()
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    m_Entries.clear();
+    m_Stats      = {};
+    m_Total      = {};
+    m_OverBudget = false;
+}
+
+void GpuMemoryRegistry::ResetPeaks()
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    for (auto& Stats : m_Stats)
+        Stats.PeakBytes = Stats.Bytes;
+    m_Total.PeakBytes = m_Total.Bytes;
+}
+
+void GpuMemoryRegistry::SetBudget(Uint64 Bytes)
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    m_Budget = Bytes;
+}
+
+Uint64 GpuMemoryRegistry::GetBudget() const
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    return m_Budget;
+}
+
+bool GpuMemoryRegistry::IsOverBudget() const
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    return m_OverBudget;
+}
+
+GpuMemoryRegistry::CategoryStats GpuMemoryRegistry::GetStats(CATEGORY Category) const
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    return m_Stats[Category];
+}
+
+GpuMemoryRegistry::CategoryStats GpuMemoryRegistry::GetTotalStats() const
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    return m_Total;
+}
+
+Uint64 GpuMemoryRegistry::EstimateBufferBytes(const BufferDesc& Desc, Uint32 DynamicCopies)
+{
+    return Desc.Usage == USAGE_DYNAMIC ? Desc.Size * DynamicCopies : Desc.Size;
+}
+
+Uint64 GpuMemoryRegistry::EstimateTextureBytes(const TextureDesc& Desc)
+{
+    // #En las texturas 3D ArraySize es la profundidad, que GetMipLevelProperties ya cuenta
+    const bool   IsArray = Desc.Type == RESOURCE_DIM_TEX_1D_ARRAY || Desc.Type == RESOURCE_DIM_TEX_2D_ARRAY ||
+        Desc.Type == RESOURCE_DIM_TEX_CUBE || Desc.Type == RESOURCE_DIM_TEX_CUBE_ARRAY;
+    const Uint32 Slices  = IsArray ? Desc.ArraySize : 1;
+
+    Uint64 Bytes = 0;
+    for (Uint32 Mip = 0; Mip < Desc.MipLevels; ++Mip)
+        Bytes += GetMipLevelProperties(Desc, Mip).MipSize;
+    return Bytes * Slices * std::max(Desc.SampleCount, 1u);
+}
+
+const char* GpuMemoryRegistry::GetCategoryName(CATEGORY Category)
+{
+    switch (Category)
+    {
+        case CATEGORY_GEOMETRY:     return "Geometry";
+        case CATEGORY_TEXTURES:     return "Textures";
+        case CATEGORY_STAGING:      return "Staging";
+        case CATEGORY_CONSTANTS:    return "Constants";
+        case CATEGORY_PER_INSTANCE: return "Per-instance";
+        default: return "Unknown";
+    }
+}
+
+} // namespace Diligent
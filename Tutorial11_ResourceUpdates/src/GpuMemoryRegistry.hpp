@@ -0,0 +1,119 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <vector>
+
+#include "RenderDevice.h"
+#include "Buffer.h"
+#include "Texture.h"
+#include "RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+// #Cuenta la memoria de GPU estimada de cada buffer y textura, por categoria. Los recursos se crean
+// con CreateBuffer/CreateTexture (o se registran con Track si los crea otro) y el registro se queda
+// con un weak pointer: Update() descuenta los que ya se liberaron, asi que nadie tiene que avisar.
+// #Es una estimacion: texturas con todos sus mips, capas y samples; buffers dinamicos con una copia
+// por frame en vuelo (el driver los renombra en cada Map con DISCARD). No incluye el swap chain, ni
+// alineacion ni padding del driver. Se usa desde cualquier hilo, como CpuProfiler
+class GpuMemoryRegistry
+{
+public:
+    enum CATEGORY : Uint32
+    {
+        CATEGORY_GEOMETRY = 0,
+        CATEGORY_TEXTURES,
+        CATEGORY_STAGING,
+        CATEGORY_CONSTANTS,
+        CATEGORY_PER_INSTANCE,
+        CATEGORY_COUNT
+    };
+
+    struct CategoryStats
+    {
+        Uint64 Bytes     = 0;
+        Uint64 PeakBytes = 0;
+        Uint32 Resources = 0;
+    };
+
+    static GpuMemoryRegistry& Get();
+
+    // #Copias de cada buffer dinamico. Afecta a los que se registran despues
+    void SetDynamicCopies(Uint32 NumCopies);
+
+    void CreateBuffer(IRenderDevice* pDevice, const BufferDesc& Desc, const BufferData* pData, CATEGORY Category, IBuffer** ppBuffer);
+    void CreateTexture(IRenderDevice* pDevice, const TextureDesc& Desc, const TextureData* pData, CATEGORY Category, ITexture** ppTexture);
+
+    // #Para recursos creados por otros (p. ej. CreateUniformBuffer de GraphicsTools)
+    void Track(IBuffer* pBuffer, CATEGORY Category);
+    void Track(ITexture* pTexture, CATEGORY Category);
+
+    // #Una vez por frame: descuenta los recursos liberados y avisa en el log al pasar el presupuesto
+    void Update();
+
+    // #Olvida todos los recursos. Antes de destruir el device, para no soltar los weak pointers despues
+    void Reset();
+    void ResetPeaks();
+
+    // #0 = sin presupuesto
+    void   SetBudget(Uint64 Bytes);
+    Uint64 GetBudget() const;
+    bool   IsOverBudget() const;
+
+    CategoryStats GetStats(CATEGORY Category) const;
+    CategoryStats GetTotalStats() const;
+
+    static Uint64      EstimateBufferBytes(const BufferDesc& Desc, Uint32 DynamicCopies);
+    static Uint64      EstimateTextureBytes(const TextureDesc& Desc);
+    static const char* GetCategoryName(CATEGORY Category);
+
+private:
+    void Add(IDeviceObject* pObject, CATEGORY Category, Uint64 Bytes);
+
+    struct Entry
+    {
+        RefCntWeakPtr<IDeviceObject> pObject;
+        CATEGORY                     Category = CATEGORY_GEOMETRY;
+        Uint64                       Bytes    = 0;
+    };
+
+    mutable std::mutex                        m_Mtx;
+    std::vector<Entry>                        m_Entries;
+    std::array<CategoryStats, CATEGORY_COUNT> m_Stats;
+    CategoryStats                             m_Total;
+    Uint32                                    m_DynamicCopies = 1;
+    Uint64                                    m_Budget        = 0;
+    bool                                      m_OverBudget    = false;
+};
+
+} // namespace Diligent
@@ -0,0 +1,111 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "GpuPassQueries.hpp"
+
+namespace Diligent
+{
+
+void GpuPassQueries::Initialize(IRenderDevice* pDevice, Uint32 NumFramesInFlight)
+{
+    const auto& Features     = pDevice->GetDeviceInfo().Features;
+    m_TimingSupported        = Features.TimestampQueries != DEVICE_FEATURE_STATE_DISABLED;
+    m_PipelineStatsSupported = Features.PipelineStatisticsQueries != DEVICE_FEATURE_STATE_DISABLED;
+
+    // #Una query mas que los frames en vuelo para que siempre haya una libre
+    const Uint32 NumQueries = NumFramesInFlight + 1;
+    for (Uint32 p = 0; p < PASS_COUNT; ++p)
+    {
+        auto& Pass = m_Passes[p];
+        Pass       = {};
+        if (m_TimingSupported)
+            Pass.pTiming.reset(new DurationQueryHelper{pDevice, NumQueries});
+
+        if (m_PipelineStatsSupported)
+        {
+            QueryDesc Desc;
+            Desc.Name = "Pass pipeline statistics query";
+            Desc.Type = QUERY_TYPE_PIPELINE_STATISTICS;
+            Pass.pPipelineStats.reset(new ScopedQueryHelper{pDevice, Desc, NumQueries});
+        }
+    }
+}
+
+void GpuPassQueries::BeginPass(IDeviceContext* pCtx, PASS Pass, bool PipelineStats)
+{
+    auto& Queries = m_Passes[Pass];
+    if (Queries.pTiming)
+        Queries.pTiming->Begin(pCtx);
+
+    Queries.PipelineStatsBegun = PipelineStats && Queries.pPipelineStats;
+    if (Queries.PipelineStatsBegun)
+        Queries.pPipelineStats->Begin(pCtx);
+}
+
+void GpuPassQueries::EndPass(IDeviceContext* pCtx, PASS Pass)
+{
+    auto& Queries = m_Passes[Pass];
+    auto& Stats   = Queries.Stats;
+
+    // #End() devuelve false si la query mas vieja todavia no esta lista; entonces se queda el
+    // resultado anterior
+    double Duration = 0;
+    if (Queries.pTiming && Queries.pTiming->End(pCtx, Duration))
+        Stats.GPUTimeMs = Duration * 1000.0;
+
+    if (Queries.PipelineStatsBegun)
+    {
+        QueryDataPipelineStatistics Data;
+        if (Queries.pPipelineStats->End(pCtx, &Data, sizeof(Data)))
+        {
+            Stats.HasPipelineStats   = true;
+            Stats.InputVertices      = Data.InputVertices;
+            Stats.InputPrimitives    = Data.InputPrimitives;
+            Stats.VSInvocations      = Data.VSInvocations;
+            Stats.ClippingPrimitives = Data.ClippingPrimitives;
+            Stats.PSInvocations      = Data.PSInvocations;
+        }
+    }
+    else
+    {
+        Stats.HasPipelineStats = false;
+    }
+}
+
+const char* GpuPassQueries::GetPassName(PASS Pass)
+{
+    switch (Pass)
+    {
+        case PASS_CLEAR:  return "Clear";
+        case PASS_GROUND: return "Ground";
+        case PASS_GRASS:  return "Grass";
+        case PASS_PLAYER: return "Player";
+        default: return "Unknown";
+    }
+}
+
+} // namespace Diligent
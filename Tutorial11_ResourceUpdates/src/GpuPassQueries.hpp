@@ -0,0 +1,97 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <array>
+#include <memory>
+
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "DurationQueryHelper.hpp"
+#include "ScopedQueryHelper.hpp"
+
+namespace Diligent
+{
+
+// #Tiempo de GPU y pipeline statistics de cada pasada de Render(). Cada pasada tiene su propio
+// ring de queries (los helpers de GraphicsTools), asi que leer resultados nunca espera a la GPU:
+// lo que se ve es el resultado de hace unos frames
+class GpuPassQueries
+{
+public:
+    enum PASS : Uint32
+    {
+        PASS_CLEAR = 0,
+        PASS_GROUND,
+        PASS_GRASS,
+        PASS_PLAYER,
+        PASS_COUNT
+    };
+
+    struct PassStats
+    {
+        double GPUTimeMs          = -1; // #-1 mientras no haya resultado
+        bool   HasPipelineStats   = false;
+        Uint64 InputVertices      = 0;
+        Uint64 InputPrimitives    = 0;
+        Uint64 VSInvocations      = 0;
+        Uint64 ClippingPrimitives = 0; // #Primitivas que salen del clipping hacia el rasterizador
+        Uint64 PSInvocations      = 0;
+    };
+
+    // #NumFramesInFlight: cuantos frames puede ir la GPU detras del CPU
+    void Initialize(IRenderDevice* pDevice, Uint32 NumFramesInFlight);
+
+    // #Con PipelineStats = false solo se mide el tiempo (p. ej. si la pasada se graba en
+    // deferred contexts y la query no puede abarcar varias command lists)
+    void BeginPass(IDeviceContext* pCtx, PASS Pass, bool PipelineStats = true);
+    void EndPass(IDeviceContext* pCtx, PASS Pass);
+
+    const PassStats& GetStats(PASS Pass) const { return m_Passes[Pass].Stats; }
+
+    bool IsTimingSupported() const { return m_TimingSupported; }
+    bool IsPipelineStatsSupported() const { return m_PipelineStatsSupported; }
+
+    static const char* GetPassName(PASS Pass);
+
+private:
+    struct PassQueries
+    {
+        std::unique_ptr<DurationQueryHelper> pTiming;
+        std::unique_ptr<ScopedQueryHelper>   pPipelineStats;
+        bool                                 PipelineStatsBegun = false;
+        PassStats                            Stats;
+    };
+
+    std::array<PassQueries, PASS_COUNT> m_Passes;
+
+    bool m_TimingSupported        = false;
+    bool m_PipelineStatsSupported = false;
+};
+
+} // namespace Diligent
@@ -0,0 +1,266 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "GrassBend.hpp"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#    define GRASS_BEND_X86 1
+#    include <immintrin.h>
+#    if defined(_MSC_VER)
+#        include <intrin.h>
+#    endif
+#else
+#    define GRASS_BEND_X86 0
+#endif
+
+#if GRASS_BEND_X86 && (defined(__GNUC__) || defined(__clang__))
+#    define GRASS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#    define GRASS_TARGET_AVX2
+#endif
+
+namespace Diligent
+{
+
+namespace
+{
+
+// #Misma formula que usaba Render() tuft por tuft
+void ComputeGrassBendScalar(const GrassBendParams& Params, const float* pX, const float* pZ, float* pBendX, float* pBendZ, size_t Count)
+{
+    const float PosScale = Params.MaxBend * Params.PositionInfluence;
+    const float VelScale = Params.MaxBend * Params.VelocityInfluence;
+
+    for (size_t i = 0; i < Count; ++i)
+    {
+        float dx = pX[i] - Params.PlayerX;
+        float dz = pZ[i] - Params.PlayerZ;
+        float d2 = dx * dx + dz * dz;
+
+        float bendX = 0.f, bendZ = 0.f;
+        if (d2 < Params.Radius * Params.Radius)
+        {
+            float dist = std::sqrt(d2);
+            float w    = 1.f - dist / Params.Radius;
+            w          = w * w;
+
+            float inv = dist > 1e-4f ? 1.f / dist : 0.f;
+            float ux  = dx * inv;
+            float uz  = dz * inv;
+
+            bendX = uz * PosScale * w - Params.VelDirZ * VelScale * w;
+            bendZ = -ux * PosScale * w + Params.VelDirX * VelScale * w;
+        }
+        pBendX[i] = bendX;
+        pBendZ[i] = bendZ;
+    }
+}
+
+#if GRASS_BEND_X86
+
+void ComputeGrassBendSSE(const GrassBendParams& Params, const float* pX, const float* pZ, float* pBendX, float* pBendZ, size_t Count)
+{
+    const __m128 PlayerX  = _mm_set1_ps(Params.PlayerX);
+    const __m128 PlayerZ  = _mm_set1_ps(Params.PlayerZ);
+    const __m128 Radius   = _mm_set1_ps(Params.Radius);
+    const __m128 Radius2  = _mm_set1_ps(Params.Radius * Params.Radius);
+    const __m128 PosScale = _mm_set1_ps(Params.MaxBend * Params.PositionInfluence);
+    const __m128 VelX     = _mm_set1_ps(Params.VelDirX * Params.MaxBend * Params.VelocityInfluence);
+    const __m128 VelZ     = _mm_set1_ps(Params.VelDirZ * Params.MaxBend * Params.VelocityInfluence);
+    const __m128 One      = _mm_set1_ps(1.f);
+    const __m128 MinDist  = _mm_set1_ps(1e-4f);
+
+    size_t i = 0;
+    for (; i + 4 <= Count; i += 4)
+    {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(pX + i), PlayerX);
+        __m128 dz = _mm_sub_ps(_mm_loadu_ps(pZ + i), PlayerZ);
+        __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz));
+
+        __m128 InRadius = _mm_cmplt_ps(d2, Radius2);
+
+        __m128 dist = _mm_sqrt_ps(d2);
+        __m128 w    = _mm_sub_ps(One, _mm_div_ps(dist, Radius));
+        w           = _mm_and_ps(_mm_mul_ps(w, w), InRadius);
+
+        // #inv = 0 cuando el tuft esta justo debajo del jugador
+        __m128 inv = _mm_and_ps(_mm_div_ps(One, _mm_max_ps(dist, MinDist)), _mm_cmpgt_ps(dist, MinDist));
+        __m128 ux  = _mm_mul_ps(dx, inv);
+        __m128 uz  = _mm_mul_ps(dz, inv);
+
+        __m128 bendX = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(uz, PosScale), VelZ), w);
+        __m128 bendZ = _mm_mul_ps(_mm_sub_ps(VelX, _mm_mul_ps(ux, PosScale)), w);
+        _mm_storeu_ps(pBendX + i, bendX);
+        _mm_storeu_ps(pBendZ + i, bendZ);
+    }
+    ComputeGrassBendScalar(Params, pX + i, pZ + i, pBendX + i, pBendZ + i, Count - i);
+}
+
+GRASS_TARGET_AVX2 void ComputeGrassBendAVX2(const GrassBendParams& Params, const float* pX, const float* pZ, float* pBendX, float* pBendZ, size_t Count)
+{
+    const __m256 PlayerX  = _mm256_set1_ps(Params.PlayerX);
+    const __m256 PlayerZ  = _mm256_set1_ps(Params.PlayerZ);
+    const __m256 Radius   = _mm256_set1_ps(Params.Radius);
+    const __m256 Radius2  = _mm256_set1_ps(Params.Radius * Params.Radius);
+    const __m256 PosScale = _mm256_set1_ps(Params.MaxBend * Params.PositionInfluence);
+    const __m256 VelX     = _mm256_set1_ps(Params.VelDirX * Params.MaxBend * Params.VelocityInfluence);
+    const __m256 VelZ     = _mm256_set1_ps(Params.VelDirZ * Params.MaxBend * Params.VelocityInfluence);
+    const __m256 One      = _mm256_set1_ps(1.f);
+    const __m256 MinDist  = _mm256_set1_ps(1e-4f);
+
+    size_t i = 0;
+    for (; i + 8 <= Count; i += 8)
+    {
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(pX + i), PlayerX);
+        __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(pZ + i), PlayerZ);
+        __m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dz, dz));
+
+        __m256 InRadius = _mm256_cmp_ps(d2, Radius2, _CMP_LT_OQ);
+
+        __m256 dist = _mm256_sqrt_ps(d2);
+        __m256 w    = _mm256_sub_ps(One, _mm256_div_ps(dist, Radius));
+        w           = _mm256_and_ps(_mm256_mul_ps(w, w), InRadius);
+
+        __m256 inv = _mm256_and_ps(_mm256_div_ps(One, _mm256_max_ps(dist, MinDist)), _mm256_cmp_ps(dist, MinDist, _CMP_GT_OQ));
+        __m256 ux  = _mm256_mul_ps(dx, inv);
+        __m256 uz  = _mm256_mul_ps(dz, inv);
+
+        __m256 bendX = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(uz, PosScale), VelZ), w);
+        __m256 bendZ = _mm256_mul_ps(_mm256_sub_ps(VelX, _mm256_mul_ps(ux, PosScale)), w);
+        _mm256_storeu_ps(pBendX + i, bendX);
+        _mm256_storeu_ps(pBendZ + i, bendZ);
+    }
+    // #El resto (menos de 8) va por SSE y luego escalar
+    ComputeGrassBendSSE(Params, pX + i, pZ + i, pBendX + i, pBendZ + i, Count - i);
+}
+
+bool CPUSupportsAVX2()
+{
+#    if defined(_MSC_VER)
+    int Info[4] = {};
+    __cpuid(Info, 1);
+    const bool OSXSave = (Info[2] & (1 << 27)) != 0;
+    const bool AVX     = (Info[2] & (1 << 28)) != 0;
+    if (!OSXSave || !AVX)
+        return false;
+    // The OS must save YMM registers on context switch
+    if ((_xgetbv(0) & 0x6) != 0x6)
+        return false;
+    __cpuidex(Info, 7, 0);
+    return (Info[1] & (1 << 5)) != 0;
+#    else
+    return __builtin_cpu_supports("avx2") != 0;
+#    endif
+}
+
+#endif // GRASS_BEND_X86
+
+} // namespace
+
+const char* GetGrassBendKernelName(GrassBendKernel Kernel)
+{
+    switch (Kernel)
+    {
+        case GrassBendKernel::Scalar: return "Scalar";
+        case GrassBendKernel::SSE: return "SSE";
+        case GrassBendKernel::AVX2: return "AVX2";
+        default: return "Unknown";
+    }
+}
+
+bool IsGrassBendKernelSupported(GrassBendKernel Kernel)
+{
+    switch (Kernel)
+    {
+        case GrassBendKernel::Scalar: return true;
+#if GRASS_BEND_X86
+        // SSE2 is part of the x86-64 baseline
+        case GrassBendKernel::SSE: return true;
+        case GrassBendKernel::AVX2:
+        {
+            static const bool AVX2Supported = CPUSupportsAVX2();
+            return AVX2Supported;
+        }
+#endif
+        default: return false;
+    }
+}
+
+GrassBendKernel GetBestGrassBendKernel()
+{
+    if (IsGrassBendKernelSupported(GrassBendKernel::AVX2))
+        return GrassBendKernel::AVX2;
+    if (IsGrassBendKernelSupported(GrassBendKernel::SSE))
+        return GrassBendKernel::SSE;
+    return GrassBendKernel::Scalar;
+}
+
+void ComputeGrassBend(GrassBendKernel        Kernel,
+                      const GrassBendParams& Params,
+                      const float*           pX,
+                      const float*           pZ,
+                      float*                 pBendX,
+                      float*                 pBendZ,
+                      size_t                 Count)
+{
+    switch (Kernel)
+    {
+#if GRASS_BEND_X86
+        case GrassBendKernel::AVX2:
+            ComputeGrassBendAVX2(Params, pX, pZ, pBendX, pBendZ, Count);
+            break;
+
+        case GrassBendKernel::SSE:
+            ComputeGrassBendSSE(Params, pX, pZ, pBendX, pBendZ, Count);
+            break;
+#endif
+
+        default:
+            ComputeGrassBendScalar(Params, pX, pZ, pBendX, pBendZ, Count);
+    }
+}
+
+float ValidateGrassBendKernel(GrassBendKernel Kernel, const GrassBendParams& Params, const float* pX, const float* pZ, size_t Count)
+{
+    std::vector<float> RefX(Count), RefZ(Count), BendX(Count), BendZ(Count);
+    ComputeGrassBendScalar(Params, pX, pZ, RefX.data(), RefZ.data(), Count);
+    ComputeGrassBend(Kernel, Params, pX, pZ, BendX.data(), BendZ.data(), Count);
+
+    float MaxDiff = 0;
+    for (size_t i = 0; i < Count; ++i)
+    {
+        MaxDiff = std::max(MaxDiff, std::abs(BendX[i] - RefX[i]));
+        MaxDiff = std::max(MaxDiff, std::abs(BendZ[i] - RefZ[i]));
+    }
+    return MaxDiff;
+}
+
+} // namespace Diligent
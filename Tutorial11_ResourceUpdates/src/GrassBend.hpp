@@ -0,0 +1,75 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include "BasicMath.hpp"
+#include "AlignedAllocator.hpp"
+
+namespace Diligent
+{
+
+// #Parametros del bend que provoca el jugador sobre los tufts cercanos
+struct GrassBendParams
+{
+    float PlayerX           = 0;
+    float PlayerZ           = 0;
+    float VelDirX           = 0; // #Direccion de la velocidad del jugador, normalizada
+    float VelDirZ           = 0;
+    float Radius            = 3.4f;
+    float MaxBend           = 0.45f;
+    float PositionInfluence = 4.5f;
+    float VelocityInfluence = 2.0f;
+};
+
+enum class GrassBendKernel : Uint8
+{
+    Scalar = 0,
+    SSE,
+    AVX2,
+    Count
+};
+
+const char*     GetGrassBendKernelName(GrassBendKernel Kernel);
+bool            IsGrassBendKernelSupported(GrassBendKernel Kernel);
+GrassBendKernel GetBestGrassBendKernel();
+
+// #Calcula el bend (angulos en X y en Z) de Count tufts a partir de sus posiciones.
+// Los kernels SIMD procesan 4 (SSE) u 8 (AVX2) tufts por iteracion y el resto en escalar
+void ComputeGrassBend(GrassBendKernel        Kernel,
+                      const GrassBendParams& Params,
+                      const float*           pX,
+                      const float*           pZ,
+                      float*                 pBendX,
+                      float*                 pBendZ,
+                      size_t                 Count);
+
+// #Maxima diferencia entre el kernel dado y la formula escalar sobre las mismas posiciones
+float ValidateGrassBendKernel(GrassBendKernel Kernel, const GrassBendParams& Params, const float* pX, const float* pZ, size_t Count);
+
+} // namespace Diligent
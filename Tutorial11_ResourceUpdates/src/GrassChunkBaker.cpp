@@ -0,0 +1,234 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "GrassChunkBaker.hpp"
+#include "CpuProfiler.hpp"
+#include "GpuMemoryRegistry.hpp"
+
+namespace Diligent
+{
+
+void GrassChunkBaker::Initialize(IRenderDevice* pDevice, const PackedMesh& TuftMesh, const MeshIndexRange& TuftRange, Uint32 MaxChunks, Uint32 MaxBakesPerFrame)
+{
+    m_pDevice          = pDevice;
+    m_Format           = TuftMesh.Format;
+    m_MaxChunks        = MaxChunks;
+    m_MaxBakesPerFrame = MaxBakesPerFrame;
+
+    // #Se copia solo el LOD, con sus vertices numerados desde 0
+    std::vector<Uint32> Remap(TuftMesh.Vertices.size(), ~0u);
+    m_TuftVertices.clear();
+    m_TuftIndices.clear();
+    for (Uint32 i = TuftRange.FirstIndex; i < TuftRange.FirstIndex + TuftRange.NumIndices; ++i)
+    {
+        const Uint32 v = TuftMesh.Indices[i];
+        if (Remap[v] == ~0u)
+        {
+            Remap[v] = static_cast<Uint32>(m_TuftVertices.size());
+            m_TuftVertices.push_back(TuftMesh.Vertices[v]);
+        }
+        m_TuftIndices.push_back(Remap[v]);
+    }
+
+    Reset();
+    m_Stats.TuftACMR = ComputeACMR(m_TuftIndices.data(), static_cast<Uint32>(m_TuftIndices.size()));
+}
+
+void GrassChunkBaker::Reset()
+{
+    m_Chunks.clear();
+    m_Stats.CachedChunks = 0;
+    m_Stats.CachedBytes  = 0;
+}
+
+void GrassChunkBaker::BeginFrame()
+{
+    ++m_Frame;
+    m_Stats.BakedLastFrame = 0;
+}
+
+const GrassChunkBaker::BakedChunk* GrassChunkBaker::GetOrBake(const GrassField& Field, const GrassField::Chunk& Chunk, Uint32 NumVariants, float Yaw, const SliceFunc& GetSlice)
+{
+    if (Chunk.NumTufts == 0)
+        return nullptr;
+
+    const float X = Field.GetTuftX()[Chunk.FirstTuft];
+    const float Z = Field.GetTuftZ()[Chunk.FirstTuft];
+
+    const auto   Steps   = static_cast<int>(YawSteps);
+    const int    Step    = static_cast<int>(std::lround(Yaw * (YawSteps / (2.f * PI_F))));
+    const Uint32 YawStep = static_cast<Uint32>(((Step % Steps) + Steps) % Steps);
+
+    auto It = m_Chunks.find(Chunk.Id);
+    if (It != m_Chunks.end())
+    {
+        auto& Baked = It->second;
+        if (Baked.FirstTuft == Chunk.FirstTuft && Baked.NumTufts == Chunk.NumTufts && Baked.NumVariants == NumVariants &&
+            Baked.YawStep == YawStep && Baked.FirstTuftX == X && Baked.FirstTuftZ == Z)
+        {
+            Baked.LastUsedFrame = m_Frame;
+            return &Baked;
+        }
+    }
+
+    if (m_Stats.BakedLastFrame >= m_MaxBakesPerFrame)
+        return nullptr;
+
+    if (It == m_Chunks.end())
+    {
+        // #Si todos los residentes se usan en este frame no se puede descartar ninguno
+        if (m_Chunks.size() >= m_MaxChunks && !EvictLeastRecentlyUsed())
+            return nullptr;
+        It = m_Chunks.emplace(Chunk.Id, BakedChunk{}).first;
+    }
+    else
+    {
+        m_Stats.CachedBytes -= It->second.NumBytes;
+        It->second = {};
+    }
+
+    auto& Baked = It->second;
+    Bake(Field, Chunk, NumVariants, YawStep, GetSlice, Baked);
+    Baked.FirstTuft     = Chunk.FirstTuft;
+    Baked.NumVariants   = NumVariants;
+    Baked.YawStep       = YawStep;
+    Baked.FirstTuftX    = X;
+    Baked.FirstTuftZ    = Z;
+    Baked.LastUsedFrame = m_Frame;
+
+    ++m_Stats.BakedLastFrame;
+    ++m_Stats.TotalBaked;
+    m_Stats.CachedBytes += Baked.NumBytes;
+    m_Stats.CachedChunks = static_cast<Uint32>(m_Chunks.size());
+    return &Baked;
+}
+
+void GrassChunkBaker::Bake(const GrassField& Field, const GrassField::Chunk& Chunk, Uint32 NumVariants, Uint32 YawStep, const SliceFunc& GetSlice, BakedChunk& Baked)
+{
+    GRASS_PROFILE_SCOPE("GrassChunkBaker::Bake");
+
+    const float* TuftX = Field.GetTuftX();
+    const float* TuftZ = Field.GetTuftZ();
+
+    // #Los tufts se ordenan por capa para que cada capa sea un rango seguido de indices
+    std::vector<Uint32> Tufts(Chunk.NumTufts);
+    std::vector<Uint32> Slices(Chunk.NumTufts);
+    std::iota(Tufts.begin(), Tufts.end(), Chunk.FirstTuft);
+    for (Uint32 i = 0; i < Chunk.NumTufts; ++i)
+        Slices[i] = GetSlice(TuftX[Tufts[i]], TuftZ[Tufts[i]]);
+    std::vector<Uint32> Order(Chunk.NumTufts);
+    std::iota(Order.begin(), Order.end(), 0u);
+    std::stable_sort(Order.begin(), Order.end(), [&](Uint32 a, Uint32 b) { return Slices[a] < Slices[b]; });
+
+    // #Las posiciones quedan relativas al centro del chunk para no perder precision al cuantizar
+    Baked.Origin = float3{(Chunk.Bounds.Min.x + Chunk.Bounds.Max.x) * 0.5f, 0.f, (Chunk.Bounds.Min.z + Chunk.Bounds.Max.z) * 0.5f};
+
+    const auto NumTuftVerts   = static_cast<Uint32>(m_TuftVertices.size());
+    const auto NumTuftIndices = static_cast<Uint32>(m_TuftIndices.size());
+
+    // #Mismo giro que float4x4::RotationY en el camino sin hornear
+    const float Yaw = static_cast<float>(YawStep) * (2.f * PI_F / YawSteps);
+    const float Sin = std::sin(Yaw);
+    const float Cos = std::cos(Yaw);
+
+    std::vector<MeshVertex> Vertices;
+    std::vector<Uint32>     Indices;
+    Vertices.reserve(size_t{NumTuftVerts} * Chunk.NumTufts);
+    Indices.reserve(size_t{NumTuftIndices} * Chunk.NumTufts);
+    for (Uint32 i = 0; i < Chunk.NumTufts; ++i)
+    {
+        const Uint32 t     = Tufts[Order[i]];
+        const Uint32 Slice = Slices[Order[i]];
+        if (Baked.Slices.empty() || Baked.Slices.back().Slice != Slice)
+            Baked.Slices.push_back({Slice, static_cast<Uint32>(Indices.size()), 0});
+        Baked.Slices.back().NumIndices += NumTuftIndices;
+
+        const float3 Offset{TuftX[t] - Baked.Origin.x, 0.f, TuftZ[t] - Baked.Origin.z};
+        const auto   BaseVertex = static_cast<Uint32>(Vertices.size());
+        for (const auto& Vert : m_TuftVertices)
+        {
+            const float3 Pos{Vert.Pos.x * Cos + Vert.Pos.z * Sin, Vert.Pos.y, Vert.Pos.z * Cos - Vert.Pos.x * Sin};
+            Vertices.push_back({Pos + Offset, Vert.UV});
+        }
+        for (auto Index : m_TuftIndices)
+            Indices.push_back(BaseVertex + Index);
+    }
+
+    // #El LOD ya esta optimizado y cada tuft usa solo sus vertices, asi que no hace falta
+    // soldar ni reordenar: solo validar y cuantizar
+    const auto Mesh = BuildMesh("Baked grass chunk", Vertices.data(), static_cast<Uint32>(Vertices.size()),
+                                Indices.data(), static_cast<Uint32>(Indices.size()), m_Format);
+
+    BufferDesc VertBuffDesc;
+    VertBuffDesc.Name      = "Baked grass chunk vertex buffer";
+    VertBuffDesc.Usage     = USAGE_IMMUTABLE;
+    VertBuffDesc.BindFlags = BIND_VERTEX_BUFFER;
+    VertBuffDesc.Size      = static_cast<Uint64>(Mesh.VertexData.size());
+    BufferData VBData;
+    VBData.pData    = Mesh.VertexData.data();
+    VBData.DataSize = VertBuffDesc.Size;
+    GpuMemoryRegistry::Get().CreateBuffer(m_pDevice, VertBuffDesc, &VBData, GpuMemoryRegistry::CATEGORY_GEOMETRY, &Baked.pVertexBuffer);
+
+    BufferDesc IndBuffDesc;
+    IndBuffDesc.Name      = "Baked grass chunk index buffer";
+    IndBuffDesc.Usage     = USAGE_IMMUTABLE;
+    IndBuffDesc.BindFlags = BIND_INDEX_BUFFER;
+    IndBuffDesc.Size      = static_cast<Uint64>(Mesh.IndexData.size());
+    BufferData IBData;
+    IBData.pData    = Mesh.IndexData.data();
+    IBData.DataSize = IndBuffDesc.Size;
+    GpuMemoryRegistry::Get().CreateBuffer(m_pDevice, IndBuffDesc, &IBData, GpuMemoryRegistry::CATEGORY_GEOMETRY, &Baked.pIndexBuffer);
+
+    Baked.IndexType = Mesh.IndexType;
+    Baked.PosScale  = Mesh.PosScale;
+    Baked.NumTufts  = Chunk.NumTufts;
+    Baked.NumBytes  = Mesh.Report.VertexBytes + Mesh.Report.IndexBytes;
+}
+
+bool GrassChunkBaker::EvictLeastRecentlyUsed()
+{
+    auto Oldest = m_Chunks.begin();
+    for (auto It = m_Chunks.begin(); It != m_Chunks.end(); ++It)
+    {
+        if (It->second.LastUsedFrame < Oldest->second.LastUsedFrame)
+            Oldest = It;
+    }
+    // #Los punteros que se devolvieron en este frame tienen que seguir siendo validos
+    if (Oldest == m_Chunks.end() || Oldest->second.LastUsedFrame == m_Frame)
+        return false;
+
+    m_Stats.CachedBytes -= Oldest->second.NumBytes;
+    m_Chunks.erase(Oldest);
+    return true;
+}
+
+} // namespace Diligent
@@ -0,0 +1,130 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "RenderDevice.h"
+#include "Buffer.h"
+#include "RefCntAutoPtr.hpp"
+#include "BasicMath.hpp"
+#include "GrassField.hpp"
+#include "MeshBuilder.hpp"
+
+namespace Diligent
+{
+
+// #Chunks lejanos horneados: todos los tufts de un chunk se copian, ya trasladados, en un solo
+// vertex/index buffer estatico que se dibuja con un draw por variante de textura en vez de un
+// tuft por instancia. Solo sirve para chunks que no se mueven (sin bend ni pisadas), porque el
+// mesh horneado no tiene viento ni deformacion. Se hornea la tarjeta del ultimo LOD, girada en Y
+// hacia la camara en pasos de 360 / YawSteps grados; el chunk se vuelve a hornear cuando la
+// camara cambia de paso.
+// Los chunks horneados se guardan por Id y se descartan los que hace mas tiempo que no se usan
+class GrassChunkBaker
+{
+public:
+    // #Tufts de una misma capa del texture array, seguidos en el index buffer
+    struct SliceRange
+    {
+        Uint32 Slice      = 0;
+        Uint32 FirstIndex = 0;
+        Uint32 NumIndices = 0;
+    };
+
+    struct BakedChunk
+    {
+        RefCntAutoPtr<IBuffer>  pVertexBuffer;
+        RefCntAutoPtr<IBuffer>  pIndexBuffer;
+        VALUE_TYPE              IndexType = VT_UINT32;
+        float4                  PosScale;
+        float3                  Origin; // #Las posiciones del mesh son relativas a este punto
+        std::vector<SliceRange> Slices;
+        Uint32                  NumTufts  = 0;
+        Uint32                  NumBytes  = 0;
+
+        // #Para saber si el chunk residente con el mismo Id sigue siendo el mismo
+        Uint32 FirstTuft     = 0;
+        Uint32 NumVariants   = 0;
+        Uint32 YawStep       = 0;
+        float  FirstTuftX    = 0;
+        float  FirstTuftZ    = 0;
+        Uint64 LastUsedFrame = 0;
+    };
+
+    struct Stats
+    {
+        Uint32 CachedChunks   = 0;
+        Uint64 CachedBytes    = 0;
+        Uint32 BakedLastFrame = 0;
+        Uint64 TotalBaked     = 0;
+        float  TuftACMR       = 0; // #ACMR del LOD que se hornea
+    };
+
+    // #Devuelve la capa del texture array del tuft en (X, Z)
+    using SliceFunc = std::function<Uint32(float X, float Z)>;
+
+    static constexpr Uint32 YawSteps = 16;
+
+    // #TuftMesh es la malla del pasto ya construida; se hornea su rango TuftRange (un LOD)
+    void Initialize(IRenderDevice* pDevice, const PackedMesh& TuftMesh, const MeshIndexRange& TuftRange, Uint32 MaxChunks, Uint32 MaxBakesPerFrame);
+
+    // #Descarta todo; hay que llamarlo cuando se vuelve a crear el campo
+    void Reset();
+
+    void BeginFrame();
+
+    // #El mesh horneado del chunk, horneandolo si hace falta. Yaw es el giro en Y que deja los tufts
+    // de frente a la camara. nullptr si no estaba horneado y ya se hornearon MaxBakesPerFrame
+    // chunks en este frame
+    const BakedChunk* GetOrBake(const GrassField& Field, const GrassField::Chunk& Chunk, Uint32 NumVariants, float Yaw, const SliceFunc& GetSlice);
+
+    const Stats& GetStats() const { return m_Stats; }
+
+private:
+    void Bake(const GrassField& Field, const GrassField::Chunk& Chunk, Uint32 NumVariants, Uint32 YawStep, const SliceFunc& GetSlice, BakedChunk& Baked);
+    bool EvictLeastRecentlyUsed();
+
+    RefCntAutoPtr<IRenderDevice> m_pDevice;
+
+    MESH_VERTEX_FORMAT      m_Format = MESH_VERTEX_FORMAT_FLOAT32;
+    std::vector<MeshVertex> m_TuftVertices; // #Solo los vertices que usa TuftRange, renumerados
+    std::vector<Uint32>     m_TuftIndices;
+
+    Uint32 m_MaxChunks        = 0;
+    Uint32 m_MaxBakesPerFrame = 0;
+    Uint64 m_Frame            = 0;
+    Stats  m_Stats;
+
+    std::unordered_map<Uint32, BakedChunk> m_Chunks; // #Por GrassField::Chunk::Id
+};
+
+} // namespace Diligent
@@ -0,0 +1,301 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "GrassDeformation.hpp"
+#include "CpuProfiler.hpp"
+
+namespace Diligent
+{
+
+void GrassDeformation::Initialize(const GrassField& Field)
+{
+    const Uint32 NumTufts = Field.GetTuftCapacity();
+
+    m_BendX.assign(NumTufts, 0.f);
+    m_BendZ.assign(NumTufts, 0.f);
+    m_ActiveIndex.assign(NumTufts, InvalidActiveIndex);
+    m_Active.clear();
+    m_Stats = {};
+
+    const Uint32 ChunkSize = Field.GetConfig().ChunkSize;
+    m_PushX.resize(ChunkSize * ChunkSize);
+    m_PushZ.resize(ChunkSize * ChunkSize);
+    m_PushMax2.resize(ChunkSize * ChunkSize);
+    m_BodyX.resize(ChunkSize);
+    m_BodyZ.resize(ChunkSize);
+}
+
+void GrassDeformation::ResetTufts(Uint32 FirstTuft, Uint32 NumTufts)
+{
+    for (Uint32 t = FirstTuft; t < FirstTuft + NumTufts; ++t)
+    {
+        const Uint32 a = m_ActiveIndex[t];
+        if (a != InvalidActiveIndex)
+        {
+            if (a + 1 < m_Active.size())
+            {
+                m_Active[a]                      = m_Active.back();
+                m_ActiveIndex[m_Active[a].Tuft] = a;
+            }
+            m_Active.pop_back();
+            m_ActiveIndex[t] = InvalidActiveIndex;
+        }
+        m_BendX[t] = 0.f;
+        m_BendZ[t] = 0.f;
+    }
+    m_Stats.ActiveTufts = static_cast<Uint32>(m_Active.size());
+}
+
+// #Activa los tufts que pisa algun cuerpo y les pone como objetivo el bend del kernel. Para cada
+// chunk el spatial hash da los cuerpos que lo tocan, y cada cuerpo solo evalua las filas y
+// columnas de tufts que caen dentro de su radio. Donde se pisan varios cuerpos los bends se
+// suman, pero sin pasar del mayor de ellos, asi dos cuerpos juntos no doblan el doble
+void GrassDeformation::Disturb(const GrassField& Field, GrassBendKernel Kernel, const GrassBendParams& BendParams, GrassInteractorGrid& Interactors)
+{
+    const float* TuftX   = Field.GetTuftX();
+    const float* TuftZ   = Field.GetTuftZ();
+    const float  Spacing = Field.GetConfig().Spacing;
+
+    for (const auto& Chunk : Field.GetChunks())
+    {
+        if (Chunk.NumTufts == 0)
+            continue;
+
+        // #Rectangulo que ocupan las posiciones de los tufts
+        const Uint32 NumColumns = Chunk.TuftsPerRow;
+        const Uint32 NumRows    = Chunk.NumTufts / NumColumns;
+        const float  X0         = TuftX[Chunk.FirstTuft];
+        const float  Z0         = TuftZ[Chunk.FirstTuft];
+        const float  X1         = X0 + static_cast<float>(NumColumns - 1) * Spacing;
+        const float  Z1         = Z0 + static_cast<float>(NumRows - 1) * Spacing;
+
+        m_Candidates.clear();
+        Interactors.Query(X0, Z0, X1, Z1, m_Candidates);
+        if (m_Candidates.empty())
+            continue;
+        ++m_Stats.ChunksTouched;
+        m_Stats.CandidatePairs += static_cast<Uint32>(m_Candidates.size());
+
+        std::fill_n(m_PushX.begin(), Chunk.NumTufts, 0.f);
+        std::fill_n(m_PushZ.begin(), Chunk.NumTufts, 0.f);
+        std::fill_n(m_PushMax2.begin(), Chunk.NumTufts, 0.f);
+
+        for (Uint32 Candidate : m_Candidates)
+        {
+            const auto& Body = Interactors.Get(Candidate);
+
+            GrassBendParams Params = BendParams;
+            Params.PlayerX         = Body.X;
+            Params.PlayerZ         = Body.Z;
+            Params.VelDirX         = Body.VelDirX;
+            Params.VelDirZ         = Body.VelDirZ;
+            Params.Radius          = Body.Radius;
+
+            // #Columnas y filas del chunk dentro del cuadrado que rodea al circulo
+            const int Col0 = std::max(static_cast<int>(std::ceil((Body.X - Body.Radius - X0) / Spacing)), 0);
+            const int Col1 = std::min(static_cast<int>(std::floor((Body.X + Body.Radius - X0) / Spacing)), static_cast<int>(NumColumns) - 1);
+            const int Row0 = std::max(static_cast<int>(std::ceil((Body.Z - Body.Radius - Z0) / Spacing)), 0);
+            const int Row1 = std::min(static_cast<int>(std::floor((Body.Z + Body.Radius - Z0) / Spacing)), static_cast<int>(NumRows) - 1);
+            if (Col0 > Col1 || Row0 > Row1)
+                continue;
+
+            const Uint32 Count = static_cast<Uint32>(Col1 - Col0 + 1);
+            for (int Row = Row0; Row <= Row1; ++Row)
+            {
+                const Uint32 First = static_cast<Uint32>(Row) * NumColumns + static_cast<Uint32>(Col0);
+                ComputeGrassBend(Kernel, Params, TuftX + Chunk.FirstTuft + First, TuftZ + Chunk.FirstTuft + First,
+                                 m_BodyX.data(), m_BodyZ.data(), Count);
+                for (Uint32 c = 0; c < Count; ++c)
+                {
+                    const float BendX = m_BodyX[c];
+                    const float BendZ = m_BodyZ[c];
+                    m_PushX[First + c] += BendX;
+                    m_PushZ[First + c] += BendZ;
+                    m_PushMax2[First + c] = std::max(m_PushMax2[First + c], BendX * BendX + BendZ * BendZ);
+                }
+            }
+            m_Stats.TuftTests += Count * static_cast<Uint32>(Row1 - Row0 + 1);
+        }
+
+        for (Uint32 i = 0; i < Chunk.NumTufts; ++i)
+        {
+            if (m_PushX[i] == 0.f && m_PushZ[i] == 0.f)
+                continue;
+
+            const float Len2 = m_PushX[i] * m_PushX[i] + m_PushZ[i] * m_PushZ[i];
+            if (Len2 > m_PushMax2[i])
+            {
+                const float Scale = std::sqrt(m_PushMax2[i] / Len2);
+                m_PushX[i] *= Scale;
+                m_PushZ[i] *= Scale;
+            }
+
+            const Uint32 Tuft = Chunk.FirstTuft + i;
+            if (m_ActiveIndex[Tuft] == InvalidActiveIndex)
+            {
+                m_ActiveIndex[Tuft] = static_cast<Uint32>(m_Active.size());
+                m_Active.push_back({Tuft, m_BendX[Tuft], m_BendZ[Tuft], 0.f, 0.f, 0.f, 0.f, 0.f});
+                ++m_Stats.Activated;
+            }
+
+            auto& State   = m_Active[m_ActiveIndex[Tuft]];
+            State.TargetX = m_PushX[i];
+            State.TargetZ = m_PushZ[i];
+            State.Timer   = 0;
+        }
+    }
+}
+
+// #Euler semi-implicito sobre m_Active[First, Last). Cada tuft solo escribe su propio estado y
+// su bend, asi que distintos rangos se pueden integrar en paralelo
+void GrassDeformation::Integrate(Uint32 First, Uint32 Last, float TimeStep)
+{
+    GRASS_PROFILE_SCOPE("GrassDeformation::Integrate");
+
+    const float dt = TimeStep;
+
+    for (Uint32 a = First; a < Last; ++a)
+    {
+        auto& State = m_Active[a];
+
+        const bool  Recovering = State.Timer >= m_Params.RecoverDelay;
+        const float k          = Recovering ? m_Params.RecoverStiffness : m_Params.PushStiffness;
+        const float c          = Recovering ? m_Params.RecoverDamping : m_Params.PushDamping;
+        const float TargetX    = Recovering ? 0.f : State.TargetX;
+        const float TargetZ    = Recovering ? 0.f : State.TargetZ;
+
+        State.VelX += (-k * (State.AngleX - TargetX) - c * State.VelX) * dt;
+        State.VelZ += (-k * (State.AngleZ - TargetZ) - c * State.VelZ) * dt;
+        State.AngleX += State.VelX * dt;
+        State.AngleZ += State.VelZ * dt;
+        State.Timer += dt;
+
+        m_BendX[State.Tuft] = State.AngleX;
+        m_BendZ[State.Tuft] = State.AngleZ;
+    }
+}
+
+// #Saca de la lista los tufts que ya se enderezaron (swap con el ultimo)
+void GrassDeformation::RemoveRestingTufts()
+{
+    const float Eps = m_Params.RestEpsilon;
+    for (Uint32 a = 0; a < m_Active.size();)
+    {
+        const auto& State = m_Active[a];
+        const bool  AtRest =
+            State.Timer >= m_Params.RecoverDelay &&
+            std::abs(State.AngleX) < Eps && std::abs(State.AngleZ) < Eps &&
+            std::abs(State.VelX) < Eps && std::abs(State.VelZ) < Eps;
+        if (!AtRest)
+        {
+            ++a;
+            continue;
+        }
+
+        m_BendX[State.Tuft]       = 0.f;
+        m_BendZ[State.Tuft]       = 0.f;
+        m_ActiveIndex[State.Tuft] = InvalidActiveIndex;
+        if (a + 1 < m_Active.size())
+        {
+            m_Active[a]                      = m_Active.back();
+            m_ActiveIndex[m_Active[a].Tuft] = a;
+        }
+        m_Active.pop_back();
+        ++m_Stats.Deactivated;
+    }
+}
+
+void GrassDeformation::Step(const GrassField&      Field,
+                            GrassBendKernel        Kernel,
+                            const GrassBendParams& BendParams,
+                            GrassInteractorGrid&   Interactors,
+                            float                  TimeStep,
+                            IThreadPool*           pThreadPool,
+                            Uint32                 NumPoolThreads)
+{
+    GRASS_PROFILE_SCOPE("GrassDeformation::Step");
+
+    m_Stats.Activated      = 0;
+    m_Stats.Deactivated    = 0;
+    m_Stats.Tasks          = 0;
+    m_Stats.Interactors    = Interactors.GetNumInteractors();
+    m_Stats.ChunksTouched  = 0;
+    m_Stats.CandidatePairs = 0;
+    m_Stats.TuftTests      = 0;
+
+    {
+        GRASS_PROFILE_SCOPE("GrassDeformation::Disturb");
+        const auto DisturbStart = std::chrono::high_resolution_clock::now();
+        Disturb(Field, Kernel, BendParams, Interactors);
+        m_Stats.DisturbMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - DisturbStart).count();
+    }
+
+    const Uint32 NumActive = static_cast<Uint32>(m_Active.size());
+    const Uint32 NumTasks  = pThreadPool != nullptr ?
+        std::min(NumActive / std::max(m_Params.MinTuftsPerTask, 1u), NumPoolThreads + 1) :
+        0;
+    if (NumTasks <= 1)
+    {
+        Integrate(0, NumActive, TimeStep);
+    }
+    else
+    {
+        // #El hilo principal integra el primer rango mientras el pool hace el resto
+        m_Tasks.clear();
+        for (Uint32 t = 1; t < NumTasks; ++t)
+        {
+            const Uint32 First = NumActive * t / NumTasks;
+            const Uint32 Last  = NumActive * (t + 1) / NumTasks;
+            m_Tasks.emplace_back(EnqueueAsyncWork(pThreadPool,
+                                                  [this, First, Last, TimeStep](Uint32 /*ThreadId*/) {
+                                                      Integrate(First, Last, TimeStep);
+                                                      return ASYNC_TASK_STATUS_COMPLETE;
+                                                  }));
+        }
+        Integrate(0, NumActive / NumTasks, TimeStep);
+        for (auto& pTask : m_Tasks)
+            pTask->WaitForCompletion();
+        m_Tasks.clear();
+        m_Stats.Tasks = NumTasks;
+    }
+
+    RemoveRestingTufts();
+    m_Stats.ActiveTufts = static_cast<Uint32>(m_Active.size());
+}
+
+void GrassDeformation::GetBentTufts(std::vector<BentTuft>& Out) const
+{
+    Out.resize(m_Active.size());
+    for (size_t a = 0; a < m_Active.size(); ++a)
+        Out[a] = {m_Active[a].Tuft, m_Active[a].AngleX, m_Active[a].AngleZ};
+}
+
+} // namespace Diligent
@@ -0,0 +1,145 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+#include "BasicMath.hpp"
+#include "ThreadPool.hpp"
+#include "GrassField.hpp"
+#include "GrassBend.hpp"
+#include "GrassInteractors.hpp"
+
+namespace Diligent
+{
+
+// #Deformacion persistente del pasto: cada tuft pisado guarda su angulo y su velocidad angular
+// y un resorte amortiguado lo lleva hacia el bend de los cuerpos que lo pisan y despues de
+// vuelta a su posicion de reposo. Solo se simulan los tufts activos (lista dispersa), asi que el
+// costo depende del area pisada y no del tamano del campo
+class GrassDeformation
+{
+public:
+    struct Params
+    {
+        float  PushStiffness    = 120.f; // #Resorte hacia el bend del jugador mientras lo pisa
+        float  PushDamping      = 18.f;
+        float  RecoverDelay     = 1.5f;  // #Segundos que el tuft sigue pisado despues de que el jugador se va
+        float  RecoverStiffness = 4.f;   // #Resorte que endereza el tuft
+        float  RecoverDamping   = 3.6f;  // #Un poco menos que critico (2 * sqrt(k)): rebota apenas
+        float  RestEpsilon      = 1e-3f; // #Angulo y velocidad por debajo de esto = en reposo
+        Uint32 MinTuftsPerTask  = 1024;  // #Con menos tufts activos se integra en el hilo principal
+    };
+
+    struct Stats
+    {
+        Uint32 ActiveTufts = 0;
+        Uint32 Activated   = 0; // #En el ultimo Step
+        Uint32 Deactivated = 0;
+        Uint32 Tasks       = 0;
+
+        // #Interaccion con los cuerpos en el ultimo Step
+        Uint32 Interactors    = 0;
+        Uint32 ChunksTouched  = 0; // #Chunks con al menos un cuerpo encima
+        Uint32 CandidatePairs = 0; // #Pares chunk-cuerpo que devolvio el spatial hash
+        Uint32 TuftTests      = 0; // #Tufts evaluados por el kernel de bend, sumando todos los cuerpos
+        double DisturbMs      = 0;
+    };
+
+    // #Bend de un tuft activo, para copiar el estado sin recorrer todo el campo
+    struct BentTuft
+    {
+        Uint32 Tuft;
+        float  BendX, BendZ;
+    };
+
+    // #Memoria por tuft del campo (bend y el indice en la lista de activos)
+    static constexpr Uint32 BytesPerTuft = 2 * sizeof(float) + sizeof(Uint32);
+
+    void Initialize(const GrassField& Field);
+
+    // #Avanza la simulacion un paso de TimeStep segundos. El paso lo fija quien llama (ver el hilo
+    // de simulacion de Tutorial11), asi el resultado no depende del frame rate. BendParams da la
+    // forma del bend (la posicion, la velocidad y el radio salen de cada cuerpo de Interactors).
+    // Si pThreadPool no es null, los tufts activos se reparten en tareas entre sus NumPoolThreads hilos
+    void Step(const GrassField&      Field,
+              GrassBendKernel        Kernel,
+              const GrassBendParams& BendParams,
+              GrassInteractorGrid&   Interactors,
+              float                  TimeStep,
+              IThreadPool*           pThreadPool,
+              Uint32                 NumPoolThreads);
+
+    // #Olvida el estado de los tufts [FirstTuft, FirstTuft + NumTufts), por ejemplo porque su
+    // chunk se descargo y el slot se va a usar para otro. No puede correr a la vez que Step()
+    void ResetTufts(Uint32 FirstTuft, Uint32 NumTufts);
+
+    // #Bend actual de cada tuft, en el mismo orden que GrassField. 0 para los que estan en reposo
+    const float* GetBendX() const { return m_BendX.data(); }
+    const float* GetBendZ() const { return m_BendZ.data(); }
+
+    // #Reemplaza Out con el bend de los tufts activos; los demas estan en 0
+    void GetBentTufts(std::vector<BentTuft>& Out) const;
+
+    Params&      GetParams() { return m_Params; }
+    const Stats& GetStats() const { return m_Stats; }
+
+private:
+    // #Estado de un tuft activo. Los inactivos no tienen estado, solo bend 0
+    struct ActiveTuft
+    {
+        Uint32 Tuft;
+        float  AngleX, AngleZ;
+        float  VelX, VelZ;
+        float  TargetX, TargetZ; // #Ultimo bend que le dio el jugador
+        float  Timer;            // #Tiempo desde la ultima vez que fue pisado
+    };
+    static constexpr Uint32 InvalidActiveIndex = ~Uint32{0};
+
+    void Disturb(const GrassField& Field, GrassBendKernel Kernel, const GrassBendParams& BendParams, GrassInteractorGrid& Interactors);
+    void Integrate(Uint32 First, Uint32 Last, float TimeStep);
+    void RemoveRestingTufts();
+
+    Params m_Params;
+    Stats  m_Stats;
+
+    AlignedFloatVector      m_BendX;
+    AlignedFloatVector      m_BendZ;
+    std::vector<Uint32>     m_ActiveIndex; // #Indice en m_Active de cada tuft, o InvalidActiveIndex
+    std::vector<ActiveTuft> m_Active;
+
+    AlignedFloatVector m_PushX; // #Bend combinado de todos los cuerpos, un chunk a la vez
+    AlignedFloatVector m_PushZ;
+    AlignedFloatVector m_PushMax2; // #Cuadrado del mayor bend de un solo cuerpo, para limitar la suma
+    AlignedFloatVector m_BodyX;    // #Salida del kernel para una fila de tufts y un cuerpo
+    AlignedFloatVector m_BodyZ;
+    std::vector<Uint32> m_Candidates;
+
+    std::vector<RefCntAutoPtr<IAsyncTask>> m_Tasks;
+};
+
+} // namespace Diligent
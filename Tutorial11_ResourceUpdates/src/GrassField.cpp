@@ -0,0 +1,332 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "GrassField.hpp"
+#include "CpuProfiler.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// #Pedidos al hilo de carga que todavia no volvieron. Si el jugador se mueve rapido los chunks
+// viejos de la cola se cargan igual y se descargan en el siguiente UpdatePaging
+constexpr Uint32 MaxPendingRequests = 32;
+
+} // namespace
+
+GrassField::~GrassField()
+{
+    StopLoader();
+}
+
+void GrassField::StopLoader()
+{
+    if (!m_LoaderThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> Lock{m_LoaderMtx};
+        m_StopLoader = true;
+    }
+    m_LoaderCV.notify_one();
+    m_LoaderThread.join();
+}
+
+void GrassField::Initialize(const Config& Cfg)
+{
+    StopLoader();
+
+    m_Config              = Cfg;
+    m_Config.TuftsPerSide = std::max(m_Config.TuftsPerSide, 1u);
+    m_Config.ChunkSize    = std::max(m_Config.ChunkSize, 1u);
+
+    m_ChunksPerSide = (m_Config.TuftsPerSide + m_Config.ChunkSize - 1) / m_Config.ChunkSize;
+    m_SlotTufts     = m_Config.ChunkSize * m_Config.ChunkSize;
+    m_HalfSize      = m_Config.Spacing * (m_Config.TuftsPerSide - 1) * 0.5f;
+
+    const Uint32 TotalChunks  = m_ChunksPerSide * m_ChunksPerSide;
+    const Uint64 BytesPerTuft = 2 * sizeof(float) + m_Config.ExtraBytesPerTuft;
+    const Uint64 BudgetBytes  = Uint64{m_Config.MemoryBudgetMB} << 20;
+    const Uint32 MaxResident  = static_cast<Uint32>(std::max<Uint64>(std::min<Uint64>(BudgetBytes / (m_SlotTufts * BytesPerTuft), TotalChunks), 1));
+
+    m_TuftX.assign(size_t{MaxResident} * m_SlotTufts, 0.f);
+    m_TuftZ.assign(size_t{MaxResident} * m_SlotTufts, 0.f);
+
+    m_Chunks.clear();
+    m_Chunks.reserve(MaxResident);
+    m_ChunkSlots.clear();
+    m_Evicted.clear();
+    m_FreeSlots.resize(MaxResident);
+    for (Uint32 s = 0; s < MaxResident; ++s)
+        m_FreeSlots[s] = MaxResident - 1 - s; // #Se usan desde el final, asi el slot 0 es el primero
+
+    m_Stats                   = {};
+    m_Stats.TotalChunks       = TotalChunks;
+    m_Stats.TotalTufts        = Uint64{m_Config.TuftsPerSide} * m_Config.TuftsPerSide;
+    m_Stats.MaxResidentChunks = MaxResident;
+    m_Stats.BudgetBytes       = BudgetBytes;
+
+    m_Requests.clear();
+    m_Loaded.clear();
+    m_NumPending   = 0;
+    m_StopLoader   = false;
+    m_LoaderThread = std::thread{&GrassField::LoaderThreadFunc, this};
+}
+
+void GrassField::LoaderThreadFunc()
+{
+    CpuProfiler::SetThreadName("Chunk loader");
+
+    for (;;)
+    {
+        LoadRequest Request;
+        {
+            std::unique_lock<std::mutex> Lock{m_LoaderMtx};
+            m_LoaderCV.wait(Lock, [this]() { return m_StopLoader || !m_Requests.empty(); });
+            if (m_StopLoader)
+                return;
+            Request = m_Requests.front();
+            m_Requests.pop_front();
+        }
+
+        Chunk NewChunk = GenerateChunk(Request);
+
+        std::lock_guard<std::mutex> Lock{m_LoaderMtx};
+        m_Loaded.push_back(NewChunk);
+    }
+}
+
+// #Llena el slot del chunk con las posiciones de sus tufts. Corre en el hilo de carga
+GrassField::Chunk GrassField::GenerateChunk(const LoadRequest& Request)
+{
+    GRASS_PROFILE_SCOPE("GrassField::GenerateChunk");
+
+    const Uint32 ChunkSize = m_Config.ChunkSize;
+    const float  Step      = m_Config.Spacing;
+    const float  Radius    = m_Config.TuftRadius;
+
+    Chunk NewChunk;
+    NewChunk.Id        = Request.ChunkZ * m_ChunksPerSide + Request.ChunkX;
+    NewChunk.FirstTuft = Request.Slot * m_SlotTufts;
+
+    const Uint32 gx0 = Request.ChunkX * ChunkSize, gx1 = std::min(gx0 + ChunkSize, m_Config.TuftsPerSide);
+    const Uint32 gz0 = Request.ChunkZ * ChunkSize, gz1 = std::min(gz0 + ChunkSize, m_Config.TuftsPerSide);
+
+    Uint32 t = NewChunk.FirstTuft;
+    for (Uint32 gz = gz0; gz < gz1; ++gz)
+    {
+        for (Uint32 gx = gx0; gx < gx1; ++gx, ++t)
+        {
+            m_TuftX[t] = -m_HalfSize + gx * Step;
+            m_TuftZ[t] = -m_HalfSize + gz * Step;
+        }
+    }
+    NewChunk.NumTufts    = t - NewChunk.FirstTuft;
+    NewChunk.TuftsPerRow = gx1 - gx0;
+
+    // #El AABB cubre las posiciones de los tufts mas lo que pueden doblarse hacia
+    // cualquier lado, incluso hacia abajo
+    NewChunk.Bounds.Min = float3{-m_HalfSize + gx0 * Step - Radius, -Radius, -m_HalfSize + gz0 * Step - Radius};
+    NewChunk.Bounds.Max = float3{-m_HalfSize + (gx1 - 1) * Step + Radius, Radius, -m_HalfSize + (gz1 - 1) * Step + Radius};
+
+    return NewChunk;
+}
+
+void GrassField::AddLoadedChunks()
+{
+    std::vector<Chunk> Loaded;
+    {
+        std::lock_guard<std::mutex> Lock{m_LoaderMtx};
+        std::swap(Loaded, m_Loaded);
+    }
+
+    for (const auto& NewChunk : Loaded)
+        m_Chunks.push_back(NewChunk);
+    m_NumPending -= static_cast<Uint32>(Loaded.size());
+    m_Stats.Loaded += static_cast<Uint32>(Loaded.size());
+}
+
+// #Distancia en XZ desde (X, Z) al rectangulo que ocupan los tufts del chunk
+float GrassField::DistanceToChunk(Uint32 ChunkX, Uint32 ChunkZ, float X, float Z) const
+{
+    const Uint32 ChunkSize = m_Config.ChunkSize;
+    const float  Step      = m_Config.Spacing;
+
+    const float MinX = -m_HalfSize + ChunkX * ChunkSize * Step;
+    const float MinZ = -m_HalfSize + ChunkZ * ChunkSize * Step;
+    const float MaxX = -m_HalfSize + (std::min((ChunkX + 1) * ChunkSize, m_Config.TuftsPerSide) - 1) * Step;
+    const float MaxZ = -m_HalfSize + (std::min((ChunkZ + 1) * ChunkSize, m_Config.TuftsPerSide) - 1) * Step;
+
+    const float dx = std::max({MinX - X, 0.f, X - MaxX});
+    const float dz = std::max({MinZ - Z, 0.f, Z - MaxZ});
+    return std::sqrt(dx * dx + dz * dz);
+}
+
+void GrassField::UpdatePaging(float PlayerX, float PlayerZ)
+{
+    GRASS_PROFILE_SCOPE("GrassField::UpdatePaging");
+
+    m_Stats.Loaded  = 0;
+    m_Stats.Evicted = 0;
+    m_Evicted.clear();
+
+    AddLoadedChunks();
+
+    const bool  PageAll     = m_Config.PageRadius <= 0;
+    const float ChunkExtent = m_Config.Spacing * m_Config.ChunkSize;
+
+    if (!PageAll)
+    {
+        // #Se descarga un chunk mas lejos de lo que se carga, asi un jugador en el borde no
+        // carga y descarga el mismo chunk todo el tiempo
+        const float EvictRadius = m_Config.PageRadius + ChunkExtent;
+        for (Uint32 i = 0; i < m_Chunks.size();)
+        {
+            const auto& CurrChunk = m_Chunks[i];
+            if (DistanceToChunk(CurrChunk.Id % m_ChunksPerSide, CurrChunk.Id / m_ChunksPerSide, PlayerX, PlayerZ) <= EvictRadius)
+            {
+                ++i;
+                continue;
+            }
+
+            m_Evicted.push_back({CurrChunk.FirstTuft, CurrChunk.NumTufts});
+            m_FreeSlots.push_back(CurrChunk.FirstTuft / m_SlotTufts);
+            m_ChunkSlots.erase(CurrChunk.Id);
+            m_Chunks[i] = m_Chunks.back();
+            m_Chunks.pop_back();
+            ++m_Stats.Evicted;
+        }
+    }
+
+    if (!m_FreeSlots.empty() && m_NumPending < MaxPendingRequests)
+    {
+        // #Rango de chunks que puede tocar el radio de carga
+        Uint32 MinX = 0, MinZ = 0, MaxX = m_ChunksPerSide - 1, MaxZ = m_ChunksPerSide - 1;
+        if (!PageAll)
+        {
+            const auto ToChunk = [&](float Coord) {
+                const float c = std::floor((Coord + m_HalfSize) / ChunkExtent);
+                return static_cast<Uint32>(clamp(c, 0.f, static_cast<float>(m_ChunksPerSide - 1)));
+            };
+            MinX = ToChunk(PlayerX - m_Config.PageRadius);
+            MaxX = ToChunk(PlayerX + m_Config.PageRadius);
+            MinZ = ToChunk(PlayerZ - m_Config.PageRadius);
+            MaxZ = ToChunk(PlayerZ + m_Config.PageRadius);
+        }
+
+        // #Los mas cercanos al jugador primero
+        std::vector<std::pair<float, Uint32>> Candidates;
+        for (Uint32 cz = MinZ; cz <= MaxZ; ++cz)
+        {
+            for (Uint32 cx = MinX; cx <= MaxX; ++cx)
+            {
+                const Uint32 Id = cz * m_ChunksPerSide + cx;
+                if (m_ChunkSlots.find(Id) != m_ChunkSlots.end())
+                    continue;
+                const float Dist = DistanceToChunk(cx, cz, PlayerX, PlayerZ);
+                if (PageAll || Dist <= m_Config.PageRadius)
+                    Candidates.emplace_back(Dist, Id);
+            }
+        }
+        std::sort(Candidates.begin(), Candidates.end());
+
+        {
+            std::lock_guard<std::mutex> Lock{m_LoaderMtx};
+            for (const auto& Candidate : Candidates)
+            {
+                if (m_FreeSlots.empty() || m_NumPending >= MaxPendingRequests)
+                    break;
+
+                const Uint32 Id   = Candidate.second;
+                const Uint32 Slot = m_FreeSlots.back();
+                m_FreeSlots.pop_back();
+                m_ChunkSlots.emplace(Id, Slot);
+                m_Requests.push_back({Id % m_ChunksPerSide, Id / m_ChunksPerSide, Slot});
+                ++m_NumPending;
+            }
+        }
+        m_LoaderCV.notify_one();
+    }
+
+    const Uint64 BytesPerTuft = 2 * sizeof(float) + m_Config.ExtraBytesPerTuft;
+    m_Stats.ResidentChunks    = static_cast<Uint32>(m_Chunks.size());
+    m_Stats.PendingChunks     = m_NumPending;
+    m_Stats.ResidentBytes     = Uint64{m_Stats.ResidentChunks} * m_SlotTufts * BytesPerTuft;
+}
+
+void GrassField::LoadAround(float PlayerX, float PlayerZ)
+{
+    for (;;)
+    {
+        UpdatePaging(PlayerX, PlayerZ);
+        if (m_NumPending == 0)
+            break;
+        while (m_NumPending > 0)
+        {
+            std::this_thread::yield();
+            AddLoadedChunks();
+        }
+    }
+    m_Stats.ResidentChunks = static_cast<Uint32>(m_Chunks.size());
+}
+
+void GrassField::Cull(const float4x4& ViewProj, bool IsGL, bool FrustumCulling, std::vector<Uint32>& VisibleChunks, CullStats& Stats) const
+{
+    VisibleChunks.clear();
+    Stats = {};
+
+    ViewFrustum Frustum;
+    ExtractViewFrustumPlanesFromMatrix(ViewProj, Frustum, IsGL);
+
+    for (Uint32 i = 0; i < m_Chunks.size(); ++i)
+    {
+        const auto& CurrChunk = m_Chunks[i];
+
+        ++Stats.ChunksTested;
+        Stats.TuftsTested += CurrChunk.NumTufts;
+
+        if (!FrustumCulling || GetBoxVisibility(Frustum, CurrChunk.Bounds) != BoxVisibility::Invisible)
+        {
+            VisibleChunks.push_back(i);
+            ++Stats.ChunksVisible;
+            Stats.TuftsVisible += CurrChunk.NumTufts;
+        }
+        else
+        {
+            ++Stats.ChunksCulled;
+            Stats.TuftsCulled += CurrChunk.NumTufts;
+        }
+    }
+}
+
+} // namespace Diligent
@@ -0,0 +1,174 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "BasicMath.hpp"
+#include "AdvancedMath.hpp"
+#include "AlignedAllocator.hpp"
+
+namespace Diligent
+{
+
+// #Campo de pasto dividido en chunks cuadrados de tamano fijo. Cada chunk guarda su AABB
+// para poder descartarlo contra el frustum antes de procesar sus tufts.
+// Los chunks se cargan (generan) en un hilo aparte dentro de un radio alrededor del jugador y
+// se descargan al salir de el. Cada chunk residente ocupa un slot fijo de los arrays por tuft,
+// asi que los indices de tuft de un chunk no cambian mientras esta cargado
+class GrassField
+{
+public:
+    // #Configuracion del campo, se puede cambiar en runtime volviendo a llamar Initialize()
+    struct Config
+    {
+        Uint32 TuftsPerSide      = 50;   // #El campo tiene TuftsPerSide x TuftsPerSide tufts, centrado en el origen
+        float  Spacing           = 1.4f; // #Distancia entre tufts (densidad = 1 / Spacing^2)
+        Uint32 ChunkSize         = 8;    // #Tufts por lado de cada chunk
+        float  TuftRadius        = 3.0f; // #Cuanto puede salirse un tuft de su posicion (hojas + bend + viento)
+        float  PageRadius        = 0;    // #Radio alrededor del jugador en el que se cargan chunks. 0 = todo el campo
+        Uint32 MemoryBudgetMB    = 64;   // #Maximo para los datos de los chunks residentes
+        Uint32 ExtraBytesPerTuft = 0;    // #Lo que otros sistemas guardan por tuft residente, cuenta para el presupuesto
+    };
+
+    struct Chunk
+    {
+        BoundBox Bounds;
+        Uint32   FirstTuft   = 0; // #Los tufts de un chunk son contiguos en GetTuftX()/GetTuftZ()
+        Uint32   NumTufts    = 0;
+        Uint32   TuftsPerRow = 0; // #Filas de tufts en X separados por Spacing, una fila por cada Z
+        Uint32   Id          = 0; // #ChunkZ * ChunksPerSide + ChunkX
+    };
+
+    struct CullStats
+    {
+        Uint32 ChunksTested  = 0;
+        Uint32 ChunksVisible = 0;
+        Uint32 ChunksCulled  = 0;
+        Uint32 TuftsTested   = 0;
+        Uint32 TuftsVisible  = 0;
+        Uint32 TuftsCulled   = 0;
+    };
+
+    struct PagingStats
+    {
+        Uint32 TotalChunks       = 0;
+        Uint64 TotalTufts        = 0;
+        Uint32 MaxResidentChunks = 0; // #Lo que entra en el presupuesto
+        Uint32 ResidentChunks    = 0;
+        Uint32 PendingChunks     = 0;
+        Uint32 Loaded            = 0; // #En el ultimo UpdatePaging
+        Uint32 Evicted           = 0;
+        Uint64 ResidentBytes     = 0;
+        Uint64 BudgetBytes       = 0;
+    };
+
+    // #Rango de tufts [FirstTuft, FirstTuft + NumTufts) de un chunk que se descargo
+    struct TuftRange
+    {
+        Uint32 FirstTuft;
+        Uint32 NumTufts;
+    };
+
+    ~GrassField();
+
+    // #Reserva los slots que entran en el presupuesto y arranca el hilo que genera los chunks.
+    // No carga ningun chunk, eso lo hace UpdatePaging()
+    void Initialize(const Config& Cfg);
+
+    // #Pide los chunks que faltan dentro de Cfg.PageRadius alrededor del jugador (los mas cercanos
+    // primero), descarga los que quedaron lejos y agrega los que el hilo ya termino de generar.
+    // Nunca espera al hilo
+    void UpdatePaging(float PlayerX, float PlayerZ);
+
+    // #Como UpdatePaging() pero espera hasta que esten cargados todos los chunks que entran en
+    // el radio y el presupuesto. Solo para el arranque
+    void LoadAround(float PlayerX, float PlayerZ);
+
+    // #Para el hilo que genera los chunks y espera a que termine. Initialize() lo vuelve a arrancar
+    void StopLoader();
+
+    // #Llena VisibleChunks con los chunks residentes que intersectan el frustum de ViewProj.
+    // Si FrustumCulling es false todos los chunks se consideran visibles
+    void Cull(const float4x4& ViewProj, bool IsGL, bool FrustumCulling, std::vector<Uint32>& VisibleChunks, CullStats& Stats) const;
+
+    // #Chunks residentes. Los indices cambian en UpdatePaging()
+    const std::vector<Chunk>&     GetChunks() const { return m_Chunks; }
+    const float*                  GetTuftX() const { return m_TuftX.data(); }
+    const float*                  GetTuftZ() const { return m_TuftZ.data(); }
+    Uint32                        GetTuftCapacity() const { return static_cast<Uint32>(m_TuftX.size()); } // #Tamano de los arrays por tuft
+    float                         GetHalfSize() const { return m_HalfSize; }
+    const Config&                 GetConfig() const { return m_Config; }
+    const PagingStats&            GetPagingStats() const { return m_Stats; }
+    const std::vector<TuftRange>& GetEvictedTufts() const { return m_Evicted; } // #Del ultimo UpdatePaging
+
+private:
+    struct LoadRequest
+    {
+        Uint32 ChunkX;
+        Uint32 ChunkZ;
+        Uint32 Slot;
+    };
+
+    void  LoaderThreadFunc();
+    Chunk GenerateChunk(const LoadRequest& Request);
+    void  AddLoadedChunks();
+    float DistanceToChunk(Uint32 ChunkX, Uint32 ChunkZ, float X, float Z) const;
+
+    Config m_Config;
+    Uint32 m_ChunksPerSide = 0;
+    Uint32 m_SlotTufts     = 0; // #ChunkSize * ChunkSize
+    float  m_HalfSize      = 0;
+
+    std::vector<Chunk> m_Chunks;
+
+    // #Posiciones x, z de cada tuft en SoA (para los kernels SIMD), un slot de m_SlotTufts por chunk
+    AlignedFloatVector m_TuftX;
+    AlignedFloatVector m_TuftZ;
+
+    std::unordered_map<Uint32, Uint32> m_ChunkSlots; // #Id de los chunks residentes o pedidos -> slot
+    std::vector<Uint32>                m_FreeSlots;
+    std::vector<TuftRange>             m_Evicted;
+    PagingStats                        m_Stats;
+
+    // #Hilo que genera chunks. Escribe solo en los slots que se le pidieron, que nadie mas lee
+    // hasta que el chunk pasa a m_Chunks
+    std::thread             m_LoaderThread;
+    std::mutex              m_LoaderMtx;
+    std::condition_variable m_LoaderCV;
+    std::deque<LoadRequest> m_Requests;
+    std::vector<Chunk>      m_Loaded;
+    Uint32                  m_NumPending = 0; // #Pedidos que todavia no volvieron a m_Chunks
+    bool                    m_StopLoader = false;
+};
+
+} // namespace Diligent
@@ -0,0 +1,401 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <tuple>
+
+#include "GrassGpuCulling.hpp"
+#include "AdvancedMath.hpp"
+#include "MapHelper.hpp"
+#include "GraphicsUtilities.h"
+#include "CpuProfiler.hpp"
+#include "GpuMemoryRegistry.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// #Planos del frustum normalizados, apuntando hacia adentro: un tuft se ve si su esfera no queda
+// entera detras de ninguno. El CPU y la GPU usan exactamente los mismos
+void ComputeCullPlanes(const GrassGpuCulling::Params& CullParams, float4 (&Planes)[6])
+{
+    ViewFrustum Frustum;
+    ExtractViewFrustumPlanesFromMatrix(CullParams.ViewProj, Frustum, CullParams.IsGL);
+
+    const Plane3D* pPlanes[] = {&Frustum.LeftPlane, &Frustum.RightPlane, &Frustum.BottomPlane,
+                                &Frustum.TopPlane, &Frustum.NearPlane, &Frustum.FarPlane};
+    for (Uint32 p = 0; p < 6; ++p)
+    {
+        const float Len = std::max(length(pPlanes[p]->Normal), 1e-6f);
+        Planes[p]       = float4{pPlanes[p]->Normal / Len, pPlanes[p]->Distance / Len};
+    }
+}
+
+// #Igual que Tutorial11_ResourceUpdates::SelectGrassLOD
+Uint32 SelectLOD(const GrassGpuCulling::Params& CullParams, Uint32 CurrLOD, float Distance)
+{
+    if (!CullParams.UseLOD)
+        return 0;
+
+    Uint32 LOD = std::min(CurrLOD, GrassGpuCulling::NumLODs - 1);
+    while (LOD < GrassGpuCulling::NumLODs - 1 && Distance > CullParams.LODDistance[LOD] + CullParams.LODHysteresis)
+        ++LOD;
+    while (LOD > 0 && Distance < CullParams.LODDistance[LOD - 1] - CullParams.LODHysteresis)
+        --LOD;
+    return LOD;
+}
+
+} // namespace
+
+void CullGrassReference(const GrassGpuCulling::Params&            CullParams,
+                        const std::vector<GrassGpuCulling::Tuft>& Tufts,
+                        const float*                              pBendX,
+                        const float*                              pBendZ,
+                        Uint32*                                   pLODState,
+                        GrassCullLists&                           Out)
+{
+    float4 Planes[6];
+    ComputeCullPlanes(CullParams, Planes);
+
+    for (auto& List : Out)
+        List.clear();
+
+    const float Radius = CullParams.TuftRadius;
+    for (Uint32 t = 0; t < Tufts.size(); ++t)
+    {
+        const auto& Tuft = Tufts[t];
+        if (Tuft.Valid == 0)
+            continue;
+
+        bool Visible = true;
+        for (Uint32 p = 0; p < 6 && Visible && CullParams.FrustumCulling; ++p)
+            Visible = Planes[p].x * Tuft.X + Planes[p].z * Tuft.Z + Planes[p].w >= -Radius;
+        if (!Visible)
+            continue;
+
+        const float  camDx = Tuft.X - CullParams.Eye.x;
+        const float  camDz = Tuft.Z - CullParams.Eye.z;
+        const float  camD  = std::sqrt(camDx * camDx + CullParams.Eye.y * CullParams.Eye.y + camDz * camDz);
+        const Uint32 LOD   = SelectLOD(CullParams, pLODState[t], camD);
+        pLODState[t]       = LOD;
+
+        float4x4 World = float4x4::RotationX(pBendX[t]) *
+            float4x4::RotationZ(pBendZ[t]) *
+            float4x4::Translation(Tuft.X, 0.f, Tuft.Z);
+        if (LOD == GrassGpuCulling::NumLODs - 1)
+            World = float4x4::RotationY(std::atan2(-camDx, -camDz)) * World;
+
+        Out[LOD].push_back({World, float4{pBendX[t], pBendZ[t], static_cast<float>(LOD), Tuft.Slice}});
+    }
+}
+
+bool GrassGpuCulling::IsSupported(IRenderDevice* pDevice)
+{
+    const auto& Features = pDevice->GetDeviceInfo().Features;
+    return Features.ComputeShaders != DEVICE_FEATURE_STATE_DISABLED &&
+        Features.IndirectRendering != DEVICE_FEATURE_STATE_DISABLED;
+}
+
+void GrassGpuCulling::Initialize(IRenderDevice* pDevice, Uint32 TuftCapacity, const LODRange (&LODs)[NumLODs], Uint32 NumFramesInFlight)
+{
+    m_pDevice      = pDevice;
+    m_TuftCapacity = std::max(TuftCapacity, 1u);
+    m_Tufts.assign(m_TuftCapacity, Tuft{});
+    m_Validation = {};
+    for (auto& Count : m_VisibleTufts)
+        Count = -1;
+
+    // #Cada LOD dibuja sus instancias desde su propia region del buffer, pero FirstInstance queda
+    // en 0: un firstInstance distinto de 0 en un draw indirecto necesita drawIndirectFirstInstance
+    // en Vulkan y base instance en GL, y sin eso todos los LOD leerian la region del LOD 0. Draw()
+    // elige la region con el offset del vertex buffer, igual que el camino instanciado de la CPU
+    for (Uint32 LOD = 0; LOD < NumLODs; ++LOD)
+    {
+        Uint32* pArgs = &m_DrawArgsTemplate[LOD * 5];
+        pArgs[0]      = LODs[LOD].NumIndices;
+        pArgs[1]      = 0;
+        pArgs[2]      = LODs[LOD].FirstIndex;
+        pArgs[3]      = 0;
+        pArgs[4]      = 0;
+    }
+
+    m_pConstants.Release();
+    CreateUniformBuffer(pDevice, sizeof(CullConstants), "Grass cull constants CB", &m_pConstants);
+    GpuMemoryRegistry::Get().Track(m_pConstants, GpuMemoryRegistry::CATEGORY_CONSTANTS);
+
+    const auto CreateBuffer = [&](const char* Name, BIND_FLAGS BindFlags, BUFFER_MODE Mode, Uint32 Stride, Uint64 Size, const void* pInitData, RefCntAutoPtr<IBuffer>& pBuffer) {
+        BufferDesc Desc;
+        Desc.Name              = Name;
+        Desc.Usage             = USAGE_DEFAULT;
+        Desc.BindFlags         = BindFlags;
+        Desc.Mode              = Mode;
+        Desc.ElementByteStride = Stride;
+        Desc.Size              = Size;
+        BufferData InitData{pInitData, Size};
+        pBuffer.Release();
+        GpuMemoryRegistry::Get().CreateBuffer(pDevice, Desc, pInitData != nullptr ? &InitData : nullptr, GpuMemoryRegistry::CATEGORY_PER_INSTANCE, &pBuffer);
+    };
+
+    const std::vector<Uint32> ZeroLODs(m_TuftCapacity, 0);
+    const std::vector<float>  ZeroBend(size_t{m_TuftCapacity} * 2, 0.f);
+    CreateBuffer("Grass cull tufts", BIND_SHADER_RESOURCE, BUFFER_MODE_STRUCTURED, sizeof(Tuft), Uint64{sizeof(Tuft)} * m_TuftCapacity, m_Tufts.data(), m_pTuftBuffer);
+    CreateBuffer("Grass cull bend", BIND_SHADER_RESOURCE, BUFFER_MODE_STRUCTURED, sizeof(float), ZeroBend.size() * sizeof(float), ZeroBend.data(), m_pBendBuffer);
+    CreateBuffer("Grass cull LOD state", BIND_UNORDERED_ACCESS, BUFFER_MODE_STRUCTURED, sizeof(Uint32), Uint64{sizeof(Uint32)} * m_TuftCapacity, ZeroLODs.data(), m_pLODBuffer);
+    // #Raw para que D3D11 deje usarlo como vertex buffer y como UAV a la vez
+    CreateBuffer("Grass culled instances", BIND_VERTEX_BUFFER | BIND_UNORDERED_ACCESS, BUFFER_MODE_RAW, 0, Uint64{sizeof(Instance)} * NumLODs * m_TuftCapacity, nullptr, m_pInstances);
+    CreateBuffer("Grass indirect draw args", BIND_INDIRECT_DRAW_ARGS | BIND_UNORDERED_ACCESS, BUFFER_MODE_RAW, 0, sizeof(m_DrawArgsTemplate), m_DrawArgsTemplate.data(), m_pDrawArgs);
+
+    // #Una copia mas que los frames en vuelo, asi la mas vieja casi siempre ya esta lista
+    m_ArgsReadback.clear();
+    m_ArgsReadback.resize(NumFramesInFlight + 1);
+    for (auto& Readback : m_ArgsReadback)
+        CreateStagingBuffer("Grass draw args readback", sizeof(m_DrawArgsTemplate), &Readback.pStaging);
+    m_NextReadback = 0;
+
+    FenceDesc FenceCI;
+    FenceCI.Name = "Grass cull readback fence";
+    m_pFence.Release();
+    pDevice->CreateFence(FenceCI, &m_pFence);
+    m_FenceValue = 0;
+
+    // #Los buffers son nuevos, el SRB viejo apunta a los anteriores
+    if (m_pPSO)
+        SetPipelineState(m_pPSO);
+}
+
+void GrassGpuCulling::CreateStagingBuffer(const char* Name, Uint64 Size, IBuffer** ppBuffer)
+{
+    BufferDesc Desc;
+    Desc.Name           = Name;
+    Desc.Usage          = USAGE_STAGING;
+    Desc.CPUAccessFlags = CPU_ACCESS_READ;
+    Desc.Size           = Size;
+    GpuMemoryRegistry::Get().CreateBuffer(m_pDevice, Desc, nullptr, GpuMemoryRegistry::CATEGORY_STAGING, ppBuffer);
+}
+
+void GrassGpuCulling::SetPipelineState(IPipelineState* pPSO)
+{
+    m_pPSO = pPSO;
+    m_pSRB.Release();
+    if (!m_pPSO || !m_pTuftBuffer)
+        return;
+
+    m_pPSO->CreateShaderResourceBinding(&m_pSRB, true);
+    m_pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "CullConstants")->Set(m_pConstants);
+    m_pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Tufts")->Set(m_pTuftBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_TuftBend")->Set(m_pBendBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_TuftLOD")->Set(m_pLODBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS));
+    m_pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Instances")->Set(m_pInstances->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS));
+    m_pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_DrawArgs")->Set(m_pDrawArgs->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS));
+}
+
+void GrassGpuCulling::UpdateTufts(IDeviceContext* pCtx, const std::vector<Tuft>& Tufts)
+{
+    VERIFY_EXPR(Tufts.size() == m_TuftCapacity);
+    m_Tufts = Tufts;
+    pCtx->UpdateBuffer(m_pTuftBuffer, 0, sizeof(Tuft) * m_Tufts.size(), m_Tufts.data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+}
+
+Uint64 GrassGpuCulling::Dispatch(IDeviceContext* pCtx, const Params& CullParams, const float* pBendX, const float* pBendZ)
+{
+    GRASS_PROFILE_SCOPE("GrassGpuCulling::Dispatch");
+
+    const Uint64 BendSize = Uint64{sizeof(float)} * m_TuftCapacity;
+    pCtx->UpdateBuffer(m_pBendBuffer, 0, BendSize, pBendX, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    pCtx->UpdateBuffer(m_pBendBuffer, BendSize, BendSize, pBendZ, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    // #Los contadores de instancias vuelven a 0; el resto de los argumentos no cambia
+    pCtx->UpdateBuffer(m_pDrawArgs, 0, sizeof(m_DrawArgsTemplate), m_DrawArgsTemplate.data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    {
+        MapHelper<CullConstants> Consts(pCtx, m_pConstants, MAP_WRITE, MAP_FLAG_DISCARD);
+        ComputeCullPlanes(CullParams, Consts->Planes);
+        Consts->Eye            = float4{CullParams.Eye, CullParams.TuftRadius};
+        Consts->LODParams      = float4{CullParams.LODDistance[0], CullParams.LODDistance[1], CullParams.LODHysteresis, CullParams.UseLOD ? 1.f : 0.f};
+        Consts->NumTufts       = m_TuftCapacity;
+        Consts->FrustumCulling = CullParams.FrustumCulling ? 1 : 0;
+    }
+
+    // #Para comparar hace falta el LOD de cada tuft antes de la pasada
+    RefCntAutoPtr<IBuffer> pLODBefore;
+    if (m_ValidationRequested)
+    {
+        CreateStagingBuffer("Grass cull LOD readback", Uint64{sizeof(Uint32)} * m_TuftCapacity, &pLODBefore);
+        pCtx->CopyBuffer(m_pLODBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, pLODBefore, 0, Uint64{sizeof(Uint32)} * m_TuftCapacity, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    }
+
+    pCtx->SetPipelineState(m_pPSO);
+    pCtx->CommitShaderResources(m_pSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    DispatchComputeAttribs DispatchAttrs;
+    DispatchAttrs.ThreadGroupCountX = (m_TuftCapacity + ThreadGroupSize - 1) / ThreadGroupSize;
+    pCtx->DispatchCompute(DispatchAttrs);
+
+    if (m_ValidationRequested)
+    {
+        RunValidation(pCtx, CullParams, pBendX, pBendZ, pLODBefore);
+        m_ValidationRequested = false;
+    }
+    ReadbackDrawArgs(pCtx);
+
+    return 2 * BendSize + sizeof(m_DrawArgsTemplate) + sizeof(CullConstants);
+}
+
+Uint32 GrassGpuCulling::Draw(IDeviceContext* pCtx, IBuffer* pVertexBuffer, IBuffer* pIndexBuffer, VALUE_TYPE IndexType)
+{
+    pCtx->SetIndexBuffer(pIndexBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    for (Uint32 LOD = 0; LOD < NumLODs; ++LOD)
+    {
+        // #El offset del buffer de instancias selecciona la lista del LOD (FirstInstance es 0)
+        IBuffer* pBuffs[]  = {pVertexBuffer, m_pInstances};
+        Uint64   Offsets[] = {0, Uint64{sizeof(Instance)} * LOD * m_TuftCapacity};
+        pCtx->SetVertexBuffers(0, _countof(pBuffs), pBuffs, Offsets, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, SET_VERTEX_BUFFERS_FLAG_RESET);
+
+        DrawIndexedIndirectAttribs DrawAttrs;
+        DrawAttrs.pAttribsBuffer                   = m_pDrawArgs;
+        DrawAttrs.DrawArgsOffset                   = LOD * DrawArgsStride;
+        DrawAttrs.IndexType                        = IndexType;
+        DrawAttrs.Flags                            = DRAW_FLAG_VERIFY_ALL;
+        DrawAttrs.AttribsBufferStateTransitionMode = RESOURCE_STATE_TRANSITION_MODE_TRANSITION;
+        pCtx->DrawIndexedIndirect(DrawAttrs);
+    }
+    return NumLODs;
+}
+
+// #Copia los argumentos del frame a un buffer de staging y lee el que la GPU ya termino. Si el
+// mas viejo todavia no esta listo se saltea la copia de este frame en vez de esperar
+void GrassGpuCulling::ReadbackDrawArgs(IDeviceContext* pCtx)
+{
+    auto& Readback = m_ArgsReadback[m_NextReadback];
+    if (Readback.FenceValue != 0)
+    {
+        if (m_pFence->GetCompletedValue() < Readback.FenceValue)
+            return;
+
+        MapHelper<Uint32> Args(pCtx, Readback.pStaging, MAP_READ, MAP_FLAG_DO_NOT_WAIT);
+        if (Args)
+        {
+            for (Uint32 LOD = 0; LOD < NumLODs; ++LOD)
+                m_VisibleTufts[LOD] = static_cast<Int32>(Args[LOD * 5 + 1]);
+        }
+    }
+
+    pCtx->CopyBuffer(m_pDrawArgs, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, Readback.pStaging, 0, sizeof(m_DrawArgsTemplate), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    pCtx->EnqueueSignal(m_pFence, ++m_FenceValue);
+    Readback.FenceValue = m_FenceValue;
+    m_NextReadback      = (m_NextReadback + 1) % static_cast<Uint32>(m_ArgsReadback.size());
+}
+
+// #Lee todo lo que escribio la pasada (esperando a la GPU) y lo compara contra CullGrassReference
+// con el mismo LOD de partida. La GPU deja las instancias de cada LOD en cualquier orden, asi
+// que las dos listas se ordenan por posicion antes de comparar
+void GrassGpuCulling::RunValidation(IDeviceContext* pCtx, const Params& CullParams, const float* pBendX, const float* pBendZ, IBuffer* pLODBefore)
+{
+    GRASS_PROFILE_SCOPE("GrassGpuCulling::Validate");
+
+    const Uint64 LODSize       = Uint64{sizeof(Uint32)} * m_TuftCapacity;
+    const Uint64 InstancesSize = Uint64{sizeof(Instance)} * NumLODs * m_TuftCapacity;
+
+    RefCntAutoPtr<IBuffer> pArgs, pInstances, pLODAfter;
+    CreateStagingBuffer("Grass cull args validation", sizeof(m_DrawArgsTemplate), &pArgs);
+    CreateStagingBuffer("Grass cull instances validation", InstancesSize, &pInstances);
+    CreateStagingBuffer("Grass cull LOD validation", LODSize, &pLODAfter);
+    pCtx->CopyBuffer(m_pDrawArgs, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, pArgs, 0, sizeof(m_DrawArgsTemplate), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    pCtx->CopyBuffer(m_pInstances, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, pInstances, 0, InstancesSize, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    pCtx->CopyBuffer(m_pLODBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, pLODAfter, 0, LODSize, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    pCtx->WaitForIdle();
+
+    std::vector<Uint32> LODState(m_TuftCapacity);
+    {
+        MapHelper<Uint32> Before(pCtx, pLODBefore, MAP_READ, MAP_FLAG_NONE);
+        memcpy(LODState.data(), Before, LODSize);
+    }
+    GrassCullLists Expected;
+    CullGrassReference(CullParams, m_Tufts, pBendX, pBendZ, LODState.data(), Expected);
+
+    m_Validation = {};
+    MapHelper<Uint32>   Args(pCtx, pArgs, MAP_READ, MAP_FLAG_NONE);
+    MapHelper<Instance> GPUInstances(pCtx, pInstances, MAP_READ, MAP_FLAG_NONE);
+    MapHelper<Uint32>   After(pCtx, pLODAfter, MAP_READ, MAP_FLAG_NONE);
+
+    const auto ByPosition = [](const Instance& a, const Instance& b) {
+        return std::tie(a.World.m[3][0], a.World.m[3][2]) < std::tie(b.World.m[3][0], b.World.m[3][2]);
+    };
+    for (Uint32 LOD = 0; LOD < NumLODs; ++LOD)
+    {
+        const Uint32 NumGPU = std::min(Args[LOD * 5 + 1], m_TuftCapacity);
+
+        const Instance*       pFirst = &GPUInstances[LOD * m_TuftCapacity];
+        std::vector<Instance> Actual(pFirst, pFirst + NumGPU);
+        auto&                 Reference = Expected[LOD];
+        std::sort(Actual.begin(), Actual.end(), ByPosition);
+        std::sort(Reference.begin(), Reference.end(), ByPosition);
+
+        m_Validation.GPUTufts[LOD] = NumGPU;
+        m_Validation.CPUTufts[LOD] = static_cast<Uint32>(Reference.size());
+
+        // #Merge de las dos listas ordenadas: lo que esta en una sola cuenta como diferencia. La
+        // fila de traslacion es la posicion del tuft tal cual, en los dos lados
+        size_t a = 0, r = 0;
+        while (a < Actual.size() || r < Reference.size())
+        {
+            if (r == Reference.size() || (a < Actual.size() && ByPosition(Actual[a], Reference[r])))
+            {
+                ++m_Validation.Mismatches;
+                ++a;
+                continue;
+            }
+            if (a == Actual.size() || ByPosition(Reference[r], Actual[a]))
+            {
+                ++m_Validation.Mismatches;
+                ++r;
+                continue;
+            }
+
+            const float* pA = Actual[a].World.Data();
+            const float* pR = Reference[r].World.Data();
+            for (Uint32 i = 0; i < 16; ++i)
+                m_Validation.MaxError = std::max(m_Validation.MaxError, std::abs(pA[i] - pR[i]));
+            for (Uint32 i = 0; i < 4; ++i)
+                m_Validation.MaxError = std::max(m_Validation.MaxError, std::abs(Actual[a].Bend[i] - Reference[r].Bend[i]));
+            ++a;
+            ++r;
+        }
+    }
+
+    for (Uint32 t = 0; t < m_TuftCapacity; ++t)
+    {
+        if (m_Tufts[t].Valid != 0 && After[t] != LODState[t])
+            ++m_Validation.Mismatches;
+    }
+    m_Validation.Done = true;
+}
+
+} // namespace Diligent
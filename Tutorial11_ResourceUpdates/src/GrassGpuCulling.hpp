@@ -0,0 +1,188 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "Buffer.h"
+#include "Fence.h"
+#include "PipelineState.h"
+#include "RefCntAutoPtr.hpp"
+#include "BasicMath.hpp"
+
+namespace Diligent
+{
+
+// #Culling del pasto en la GPU: un compute shader (grass_cull.csh) lee todos los tufts de un
+// structured buffer, los prueba contra el frustum, elige el LOD y escribe las instancias visibles
+// compactadas (una lista por LOD) junto con los argumentos de DrawIndexedIndirect. Asi el CPU
+// manda siempre la misma cantidad de comandos sin importar el tamano del campo.
+// CullGrassReference() hace exactamente lo mismo en el CPU para poder comparar resultados
+class GrassGpuCulling
+{
+public:
+    static constexpr Uint32 NumLODs         = 3;
+    static constexpr Uint32 ThreadGroupSize = 64; // #Tiene que coincidir con grass_cull.csh
+
+    // #Datos de un tuft que solo cambian cuando se carga o descarga su chunk
+    struct Tuft
+    {
+        float X     = 0;
+        float Z     = 0;
+        float Slice = 0; // #Capa del texture array
+        float Valid = 0; // #0 para los slots que no tienen un chunk cargado
+    };
+
+    // #Mismo layout que los atributos por instancia del PSO instanciado del pasto
+    struct Instance
+    {
+        float4x4 World;
+        float4   Bend; // #x = bend en X, y = bend en Z, z = LOD, w = capa del texture array
+    };
+
+    struct LODRange
+    {
+        Uint32 FirstIndex = 0;
+        Uint32 NumIndices = 0;
+    };
+
+    struct Params
+    {
+        float4x4 ViewProj;
+        float3   Eye;
+        bool     IsGL                     = false;
+        bool     FrustumCulling           = true;
+        bool     UseLOD                   = true;
+        float    LODDistance[NumLODs - 1] = {};
+        float    LODHysteresis            = 0;
+        float    TuftRadius               = 0; // #Radio de la esfera de cada tuft para el frustum
+    };
+
+    // #Resultado de comparar una pasada de la GPU contra CullGrassReference()
+    struct Validation
+    {
+        bool   Done              = false;
+        Uint32 GPUTufts[NumLODs] = {};
+        Uint32 CPUTufts[NumLODs] = {};
+        Uint32 Mismatches        = 0; // #Tufts que estan en una sola de las dos listas, o con otro LOD
+        float  MaxError          = 0; // #Maxima diferencia en las matrices y el bend de los que coinciden
+    };
+
+    // #Memoria de GPU por tuft del campo: datos, bend, LOD y una instancia por LOD
+    static constexpr Uint32 BytesPerTuft = sizeof(Tuft) + 2 * sizeof(float) + sizeof(Uint32) + NumLODs * sizeof(Instance);
+
+    static bool IsSupported(IRenderDevice* pDevice);
+
+    // #(Re)crea los buffers para TuftCapacity tufts. NumFramesInFlight es cuantos frames se
+    // espera antes de leer los contadores de instancias
+    void Initialize(IRenderDevice* pDevice, Uint32 TuftCapacity, const LODRange (&LODs)[NumLODs], Uint32 NumFramesInFlight);
+
+    // #El PSO llega del arranque asincrono; crea el SRB que apunta a los buffers
+    void SetPipelineState(IPipelineState* pPSO);
+    bool IsReady() const { return m_pSRB != nullptr; }
+
+    // #Sube los datos fijos de todos los tufts (TuftCapacity). Solo cuando cambian los chunks
+    void UpdateTufts(IDeviceContext* pCtx, const std::vector<Tuft>& Tufts);
+
+    // #Sube el bend del frame, reinicia los argumentos y lanza el compute shader. Devuelve los
+    // bytes subidos
+    Uint64 Dispatch(IDeviceContext* pCtx, const Params& CullParams, const float* pBendX, const float* pBendZ);
+
+    // #Un DrawIndexedIndirect por LOD con el PSO y el SRB del pasto instanciado ya puestos
+    Uint32 Draw(IDeviceContext* pCtx, IBuffer* pVertexBuffer, IBuffer* pIndexBuffer, VALUE_TYPE IndexType);
+
+    // #La proxima Dispatch() copia sus resultados, espera a la GPU y los compara contra el CPU
+    void              RequestValidation() { m_ValidationRequested = true; }
+    const Validation& GetValidation() const { return m_Validation; }
+
+    // #Instancias por LOD de hace unos frames (se leen sin esperar a la GPU). -1 si todavia no hay
+    Int32 GetVisibleTufts(Uint32 LOD) const { return m_VisibleTufts[LOD]; }
+
+private:
+    struct CullConstants
+    {
+        float4 Planes[6];
+        float4 Eye;       // #xyz - camara, w - radio del tuft
+        float4 LODParams; // #x, y - distancia de los LOD 1 y 2, z - histeresis, w - 1 si hay LOD
+        Uint32 NumTufts;
+        Uint32 FrustumCulling;
+        Uint32 Padding[2];
+    };
+
+    // #DrawIndexedIndirect: NumIndices, NumInstances, FirstIndex, BaseVertex, FirstInstance
+    static constexpr Uint32 DrawArgsStride = 5 * sizeof(Uint32);
+
+    void ReadbackDrawArgs(IDeviceContext* pCtx);
+    void RunValidation(IDeviceContext* pCtx, const Params& CullParams, const float* pBendX, const float* pBendZ, IBuffer* pLODBefore);
+    void CreateStagingBuffer(const char* Name, Uint64 Size, IBuffer** ppBuffer);
+
+    RefCntAutoPtr<IRenderDevice>          m_pDevice;
+    RefCntAutoPtr<IPipelineState>         m_pPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pSRB;
+
+    RefCntAutoPtr<IBuffer> m_pConstants;
+    RefCntAutoPtr<IBuffer> m_pTuftBuffer; // #Un Tuft por tuft
+    RefCntAutoPtr<IBuffer> m_pBendBuffer; // #Bend X de todos los tufts y despues bend Z
+    RefCntAutoPtr<IBuffer> m_pLODBuffer;  // #LOD actual de cada tuft, para la histeresis
+    RefCntAutoPtr<IBuffer> m_pInstances;  // #Lista del LOD L en [L * TuftCapacity, ...)
+    RefCntAutoPtr<IBuffer> m_pDrawArgs;
+
+    Uint32                          m_TuftCapacity     = 0;
+    std::array<Uint32, NumLODs * 5> m_DrawArgsTemplate = {};
+    std::vector<Tuft>               m_Tufts; // #Copia de lo subido, para la validacion
+
+    // #Ring de copias de los argumentos para leer cuantas instancias quedaron sin esperar
+    struct ArgsReadback
+    {
+        RefCntAutoPtr<IBuffer> pStaging;
+        Uint64                 FenceValue = 0;
+    };
+    std::vector<ArgsReadback> m_ArgsReadback;
+    Uint32                    m_NextReadback          = 0;
+    RefCntAutoPtr<IFence>     m_pFence;
+    Uint64                    m_FenceValue            = 0;
+    Int32                     m_VisibleTufts[NumLODs] = {-1, -1, -1};
+
+    bool       m_ValidationRequested = false;
+    Validation m_Validation;
+};
+
+// #Version de CPU de grass_cull.csh. Cada elemento de LODState es el LOD anterior del tuft y
+// sale con el nuevo. Las listas de Out quedan en orden de tuft (la GPU las deja en cualquier orden)
+using GrassCullLists = std::array<std::vector<GrassGpuCulling::Instance>, GrassGpuCulling::NumLODs>;
+void CullGrassReference(const GrassGpuCulling::Params&            CullParams,
+                        const std::vector<GrassGpuCulling::Tuft>& Tufts,
+                        const float*                              pBendX,
+                        const float*                              pBendZ,
+                        Uint32*                                   pLODState,
+                        GrassCullLists&                           Out);
+
+} // namespace Diligent
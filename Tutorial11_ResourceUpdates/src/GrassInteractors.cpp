@@ -0,0 +1,211 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+
+#include "GrassInteractors.hpp"
+#include "CpuProfiler.hpp"
+
+namespace Diligent
+{
+
+Uint32 GrassInteractorGrid::GetBucket(int CellX, int CellZ) const
+{
+    // #Hash de Teschner et al. para grillas espaciales
+    const Uint32 Hash = static_cast<Uint32>(CellX) * 73856093u ^ static_cast<Uint32>(CellZ) * 19349663u;
+    return Hash & m_BucketMask;
+}
+
+void GrassInteractorGrid::Build(const std::vector<GrassInteractor>& Interactors, float CellSize)
+{
+    GRASS_PROFILE_SCOPE("GrassInteractorGrid::Build");
+
+    m_Interactors = Interactors;
+    m_CellSize    = std::max(CellSize, 1e-3f);
+    m_InvCellSize = 1.f / m_CellSize;
+
+    // #Primero se cuentan los pares cuerpo-celda para dimensionar la tabla
+    Uint32 NumEntries = 0;
+    for (const auto& Body : m_Interactors)
+    {
+        const int CellX0 = static_cast<int>(std::floor((Body.X - Body.Radius) * m_InvCellSize));
+        const int CellX1 = static_cast<int>(std::floor((Body.X + Body.Radius) * m_InvCellSize));
+        const int CellZ0 = static_cast<int>(std::floor((Body.Z - Body.Radius) * m_InvCellSize));
+        const int CellZ1 = static_cast<int>(std::floor((Body.Z + Body.Radius) * m_InvCellSize));
+        NumEntries += static_cast<Uint32>((CellX1 - CellX0 + 1) * (CellZ1 - CellZ0 + 1));
+    }
+
+    // #Al menos dos buckets por par para que haya pocas colisiones
+    Uint32 NumBuckets = 64;
+    while (NumBuckets < 2 * NumEntries)
+        NumBuckets *= 2;
+    m_BucketMask = NumBuckets - 1;
+
+    m_BucketStart.assign(NumBuckets + 1, 0);
+    m_EntryBuckets.resize(NumEntries);
+    m_Entries.resize(NumEntries);
+
+    Uint32 e = 0;
+    for (const auto& Body : m_Interactors)
+    {
+        const int CellX0 = static_cast<int>(std::floor((Body.X - Body.Radius) * m_InvCellSize));
+        const int CellX1 = static_cast<int>(std::floor((Body.X + Body.Radius) * m_InvCellSize));
+        const int CellZ0 = static_cast<int>(std::floor((Body.Z - Body.Radius) * m_InvCellSize));
+        const int CellZ1 = static_cast<int>(std::floor((Body.Z + Body.Radius) * m_InvCellSize));
+        for (int cz = CellZ0; cz <= CellZ1; ++cz)
+        {
+            for (int cx = CellX0; cx <= CellX1; ++cx)
+            {
+                const Uint32 Bucket = GetBucket(cx, cz);
+                m_EntryBuckets[e++] = Bucket;
+                ++m_BucketStart[Bucket + 1];
+            }
+        }
+    }
+
+    m_Stats             = {};
+    m_Stats.Interactors = static_cast<Uint32>(m_Interactors.size());
+    m_Stats.Entries     = NumEntries;
+    m_Stats.Buckets     = NumBuckets;
+    for (Uint32 b = 0; b < NumBuckets; ++b)
+    {
+        if (m_BucketStart[b + 1] != 0)
+            ++m_Stats.UsedBuckets;
+        m_BucketStart[b + 1] += m_BucketStart[b];
+    }
+
+    // #Counting sort: m_EntryBuckets esta en el mismo orden en que se recorren los cuerpos
+    e = 0;
+    for (Uint32 i = 0; i < m_Stats.Interactors; ++i)
+    {
+        const auto& Body   = m_Interactors[i];
+        const int   CellX0 = static_cast<int>(std::floor((Body.X - Body.Radius) * m_InvCellSize));
+        const int   CellX1 = static_cast<int>(std::floor((Body.X + Body.Radius) * m_InvCellSize));
+        const int   CellZ0 = static_cast<int>(std::floor((Body.Z - Body.Radius) * m_InvCellSize));
+        const int   CellZ1 = static_cast<int>(std::floor((Body.Z + Body.Radius) * m_InvCellSize));
+        const Uint32 NumCells = static_cast<Uint32>((CellX1 - CellX0 + 1) * (CellZ1 - CellZ0 + 1));
+        for (Uint32 c = 0; c < NumCells; ++c, ++e)
+        {
+            // #m_BucketStart[b] queda en el final del bucket b, y despues se corre uno atras
+            m_Entries[m_BucketStart[m_EntryBuckets[e]]++] = i;
+        }
+    }
+    for (Uint32 b = NumBuckets; b > 0; --b)
+        m_BucketStart[b] = m_BucketStart[b - 1];
+    m_BucketStart[0] = 0;
+
+    m_QueryStamp.assign(m_Interactors.size(), 0);
+    m_CurrQuery = 0;
+}
+
+void GrassInteractorGrid::Query(float MinX, float MinZ, float MaxX, float MaxZ, std::vector<Uint32>& Out)
+{
+    if (m_Interactors.empty())
+        return;
+
+    ++m_CurrQuery;
+    const int CellX0 = static_cast<int>(std::floor(MinX * m_InvCellSize));
+    const int CellX1 = static_cast<int>(std::floor(MaxX * m_InvCellSize));
+    const int CellZ0 = static_cast<int>(std::floor(MinZ * m_InvCellSize));
+    const int CellZ1 = static_cast<int>(std::floor(MaxZ * m_InvCellSize));
+    for (int cz = CellZ0; cz <= CellZ1; ++cz)
+    {
+        for (int cx = CellX0; cx <= CellX1; ++cx)
+        {
+            const Uint32 Bucket = GetBucket(cx, cz);
+            for (Uint32 e = m_BucketStart[Bucket]; e < m_BucketStart[Bucket + 1]; ++e)
+            {
+                const Uint32 i = m_Entries[e];
+                if (m_QueryStamp[i] == m_CurrQuery)
+                    continue;
+                m_QueryStamp[i] = m_CurrQuery;
+
+                // #El bucket puede tener cuerpos de otras celdas: se prueba el circulo contra el rectangulo
+                const auto& Body = m_Interactors[i];
+                const float dx   = std::max({MinX - Body.X, 0.f, Body.X - MaxX});
+                const float dz   = std::max({MinZ - Body.Z, 0.f, Body.Z - MaxZ});
+                if (dx * dx + dz * dz < Body.Radius * Body.Radius)
+                    Out.push_back(i);
+            }
+        }
+    }
+}
+
+void WanderingAgents::Initialize(Uint32 Count, float HalfExtent, Uint32 Seed)
+{
+    m_HalfExtent = HalfExtent;
+    m_Gen.seed(Seed);
+
+    std::uniform_real_distribution<float> Pos{-HalfExtent, HalfExtent};
+    std::uniform_real_distribution<float> Angle{-PI_F, PI_F};
+    m_X.resize(Count);
+    m_Z.resize(Count);
+    m_Heading.resize(Count);
+    for (Uint32 a = 0; a < Count; ++a)
+    {
+        m_X[a]       = Pos(m_Gen);
+        m_Z[a]       = Pos(m_Gen);
+        m_Heading[a] = Angle(m_Gen);
+    }
+}
+
+void WanderingAgents::Step(float TimeStep)
+{
+    GRASS_PROFILE_SCOPE("WanderingAgents::Step");
+
+    const float MaxTurn = m_Params.TurnRate * TimeStep;
+    const float Dist    = m_Params.Speed * TimeStep;
+
+    std::uniform_real_distribution<float> Turn{-MaxTurn, MaxTurn};
+    for (size_t a = 0; a < m_X.size(); ++a)
+    {
+        float Heading = m_Heading[a] + Turn(m_Gen);
+
+        // #Fuera del campo giran hacia el centro todo lo que pueden
+        if (std::abs(m_X[a]) > m_HalfExtent || std::abs(m_Z[a]) > m_HalfExtent)
+        {
+            const float ToCenter = std::atan2(-m_Z[a], -m_X[a]);
+            float       Diff     = ToCenter - Heading;
+            Diff                 = std::atan2(std::sin(Diff), std::cos(Diff));
+            Heading += std::max(-MaxTurn, std::min(Diff, MaxTurn));
+        }
+
+        m_Heading[a] = Heading;
+        m_X[a] += std::cos(Heading) * Dist;
+        m_Z[a] += std::sin(Heading) * Dist;
+    }
+}
+
+void WanderingAgents::AppendInteractors(std::vector<GrassInteractor>& Out) const
+{
+    for (size_t a = 0; a < m_X.size(); ++a)
+        Out.push_back({m_X[a], m_Z[a], std::cos(m_Heading[a]), std::sin(m_Heading[a]), m_Params.Radius});
+}
+
+} // namespace Diligent
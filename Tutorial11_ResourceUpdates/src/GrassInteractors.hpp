@@ -0,0 +1,123 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+#include <random>
+#include <vector>
+
+#include "BasicMath.hpp"
+
+namespace Diligent
+{
+
+// #Un cuerpo que dobla el pasto: el jugador o un NPC
+struct GrassInteractor
+{
+    float X       = 0;
+    float Z       = 0;
+    float VelDirX = 0; // #Direccion de la velocidad, normalizada (0 si esta quieto)
+    float VelDirZ = 0;
+    float Radius  = 0;
+};
+
+// #Spatial hash sobre una grilla uniforme: cada cuerpo se inserta en todas las celdas que toca
+// su circulo y las celdas se guardan en una tabla de buckets (potencia de 2) ordenada con
+// counting sort, asi Build es O(cuerpos) y no hace allocations una vez que la tabla crecio.
+// Dos celdas pueden caer en el mismo bucket; Query filtra por distancia y no repite cuerpos
+class GrassInteractorGrid
+{
+public:
+    struct Stats
+    {
+        Uint32 Interactors = 0;
+        Uint32 Entries     = 0; // #Pares cuerpo-celda
+        Uint32 Buckets     = 0;
+        Uint32 UsedBuckets = 0;
+    };
+
+    // #Rehace la tabla con Interactors. CellSize deberia ser parecido al area que se consulta
+    void Build(const std::vector<GrassInteractor>& Interactors, float CellSize);
+
+    // #Agrega a Out los cuerpos cuyo circulo toca el rectangulo [MinX, MaxX] x [MinZ, MaxZ], sin repetir
+    void Query(float MinX, float MinZ, float MaxX, float MaxZ, std::vector<Uint32>& Out);
+
+    const GrassInteractor& Get(Uint32 Index) const { return m_Interactors[Index]; }
+    Uint32                 GetNumInteractors() const { return static_cast<Uint32>(m_Interactors.size()); }
+    const Stats&           GetStats() const { return m_Stats; }
+
+private:
+    Uint32 GetBucket(int CellX, int CellZ) const;
+
+    float  m_CellSize    = 1;
+    float  m_InvCellSize = 1;
+    Uint32 m_BucketMask  = 0;
+    Stats  m_Stats;
+
+    std::vector<GrassInteractor> m_Interactors;
+    std::vector<Uint32>          m_BucketStart; // #m_Entries[m_BucketStart[b] .. m_BucketStart[b + 1]) son los cuerpos del bucket b
+    std::vector<Uint32>          m_Entries;
+    std::vector<Uint32>          m_EntryBuckets; // #Scratch de Build: bucket de cada par cuerpo-celda
+    std::vector<Uint32>          m_QueryStamp;   // #Ultima consulta que devolvio cada cuerpo
+    Uint32                       m_CurrQuery = 0;
+};
+
+// #NPCs que deambulan por el campo: avanzan a velocidad constante y giran un poco al azar en
+// cada tick; cerca del borde vuelven hacia el centro. Con la misma semilla siempre hacen lo mismo
+class WanderingAgents
+{
+public:
+    struct Params
+    {
+        float Speed    = 1.5f; // #Unidades por segundo
+        float TurnRate = 2.5f; // #Maximo giro por segundo, en radianes
+        float Radius   = 1.5f; // #Radio en el que doblan el pasto
+    };
+
+    void Initialize(Uint32 Count, float HalfExtent, Uint32 Seed);
+    void Step(float TimeStep);
+
+    // #Agrega los NPCs a Out como cuerpos que doblan el pasto
+    void AppendInteractors(std::vector<GrassInteractor>& Out) const;
+
+    Uint32       GetCount() const { return static_cast<Uint32>(m_X.size()); }
+    const float* GetX() const { return m_X.data(); }
+    const float* GetZ() const { return m_Z.data(); }
+    Params&      GetParams() { return m_Params; }
+
+private:
+    Params       m_Params;
+    float        m_HalfExtent = 0;
+    std::mt19937 m_Gen;
+
+    std::vector<float> m_X;
+    std::vector<float> m_Z;
+    std::vector<float> m_Heading;
+};
+
+} // namespace Diligent
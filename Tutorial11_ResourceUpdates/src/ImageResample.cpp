@@ -0,0 +1,122 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "ImageResample.hpp"
+
+namespace Diligent
+{
+
+void ResampleRGBA8(const Uint8* pSrc, Uint32 SrcW, Uint32 SrcH, size_t SrcStride, Uint8* pDst, Uint32 DstW, Uint32 DstH)
+{
+    for (Uint32 y = 0; y < DstH; ++y)
+    {
+        const float  fy = std::max((y + 0.5f) * SrcH / DstH - 0.5f, 0.f);
+        const Uint32 y0 = std::min(static_cast<Uint32>(fy), SrcH - 1);
+        const Uint32 y1 = std::min(y0 + 1, SrcH - 1);
+        const float  ty = fy - y0;
+        for (Uint32 x = 0; x < DstW; ++x)
+        {
+            const float  fx = std::max((x + 0.5f) * SrcW / DstW - 0.5f, 0.f);
+            const Uint32 x0 = std::min(static_cast<Uint32>(fx), SrcW - 1);
+            const Uint32 x1 = std::min(x0 + 1, SrcW - 1);
+            const float  tx = fx - x0;
+            for (Uint32 c = 0; c < 4; ++c)
+            {
+                const float c00 = pSrc[y0 * SrcStride + x0 * 4 + c];
+                const float c10 = pSrc[y0 * SrcStride + x1 * 4 + c];
+                const float c01 = pSrc[y1 * SrcStride + x0 * 4 + c];
+                const float c11 = pSrc[y1 * SrcStride + x1 * 4 + c];
+                const float v   = (c00 * (1 - tx) + c10 * tx) * (1 - ty) + (c01 * (1 - tx) + c11 * tx) * ty;
+                pDst[(y * DstW + x) * 4 + c] = static_cast<Uint8>(v + 0.5f);
+            }
+        }
+    }
+}
+
+namespace
+{
+
+float SRGBToLinear(Uint8 c)
+{
+    static const auto Table = [] {
+        std::array<float, 256> t;
+        for (size_t i = 0; i < t.size(); ++i)
+        {
+            const float s = i / 255.f;
+            t[i]          = s <= 0.04045f ? s / 12.92f : std::pow((s + 0.055f) / 1.055f, 2.4f);
+        }
+        return t;
+    }();
+    return Table[c];
+}
+
+Uint8 LinearToSRGB(float l)
+{
+    const float s = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.f / 2.4f) - 0.055f;
+    return static_cast<Uint8>(std::min(std::max(s, 0.f), 1.f) * 255.f + 0.5f);
+}
+
+} // namespace
+
+void DownsampleRGBA8_SRGB(const Uint8* pSrc, Uint32 SrcW, Uint32 SrcH, size_t SrcStride, Uint8* pDst)
+{
+    const Uint32 DstW = std::max(SrcW / 2, 1u);
+    const Uint32 DstH = std::max(SrcH / 2, 1u);
+    for (Uint32 y = 0; y < DstH; ++y)
+    {
+        // #Si el lado es 1 se repite la misma fila/columna
+        const Uint32 y0 = std::min(y * 2, SrcH - 1);
+        const Uint32 y1 = std::min(y * 2 + 1, SrcH - 1);
+        for (Uint32 x = 0; x < DstW; ++x)
+        {
+            const Uint32 x0 = std::min(x * 2, SrcW - 1);
+            const Uint32 x1 = std::min(x * 2 + 1, SrcW - 1);
+
+            const Uint8* Texels[] = {
+                pSrc + y0 * SrcStride + x0 * 4,
+                pSrc + y0 * SrcStride + x1 * 4,
+                pSrc + y1 * SrcStride + x0 * 4,
+                pSrc + y1 * SrcStride + x1 * 4,
+            };
+            Uint8* pDstTexel = pDst + (size_t{y} * DstW + x) * 4;
+            for (Uint32 c = 0; c < 3; ++c)
+            {
+                float Sum = 0;
+                for (const auto* pTexel : Texels)
+                    Sum += SRGBToLinear(pTexel[c]);
+                pDstTexel[c] = LinearToSRGB(Sum * 0.25f);
+            }
+            pDstTexel[3] = static_cast<Uint8>((Texels[0][3] + Texels[1][3] + Texels[2][3] + Texels[3][3] + 2) / 4);
+        }
+    }
+}
+
+} // namespace Diligent
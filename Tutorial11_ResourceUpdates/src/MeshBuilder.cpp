@@ -0,0 +1,464 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <unordered_map>
+
+#include "MeshBuilder.hpp"
+#include "Errors.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// #v / Scale a snorm16; lo que queda fuera de [-Scale, Scale] se recorta
+Int16 EncodeSnorm16(float v, float Scale)
+{
+    return static_cast<Int16>(std::lround(std::min(std::max(v / Scale, -1.f), 1.f) * 32767.f));
+}
+
+Uint16 EncodeUnorm16(float v)
+{
+    return static_cast<Uint16>(std::lround(std::min(std::max(v, 0.f), 1.f) * 65535.f));
+}
+
+// #Junta los vertices identicos (posicion y UV bit a bit) y descarta los que no usa ningun indice
+void WeldVertices(std::vector<MeshVertex>& Vertices, std::vector<Uint32>& Indices, MeshBuildReport& Report)
+{
+    struct VertexKeyHash
+    {
+        size_t operator()(const std::array<Uint32, 5>& Key) const
+        {
+            size_t Hash = 0;
+            for (auto Word : Key)
+                Hash = Hash * 31 + std::hash<Uint32>{}(Word);
+            return Hash;
+        }
+    };
+
+    std::vector<bool> Used(Vertices.size(), false);
+    for (auto Index : Indices)
+        Used[Index] = true;
+
+    std::unordered_map<std::array<Uint32, 5>, Uint32, VertexKeyHash> Unique;
+    std::vector<Uint32>                                               Remap(Vertices.size(), ~0u);
+    std::vector<MeshVertex>                                           Welded;
+    for (size_t v = 0; v < Vertices.size(); ++v)
+    {
+        if (!Used[v])
+        {
+            ++Report.UnusedVertices;
+            continue;
+        }
+
+        std::array<Uint32, 5> Key;
+        static_assert(sizeof(Key) == sizeof(MeshVertex), "MeshVertex must be 5 floats");
+        memcpy(Key.data(), &Vertices[v], sizeof(Key));
+
+        const auto It = Unique.emplace(Key, static_cast<Uint32>(Welded.size()));
+        if (It.second)
+            Welded.push_back(Vertices[v]);
+        else
+            ++Report.WeldedVertices;
+        Remap[v] = It.first->second;
+    }
+
+    for (auto& Index : Indices)
+        Index = Remap[Index];
+    Vertices = std::move(Welded);
+}
+
+// #Orden de triangulos de Tom Forsyth ("Linear-Speed Vertex Cache Optimisation"): se simula una
+// cache LRU y en cada paso se emite el triangulo cuyos vertices tienen mejor puntaje. Un vertice
+// puntua mas si esta en la cache y si le quedan pocos triangulos por emitir
+void OptimizeVertexCache(Uint32* pIndices, Uint32 NumIndices, Uint32 NumVertices)
+{
+    constexpr size_t CacheSize         = 32;
+    constexpr float  CacheDecayPower   = 1.5f;
+    constexpr float  LastTriScore      = 0.75f;
+    constexpr float  ValenceBoostScale = 2.0f;
+    constexpr float  ValenceBoostPower = 0.5f;
+
+    const Uint32 NumTris = NumIndices / 3;
+
+    // #Triangulos de cada vertice
+    std::vector<Uint32> TriStart(NumVertices + 1, 0);
+    for (Uint32 i = 0; i < NumIndices; ++i)
+        ++TriStart[pIndices[i] + 1];
+    for (Uint32 v = 0; v < NumVertices; ++v)
+        TriStart[v + 1] += TriStart[v];
+    std::vector<Uint32> VertTris(NumIndices);
+    {
+        std::vector<Uint32> Fill{TriStart.begin(), TriStart.end() - 1};
+        for (Uint32 i = 0; i < NumIndices; ++i)
+            VertTris[Fill[pIndices[i]]++] = i / 3;
+    }
+
+    std::vector<Uint32> Remaining(NumVertices);
+    for (Uint32 v = 0; v < NumVertices; ++v)
+        Remaining[v] = TriStart[v + 1] - TriStart[v];
+    std::vector<int> CachePos(NumVertices, -1);
+
+    const auto VertexScore = [&](Uint32 v) {
+        if (Remaining[v] == 0)
+            return -1.f;
+        float Score = 0;
+        if (CachePos[v] >= 0)
+        {
+            Score = CachePos[v] < 3 ?
+                LastTriScore :
+                std::pow(1.f - static_cast<float>(CachePos[v] - 3) / static_cast<float>(CacheSize - 3), CacheDecayPower);
+        }
+        return Score + ValenceBoostScale * std::pow(static_cast<float>(Remaining[v]), -ValenceBoostPower);
+    };
+
+    std::vector<float> VertScore(NumVertices);
+    for (Uint32 v = 0; v < NumVertices; ++v)
+        VertScore[v] = VertexScore(v);
+
+    std::vector<float> TriScore(NumTris);
+    std::vector<bool>  Emitted(NumTris, false);
+    for (Uint32 t = 0; t < NumTris; ++t)
+        TriScore[t] = VertScore[pIndices[t * 3]] + VertScore[pIndices[t * 3 + 1]] + VertScore[pIndices[t * 3 + 2]];
+
+    std::vector<Uint32> Output;
+    Output.reserve(NumIndices);
+    std::vector<Uint32> Cache, NewCache;
+
+    Uint32 Best = NumTris;
+    for (Uint32 n = 0; n < NumTris; ++n)
+    {
+        if (Best == NumTris)
+        {
+            // #Nada de la cache tiene triangulos pendientes: el mejor de todos los que quedan
+            float BestScore = -1;
+            for (Uint32 t = 0; t < NumTris; ++t)
+            {
+                if (!Emitted[t] && TriScore[t] > BestScore)
+                {
+                    BestScore = TriScore[t];
+                    Best      = t;
+                }
+            }
+        }
+
+        const Uint32 Tri[3] = {pIndices[Best * 3], pIndices[Best * 3 + 1], pIndices[Best * 3 + 2]};
+        Output.insert(Output.end(), Tri, Tri + 3);
+        Emitted[Best] = true;
+        for (auto v : Tri)
+            --Remaining[v];
+
+        // #Los vertices del triangulo pasan al frente de la cache
+        NewCache.assign(Tri, Tri + 3);
+        for (auto v : Cache)
+        {
+            if (v != Tri[0] && v != Tri[1] && v != Tri[2])
+                NewCache.push_back(v);
+        }
+        for (size_t i = 0; i < NewCache.size(); ++i)
+            CachePos[NewCache[i]] = i < CacheSize ? static_cast<int>(i) : -1;
+        if (NewCache.size() > CacheSize)
+            NewCache.resize(CacheSize);
+        std::swap(Cache, NewCache);
+
+        // #Solo cambian los puntajes de los vertices que estaban o estan en la cache
+        for (auto v : NewCache)
+            VertScore[v] = VertexScore(v);
+        for (auto v : Cache)
+            VertScore[v] = VertexScore(v);
+
+        Best            = NumTris;
+        float BestScore = -1;
+        for (auto v : Cache)
+        {
+            for (Uint32 i = TriStart[v]; i < TriStart[v + 1]; ++i)
+            {
+                const Uint32 t = VertTris[i];
+                if (Emitted[t])
+                    continue;
+                TriScore[t] = VertScore[pIndices[t * 3]] + VertScore[pIndices[t * 3 + 1]] + VertScore[pIndices[t * 3 + 2]];
+                if (TriScore[t] > BestScore)
+                {
+                    BestScore = TriScore[t];
+                    Best      = t;
+                }
+            }
+        }
+    }
+
+    std::copy(Output.begin(), Output.end(), pIndices);
+}
+
+// #Numera los vertices en el orden en que los pide el index buffer, asi los fetch son casi lineales
+void ReorderVerticesByFirstUse(std::vector<MeshVertex>& Vertices, std::vector<Uint32>& Indices)
+{
+    std::vector<Uint32>     Remap(Vertices.size(), ~0u);
+    std::vector<MeshVertex> Reordered;
+    Reordered.reserve(Vertices.size());
+    for (auto& Index : Indices)
+    {
+        if (Remap[Index] == ~0u)
+        {
+            Remap[Index] = static_cast<Uint32>(Reordered.size());
+            Reordered.push_back(Vertices[Index]);
+        }
+        Index = Remap[Index];
+    }
+    Vertices = std::move(Reordered);
+}
+
+} // namespace
+
+Uint32 EncodeMeshVertices(const PackedMesh& Mesh, const MeshVertex* pVertices, Uint32 NumVertices, void* pDst)
+{
+    if (Mesh.Format == MESH_VERTEX_FORMAT_FLOAT32)
+    {
+        memcpy(pDst, pVertices, sizeof(MeshVertex) * NumVertices);
+        return sizeof(MeshVertex) * NumVertices;
+    }
+
+    auto* pCompact = static_cast<CompactMeshVertex*>(pDst);
+    for (Uint32 v = 0; v < NumVertices; ++v)
+    {
+        for (Uint32 c = 0; c < 3; ++c)
+            pCompact[v].Pos[c] = EncodeSnorm16(pVertices[v].Pos[c], Mesh.PosScale[c]);
+        pCompact[v].Pos[3] = 0;
+        for (Uint32 c = 0; c < 2; ++c)
+            pCompact[v].UV[c] = EncodeUnorm16(pVertices[v].UV[c]);
+    }
+    return sizeof(CompactMeshVertex) * NumVertices;
+}
+
+namespace
+{
+
+// #Escribe VertexData e IndexData en el formato de Mesh a partir de Vertices e Indices
+void QuantizeMesh(PackedMesh& Mesh)
+{
+    auto& Report = Mesh.Report;
+    if (Mesh.Format == MESH_VERTEX_FORMAT_FLOAT32)
+    {
+        Mesh.VertexStride = sizeof(MeshVertex);
+        Mesh.IndexType    = VT_UINT32;
+    }
+    else
+    {
+        Mesh.VertexStride = sizeof(CompactMeshVertex);
+        Mesh.IndexType    = Mesh.NumVertices <= 0x10000 ? VT_UINT16 : VT_UINT32;
+
+        for (Uint32 c = 0; c < 3; ++c)
+        {
+            float MaxAbs = 0;
+            for (const auto& Vert : Mesh.Vertices)
+                MaxAbs = std::max(MaxAbs, std::abs(Vert.Pos[c]));
+            Mesh.PosScale[c] = MaxAbs > 0 ? MaxAbs : 1.f;
+        }
+    }
+
+    Mesh.VertexData.resize(size_t{Mesh.VertexStride} * Mesh.NumVertices);
+    EncodeMeshVertices(Mesh, Mesh.Vertices.data(), Mesh.NumVertices, Mesh.VertexData.data());
+    Report.VertexBytes = static_cast<Uint32>(Mesh.VertexData.size());
+
+    if (Mesh.Format == MESH_VERTEX_FORMAT_COMPACT)
+    {
+        // #Decodifica lo que se acaba de escribir, igual que lo va a leer el vertex shader
+        const auto* pCompact = reinterpret_cast<const CompactMeshVertex*>(Mesh.VertexData.data());
+        for (Uint32 v = 0; v < Mesh.NumVertices; ++v)
+        {
+            for (Uint32 c = 0; c < 3; ++c)
+            {
+                const float Src = Mesh.Vertices[v].Pos[c];
+                const float Dec = std::max(pCompact[v].Pos[c] / 32767.f, -1.f) * Mesh.PosScale[c];
+                Report.MaxPosError = std::max(Report.MaxPosError, std::abs(Dec - Src));
+                Report.NumClamped += std::abs(Src) > Mesh.PosScale[c] ? 1 : 0;
+            }
+            for (Uint32 c = 0; c < 2; ++c)
+            {
+                const float Src = Mesh.Vertices[v].UV[c];
+                const float Dec = pCompact[v].UV[c] / 65535.f;
+                Report.MaxUVError = std::max(Report.MaxUVError, std::abs(Dec - Src));
+                Report.NumClamped += Src < 0.f || Src > 1.f ? 1 : 0;
+            }
+        }
+    }
+
+    if (Mesh.IndexType == VT_UINT16)
+    {
+        Mesh.IndexData.resize(sizeof(Uint16) * Mesh.NumIndices);
+        auto* pDst = reinterpret_cast<Uint16*>(Mesh.IndexData.data());
+        for (Uint32 i = 0; i < Mesh.NumIndices; ++i)
+            pDst[i] = static_cast<Uint16>(Mesh.Indices[i]);
+    }
+    else
+    {
+        Mesh.IndexData.resize(sizeof(Uint32) * Mesh.NumIndices);
+        memcpy(Mesh.IndexData.data(), Mesh.Indices.data(), Mesh.IndexData.size());
+    }
+    Report.IndexBytes = static_cast<Uint32>(Mesh.IndexData.size());
+}
+
+} // namespace
+
+float ComputeACMR(const Uint32* pIndices, Uint32 NumIndices, Uint32 CacheSize)
+{
+    if (NumIndices < 3)
+        return 0;
+
+    std::deque<Uint32> Cache;
+    Uint32             Misses = 0;
+    for (Uint32 i = 0; i < NumIndices; ++i)
+    {
+        if (std::find(Cache.begin(), Cache.end(), pIndices[i]) != Cache.end())
+            continue;
+        ++Misses;
+        Cache.push_back(pIndices[i]);
+        if (Cache.size() > CacheSize)
+            Cache.pop_front();
+    }
+    return static_cast<float>(Misses) / static_cast<float>(NumIndices / 3);
+}
+
+PackedMesh BuildMesh(const char*           Name,
+                     const MeshVertex*     pVertices,
+                     Uint32                NumVertices,
+                     const Uint32*         pIndices,
+                     Uint32                NumIndices,
+                     MESH_VERTEX_FORMAT    Format,
+                     MESH_BUILD_FLAGS      Flags,
+                     const MeshIndexRange* pRanges,
+                     Uint32                NumRanges)
+{
+    PackedMesh Mesh;
+    Mesh.Name   = Name;
+    Mesh.Format = Format;
+
+    auto& Report         = Mesh.Report;
+    Report.InputVertices = NumVertices;
+    Report.Float32Bytes  = static_cast<Uint32>(sizeof(MeshVertex) * NumVertices + sizeof(Uint32) * NumIndices);
+
+    Mesh.Vertices.assign(pVertices, pVertices + NumVertices);
+    Mesh.Indices.assign(pIndices, pIndices + NumIndices);
+
+    // #Validacion: un index buffer con triangulos incompletos o indices fuera del vertex buffer
+    // se dibuja sin errores pero pierde triangulos en silencio
+    if (NumIndices % 3 != 0)
+    {
+        LOG_ERROR_MESSAGE(Name, " mesh: ", NumIndices, " indices is not a whole number of triangles");
+        ++Report.InvalidRanges;
+    }
+    for (auto& Index : Mesh.Indices)
+    {
+        if (Index >= NumVertices)
+        {
+            ++Report.InvalidIndices;
+            Index = 0;
+        }
+    }
+    if (Report.InvalidIndices > 0)
+        LOG_ERROR_MESSAGE(Name, " mesh: ", Report.InvalidIndices, " indices reference vertices past the end of the vertex buffer (", NumVertices, " vertices)");
+
+    std::vector<MeshIndexRange> Ranges{pRanges, pRanges + NumRanges};
+    if (Ranges.empty())
+        Ranges.push_back({0, NumIndices - NumIndices % 3});
+    for (auto& Range : Ranges)
+    {
+        if (Range.NumIndices % 3 != 0 || Range.FirstIndex % 3 != 0 || Range.FirstIndex + Range.NumIndices > NumIndices)
+        {
+            LOG_ERROR_MESSAGE(Name, " mesh: index range [", Range.FirstIndex, ", ", Range.FirstIndex + Range.NumIndices,
+                              ") is not made of whole triangles inside the index buffer (", NumIndices, " indices)");
+            ++Report.InvalidRanges;
+            // #No se optimiza, pero se deja como esta para que el que lo dibuja vea lo mismo que antes
+            Range.NumIndices = 0;
+        }
+    }
+
+    // #Triangulos que ningun rango dibuja: casi siempre un NumIndices que se quedo corto
+    if (NumRanges > 0)
+    {
+        std::vector<bool> Covered(NumIndices / 3, false);
+        for (const auto& Range : Ranges)
+        {
+            // #Los rangos invalidos quedaron con NumIndices = 0 y su FirstIndex puede estar fuera del buffer
+            if (Range.NumIndices > 0)
+                std::fill_n(Covered.begin() + Range.FirstIndex / 3, Range.NumIndices / 3, true);
+        }
+        Report.UndrawnTriangles = static_cast<Uint32>(std::count(Covered.begin(), Covered.end(), false));
+        if (Report.UndrawnTriangles > 0)
+            LOG_WARNING_MESSAGE(Name, " mesh: ", Report.UndrawnTriangles, " triangles are not covered by any index range and are never drawn");
+    }
+
+    Report.ACMRBefore = ComputeACMR(Mesh.Indices.data(), NumIndices);
+
+    if (Flags & MESH_BUILD_FLAG_WELD)
+        WeldVertices(Mesh.Vertices, Mesh.Indices, Report);
+
+    if (Flags & MESH_BUILD_FLAG_OPTIMIZE_VERTEX_CACHE)
+    {
+        for (const auto& Range : Ranges)
+        {
+            if (Range.NumIndices > 0)
+                OptimizeVertexCache(&Mesh.Indices[Range.FirstIndex], Range.NumIndices, static_cast<Uint32>(Mesh.Vertices.size()));
+        }
+        ReorderVerticesByFirstUse(Mesh.Vertices, Mesh.Indices);
+    }
+
+    Report.ACMRAfter = ComputeACMR(Mesh.Indices.data(), NumIndices);
+
+    Mesh.NumVertices = static_cast<Uint32>(Mesh.Vertices.size());
+    Mesh.NumIndices  = NumIndices;
+    QuantizeMesh(Mesh);
+
+    return Mesh;
+}
+
+void GetMeshLayoutElements(MESH_VERTEX_FORMAT Format, LayoutElement& Pos, LayoutElement& UV)
+{
+    if (Format == MESH_VERTEX_FORMAT_COMPACT)
+    {
+        Pos = LayoutElement{0, 0, 4, VT_INT16, True};
+        UV  = LayoutElement{1, 0, 2, VT_UINT16, True};
+    }
+    else
+    {
+        Pos = LayoutElement{0, 0, 3, VT_FLOAT32, False};
+        UV  = LayoutElement{1, 0, 2, VT_FLOAT32, False};
+    }
+}
+
+const char* GetMeshVertexFormatName(MESH_VERTEX_FORMAT Format)
+{
+    return Format == MESH_VERTEX_FORMAT_COMPACT ? "snorm16 pos + unorm16 UV" : "float32";
+}
+
+} // namespace Diligent
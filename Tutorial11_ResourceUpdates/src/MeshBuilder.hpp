@@ -0,0 +1,155 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+#include <vector>
+
+#include "GraphicsTypes.h"
+#include "InputLayout.h"
+#include "BasicMath.hpp"
+
+namespace Diligent
+{
+
+// #Vertice tal como se escribe en el codigo (posicion y UV en float)
+struct MeshVertex
+{
+    float3 Pos;
+    float2 UV;
+};
+
+// #Formato de los vertex e index buffers de las mallas
+enum MESH_VERTEX_FORMAT : Uint8
+{
+    // #float3 + float2 (20 bytes) e indices de 32 bits
+    MESH_VERTEX_FORMAT_FLOAT32 = 0,
+
+    // #Posicion snorm16 relativa a la escala de la malla, UV unorm16 (12 bytes) e indices de 16
+    // bits si la malla tiene menos de 65536 vertices. El vertex shader multiplica la posicion por
+    // la escala (ver PackedMesh::PosScale)
+    MESH_VERTEX_FORMAT_COMPACT,
+};
+
+// #Vertice de MESH_VERTEX_FORMAT_COMPACT. No hay formatos de 3 componentes de 16 bits, asi que
+// la posicion lleva un cuarto que siempre es 0
+struct CompactMeshVertex
+{
+    Int16  Pos[4];
+    Uint16 UV[2];
+};
+static_assert(sizeof(CompactMeshVertex) == 12, "cube.vsh reads compact vertices as snorm16x4 + unorm16x2");
+
+// #Pasos opcionales de BuildMesh. La validacion y la cuantizacion se hacen siempre
+enum MESH_BUILD_FLAGS : Uint8
+{
+    MESH_BUILD_FLAG_NONE = 0,
+
+    // #Junta los vertices con la misma posicion y UV y descarta los que ningun indice usa
+    MESH_BUILD_FLAG_WELD = 1u << 0,
+
+    // #Reordena los triangulos de cada rango para aprovechar la cache de vertices transformados
+    // y despues los vertices en el orden en que se usan por primera vez
+    MESH_BUILD_FLAG_OPTIMIZE_VERTEX_CACHE = 1u << 1,
+};
+DEFINE_FLAG_ENUM_OPERATORS(MESH_BUILD_FLAGS)
+
+// #Rango de indices que se dibuja con un solo draw (por ejemplo un LOD)
+struct MeshIndexRange
+{
+    Uint32 FirstIndex = 0;
+    Uint32 NumIndices = 0;
+};
+
+// #Lo que hizo BuildMesh. Los errores de cuantizacion son la maxima diferencia por componente
+struct MeshBuildReport
+{
+    Uint32 InputVertices    = 0;
+    Uint32 WeldedVertices   = 0; // #Duplicados que se juntaron con otro
+    Uint32 UnusedVertices   = 0; // #Sin ningun indice, se descartan al soldar
+    Uint32 InvalidIndices   = 0; // #Fuera del vertex buffer; esos triangulos quedan degenerados
+    Uint32 InvalidRanges    = 0; // #Rangos que no son triangulos completos o se salen del index buffer
+    Uint32 UndrawnTriangles = 0; // #Triangulos del index buffer fuera de todos los rangos
+    float  ACMRBefore       = 0; // #Vertices transformados por triangulo con una cache FIFO de MeshACMRCacheSize
+    float  ACMRAfter        = 0;
+
+    float  MaxPosError  = 0; // #En unidades de la malla
+    float  MaxUVError   = 0;
+    Uint32 NumClamped   = 0; // #Componentes fuera de la escala (o UVs fuera de [0, 1])
+    Uint32 VertexBytes  = 0;
+    Uint32 IndexBytes   = 0;
+    Uint32 Float32Bytes = 0; // #Vertices + indices de la entrada con MESH_VERTEX_FORMAT_FLOAT32
+};
+
+// #Tamano de la cache FIFO con la que se mide el ACMR, parecido al de una GPU de escritorio
+static constexpr Uint32 MeshACMRCacheSize = 16;
+
+// #Malla lista para crear sus buffers
+struct PackedMesh
+{
+    const char*             Name         = "";
+    MESH_VERTEX_FORMAT      Format       = MESH_VERTEX_FORMAT_FLOAT32;
+    Uint32                  VertexStride = 0;
+    Uint32                  NumVertices  = 0;
+    Uint32                  NumIndices   = 0;
+    VALUE_TYPE              IndexType    = VT_UINT32;
+    float4                  PosScale{1, 1, 1, 0}; // #xyz - escala de la posicion cuantizada, 1 en float
+    std::vector<Uint8>      VertexData;
+    std::vector<Uint8>      IndexData;
+    std::vector<MeshVertex> Vertices; // #La malla ya procesada, antes de cuantizar
+    std::vector<Uint32>     Indices;
+    MeshBuildReport         Report;
+};
+
+// #Valida los indices (y los rangos de pRanges, si hay), aplica los pasos de Flags, convierte la
+// malla al formato pedido y mide el error. La escala de cada eje es el maximo valor absoluto de
+// las posiciones en ese eje. Los rangos conservan su lugar en el index buffer; sin rangos toda la
+// malla es uno. Los problemas quedan en el log y en PackedMesh::Report
+PackedMesh BuildMesh(const char*           Name,
+                     const MeshVertex*     pVertices,
+                     Uint32                NumVertices,
+                     const Uint32*         pIndices,
+                     Uint32                NumIndices,
+                     MESH_VERTEX_FORMAT    Format,
+                     MESH_BUILD_FLAGS      Flags     = MESH_BUILD_FLAG_NONE,
+                     const MeshIndexRange* pRanges   = nullptr,
+                     Uint32                NumRanges = 0);
+
+// #Vertices transformados por triangulo (average cache miss ratio) con una cache FIFO de CacheSize
+float ComputeACMR(const Uint32* pIndices, Uint32 NumIndices, Uint32 CacheSize = MeshACMRCacheSize);
+
+// #Escribe NumVertices vertices en el formato de Mesh (por ejemplo para un UpdateBuffer). Lo que
+// queda fuera de Mesh.PosScale se recorta. Devuelve los bytes escritos
+Uint32 EncodeMeshVertices(const PackedMesh& Mesh, const MeshVertex* pVertices, Uint32 NumVertices, void* pDst);
+
+// #Atributos 0 (posicion) y 1 (UV) del input layout para Format, en el buffer 0
+void GetMeshLayoutElements(MESH_VERTEX_FORMAT Format, LayoutElement& Pos, LayoutElement& UV);
+
+const char* GetMeshVertexFormatName(MESH_VERTEX_FORMAT Format);
+
+} // namespace Diligent
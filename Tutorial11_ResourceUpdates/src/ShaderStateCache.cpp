@@ -0,0 +1,140 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "ShaderStateCache.hpp"
+#include "DataBlobImpl.hpp"
+#include "GraphicsAccessories.hpp"
+
+namespace Diligent
+{
+
+std::string ShaderStateCache::GetCachePath(RENDER_DEVICE_TYPE DeviceType, bool ConvertPSOutputToGamma)
+{
+    return std::string{"Tutorial11_shaders_"} + GetRenderDeviceTypeShortString(DeviceType) + (ConvertPSOutputToGamma ? "_gamma" : "") + ".cache";
+}
+
+void ShaderStateCache::Initialize(IRenderDevice* pDevice, const std::string& Path)
+{
+    m_pDevice = pDevice;
+    m_Path    = Path;
+    m_pCache.Release();
+    m_ColdTimesMs.clear();
+    if (m_Path.empty())
+        return;
+
+    RenderStateCacheCreateInfo CacheCI;
+    CacheCI.pDevice = pDevice;
+    CreateRenderStateCache(CacheCI, &m_pCache);
+    if (!m_pCache)
+    {
+        LOG_WARNING_MESSAGE("Failed to create the render state cache. Shaders will be compiled on every run.");
+        return;
+    }
+
+    std::ifstream File{m_Path, std::ios::binary};
+    if (!File)
+        return;
+
+    const std::vector<char> Data{std::istreambuf_iterator<char>{File}, std::istreambuf_iterator<char>{}};
+    auto                    pBlob = DataBlobImpl::Create(Data.size(), Data.data());
+    if (!m_pCache->Load(pBlob, ContentVersion))
+        LOG_WARNING_MESSAGE("Shader cache ", m_Path, " is stale or corrupt and will be rebuilt");
+
+    // #Una linea por fase: "<ms> <nombre>"
+    std::ifstream TimesFile{m_Path + ".times"};
+    double        TimeMs = 0;
+    std::string   Name;
+    while (TimesFile >> TimeMs && std::getline(TimesFile >> std::ws, Name))
+        m_ColdTimesMs[Name] = TimeMs;
+}
+
+bool ShaderStateCache::CreateShader(const ShaderCreateInfo& ShaderCI, IShader** ppShader)
+{
+    if (!m_pCache)
+    {
+        m_pDevice->CreateShader(ShaderCI, ppShader);
+        return false;
+    }
+    return m_pCache->CreateShader(ShaderCI, ppShader);
+}
+
+bool ShaderStateCache::CreateGraphicsPipelineState(const GraphicsPipelineStateCreateInfo& PSOCreateInfo, IPipelineState** ppPSO)
+{
+    if (!m_pCache)
+    {
+        m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, ppPSO);
+        return false;
+    }
+    return m_pCache->CreateGraphicsPipelineState(PSOCreateInfo, ppPSO);
+}
+
+bool ShaderStateCache::CreateComputePipelineState(const ComputePipelineStateCreateInfo& PSOCreateInfo, IPipelineState** ppPSO)
+{
+    if (!m_pCache)
+    {
+        m_pDevice->CreateComputePipelineState(PSOCreateInfo, ppPSO);
+        return false;
+    }
+    return m_pCache->CreateComputePipelineState(PSOCreateInfo, ppPSO);
+}
+
+double ShaderStateCache::GetColdTimeMs(const std::string& Name) const
+{
+    auto it = m_ColdTimesMs.find(Name);
+    return it != m_ColdTimesMs.end() ? it->second : -1;
+}
+
+void ShaderStateCache::SetColdTimeMs(const std::string& Name, double TimeMs)
+{
+    m_ColdTimesMs[Name] = TimeMs;
+}
+
+bool ShaderStateCache::Save()
+{
+    if (!m_pCache)
+        return false;
+
+    RefCntAutoPtr<IDataBlob> pBlob;
+    if (!m_pCache->WriteToBlob(ContentVersion, &pBlob) || !pBlob)
+        return false;
+
+    std::ofstream File{m_Path, std::ios::binary};
+    File.write(static_cast<const char*>(pBlob->GetConstDataPtr()), static_cast<std::streamsize>(pBlob->GetSize()));
+    if (!File)
+        return false;
+
+    std::ofstream TimesFile{m_Path + ".times"};
+    for (const auto& it : m_ColdTimesMs)
+        TimesFile << it.second << ' ' << it.first << '\n';
+    return static_cast<bool>(TimesFile);
+}
+
+} // namespace Diligent
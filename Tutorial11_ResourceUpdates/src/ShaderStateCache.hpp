@@ -0,0 +1,83 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+#include "RenderDevice.h"
+#include "RenderStateCache.h"
+#include "RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+// #Cache en disco de los shaders compilados y los PSOs (IRenderStateCache del engine). En un
+// arranque en caliente los shaders y PSOs salen del archivo en vez de compilar el HLSL. La cache
+// identifica cada shader por su codigo y sus macros, pero cada backend y cada valor de
+// CONVERT_PS_OUTPUT_TO_GAMMA usa su propio archivo (ver GetCachePath) para que un archivo nunca
+// crezca con variantes que esa configuracion no va a usar.
+// Junto a la cache se guarda cuanto tardo cada fase del arranque la ultima vez que compilo todo,
+// para poder decir cuanto tiempo se ahorro
+class ShaderStateCache
+{
+public:
+    static std::string GetCachePath(RENDER_DEVICE_TYPE DeviceType, bool ConvertPSOutputToGamma);
+
+    // #Carga Path si existe. Con Path vacio, o si el engine no puede crear la cache, todo se
+    // compila como siempre
+    void Initialize(IRenderDevice* pDevice, const std::string& Path);
+
+    bool IsEnabled() const { return m_pCache != nullptr; }
+
+    // #Como los metodos de IRenderDevice; devuelven true si el objeto salio de la cache. Se pueden
+    // llamar desde varios hilos a la vez. Un PSO de la cache tiene que usar shaders de la cache
+    bool CreateShader(const ShaderCreateInfo& ShaderCI, IShader** ppShader);
+    bool CreateGraphicsPipelineState(const GraphicsPipelineStateCreateInfo& PSOCreateInfo, IPipelineState** ppPSO);
+    bool CreateComputePipelineState(const ComputePipelineStateCreateInfo& PSOCreateInfo, IPipelineState** ppPSO);
+
+    // #Tiempo de la fase Name cuando no estaba en la cache, o -1 si no se sabe
+    double GetColdTimeMs(const std::string& Name) const;
+    void   SetColdTimeMs(const std::string& Name, double TimeMs);
+
+    // #Escribe la cache y los tiempos. Solo hace falta si hubo algun fallo
+    bool Save();
+
+    const std::string& GetPath() const { return m_Path; }
+
+private:
+    // #Se sube si cambia algo que la cache no ve (por ejemplo, el layout de los PSOs)
+    static constexpr Uint32 ContentVersion = 1;
+
+    RefCntAutoPtr<IRenderDevice>            m_pDevice;
+    RefCntAutoPtr<IRenderStateCache>        m_pCache;
+    std::string                             m_Path;
+    std::unordered_map<std::string, double> m_ColdTimesMs;
+};
+
+} // namespace Diligent
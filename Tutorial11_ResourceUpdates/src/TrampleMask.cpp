@@ -0,0 +1,380 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "TrampleMask.hpp"
+#include "MapHelper.hpp"
+#include "Align.hpp"
+#include "CpuProfiler.hpp"
+#include "GpuMemoryRegistry.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// #Modulo que siempre da positivo, para los texels globales negativos
+int PositiveMod(int Value, int Modulus)
+{
+    const int Mod = Value % Modulus;
+    return Mod < 0 ? Mod + Modulus : Mod;
+}
+
+} // namespace
+
+bool TrampleMask::SupportsBufferUploads(IRenderDevice* pDevice)
+{
+    const auto Type = pDevice->GetDeviceInfo().Type;
+    return Type == RENDER_DEVICE_TYPE_D3D12 || Type == RENDER_DEVICE_TYPE_VULKAN;
+}
+
+void TrampleMask::Initialize(IRenderDevice* pDevice, const Config& Cfg)
+{
+    m_Config       = Cfg;
+    m_TilesPerSide = (m_Config.Size + m_Config.TileSize - 1) / m_Config.TileSize;
+    m_Config.Size  = m_TilesPerSide * m_Config.TileSize;
+    m_HasOrigin    = false;
+    m_Stats        = {};
+
+    m_Mask.assign(m_Config.Size * m_Config.Size, 0);
+    m_DirtyTiles.assign(m_TilesPerSide * m_TilesPerSide, 0);
+
+    // #D3D12 copia desde buffers con filas de 256 bytes y rectangulos alineados a 512
+    if (pDevice->GetDeviceInfo().Type == RENDER_DEVICE_TYPE_D3D12)
+    {
+        m_RowAlignment    = 256;
+        m_OffsetAlignment = 512;
+    }
+    else
+    {
+        m_RowAlignment    = 4;
+        m_OffsetAlignment = 16;
+    }
+
+    TextureDesc TexDesc;
+    TexDesc.Name      = "Trample mask";
+    TexDesc.Type      = RESOURCE_DIM_TEX_2D;
+    TexDesc.Width     = m_Config.Size;
+    TexDesc.Height    = m_Config.Size;
+    TexDesc.MipLevels = 1;
+    TexDesc.Format    = TEX_FORMAT_R8_UNORM;
+    TexDesc.Usage     = USAGE_DEFAULT;
+    TexDesc.BindFlags = BIND_SHADER_RESOURCE;
+
+    TextureSubResData Level0;
+    Level0.pData  = m_Mask.data();
+    Level0.Stride = m_Config.Size;
+    TextureData InitData;
+    InitData.pSubResources   = &Level0;
+    InitData.NumSubresources = 1;
+
+    m_pTexture.Release();
+    GpuMemoryRegistry::Get().CreateTexture(pDevice, TexDesc, &InitData, GpuMemoryRegistry::CATEGORY_TEXTURES, &m_pTexture);
+}
+
+Uint8& TrampleMask::Texel(int GlobalX, int GlobalZ)
+{
+    const int Size = static_cast<int>(m_Config.Size);
+    return m_Mask[PositiveMod(GlobalZ, Size) * Size + PositiveMod(GlobalX, Size)];
+}
+
+void TrampleMask::MarkDirty(int GlobalX, int GlobalZ)
+{
+    const int    Size  = static_cast<int>(m_Config.Size);
+    const Uint32 TileX = PositiveMod(GlobalX, Size) / m_Config.TileSize;
+    const Uint32 TileZ = PositiveMod(GlobalZ, Size) / m_Config.TileSize;
+    m_DirtyTiles[TileZ * m_TilesPerSide + TileX] = 1;
+}
+
+// #Solo se marcan los tiles que tenian algo pintado, borrar texels que ya estaban en 0 no sube nada
+void TrampleMask::ClearColumns(int FirstGlobalX, int NumColumns)
+{
+    for (int x = FirstGlobalX; x < FirstGlobalX + NumColumns; ++x)
+    {
+        for (int z = 0; z < static_cast<int>(m_Config.Size); ++z)
+        {
+            Uint8& Value = Texel(x, z);
+            if (Value != 0)
+            {
+                Value = 0;
+                MarkDirty(x, z);
+            }
+        }
+    }
+}
+
+void TrampleMask::ClearRows(int FirstGlobalZ, int NumRows)
+{
+    for (int z = FirstGlobalZ; z < FirstGlobalZ + NumRows; ++z)
+    {
+        for (int x = 0; x < static_cast<int>(m_Config.Size); ++x)
+        {
+            Uint8& Value = Texel(x, z);
+            if (Value != 0)
+            {
+                Value = 0;
+                MarkDirty(x, z);
+            }
+        }
+    }
+}
+
+void TrampleMask::Clear()
+{
+    std::fill(m_Mask.begin(), m_Mask.end(), Uint8{0});
+    std::fill(m_DirtyTiles.begin(), m_DirtyTiles.end(), Uint8{1});
+}
+
+void TrampleMask::Recenter(float X, float Z)
+{
+    const int Size = static_cast<int>(m_Config.Size);
+    const int NewX = static_cast<int>(std::floor(X / m_Config.TexelSize)) - Size / 2;
+    const int NewZ = static_cast<int>(std::floor(Z / m_Config.TexelSize)) - Size / 2;
+    if (!m_HasOrigin)
+    {
+        m_OriginX   = NewX;
+        m_OriginZ   = NewZ;
+        m_HasOrigin = true;
+        return;
+    }
+
+    // #Las columnas que entran por un lado usan los texels de las que salen por el otro
+    const int dX = NewX - m_OriginX;
+    if (dX > 0)
+        ClearColumns(m_OriginX + Size, std::min(dX, Size));
+    else if (dX < 0)
+        ClearColumns(NewX, std::min(-dX, Size));
+
+    const int dZ = NewZ - m_OriginZ;
+    if (dZ > 0)
+        ClearRows(m_OriginZ + Size, std::min(dZ, Size));
+    else if (dZ < 0)
+        ClearRows(NewZ, std::min(-dZ, Size));
+
+    m_OriginX = NewX;
+    m_OriginZ = NewZ;
+}
+
+void TrampleMask::PaintStroke(float X0, float Z0, float X1, float Z1)
+{
+    GRASS_PROFILE_SCOPE("TrampleMask::PaintStroke");
+
+    const float TexelSize = m_Config.TexelSize;
+    const float Radius    = m_Config.BrushRadius;
+    const int   Size      = static_cast<int>(m_Config.Size);
+
+    // #Solo los texels de la ventana que toca la capsula del segmento
+    const int MinX = std::max(static_cast<int>(std::floor((std::min(X0, X1) - Radius) / TexelSize)), m_OriginX);
+    const int MaxX = std::min(static_cast<int>(std::floor((std::max(X0, X1) + Radius) / TexelSize)), m_OriginX + Size - 1);
+    const int MinZ = std::max(static_cast<int>(std::floor((std::min(Z0, Z1) - Radius) / TexelSize)), m_OriginZ);
+    const int MaxZ = std::min(static_cast<int>(std::floor((std::max(Z0, Z1) + Radius) / TexelSize)), m_OriginZ + Size - 1);
+
+    const float SegX   = X1 - X0;
+    const float SegZ   = Z1 - Z0;
+    const float SegLen = SegX * SegX + SegZ * SegZ;
+    const float Soft   = std::max(m_Config.BrushFalloff, 1e-3f);
+
+    for (int z = MinZ; z <= MaxZ; ++z)
+    {
+        for (int x = MinX; x <= MaxX; ++x)
+        {
+            const float Px = (static_cast<float>(x) + 0.5f) * TexelSize;
+            const float Pz = (static_cast<float>(z) + 0.5f) * TexelSize;
+            const float t  = SegLen > 0 ? clamp(((Px - X0) * SegX + (Pz - Z0) * SegZ) / SegLen, 0.f, 1.f) : 0.f;
+            const float dx = Px - (X0 + t * SegX);
+            const float dz = Pz - (Z0 + t * SegZ);
+
+            const float Weight = clamp((Radius - std::sqrt(dx * dx + dz * dz)) / Soft, 0.f, 1.f);
+            const auto  Value  = static_cast<Uint8>(Weight * 255.f + 0.5f);
+
+            // #La mascara solo crece, pisar dos veces el mismo lugar no cambia nada
+            Uint8& Dst = Texel(x, z);
+            if (Value > Dst)
+            {
+                Dst = Value;
+                MarkDirty(x, z);
+            }
+        }
+    }
+}
+
+// #Recorre los tiles por filas: cada tramo de tiles sucios seguidos (hasta MaxRegionTiles) estira
+// hacia abajo el rectangulo de la fila anterior que tenga exactamente las mismas columnas, o
+// empieza uno nuevo
+void TrampleMask::BuildRegions(Uint32 MaxRegionTiles)
+{
+    m_Regions.clear();
+
+    std::vector<size_t> Open, NextOpen; // #Rectangulos que terminan en la fila anterior
+    for (Uint32 ty = 0; ty < m_TilesPerSide; ++ty)
+    {
+        NextOpen.clear();
+        for (Uint32 tx = 0; tx < m_TilesPerSide;)
+        {
+            if (m_DirtyTiles[ty * m_TilesPerSide + tx] == 0)
+            {
+                ++tx;
+                continue;
+            }
+
+            const Uint32 x0 = tx;
+            while (tx < m_TilesPerSide && m_DirtyTiles[ty * m_TilesPerSide + tx] != 0 && tx - x0 < MaxRegionTiles)
+                ++tx;
+
+            const auto It = std::find_if(Open.begin(), Open.end(), [&](size_t r) {
+                const auto& Rgn = m_Regions[r];
+                return Rgn.X0 == x0 && Rgn.X1 == tx && Rgn.Y1 - Rgn.Y0 < MaxRegionTiles;
+            });
+            if (It != Open.end())
+            {
+                m_Regions[*It].Y1 = ty + 1;
+                NextOpen.push_back(*It);
+            }
+            else
+            {
+                m_Regions.push_back({x0, ty, tx, ty + 1});
+                NextOpen.push_back(m_Regions.size() - 1);
+            }
+        }
+        std::swap(Open, NextOpen);
+    }
+}
+
+void TrampleMask::Upload(IDeviceContext* pCtx, IBuffer* pStagingBuffer, Uint32 MaxRegionSize, Uint64 MaxBytes)
+{
+    GRASS_PROFILE_SCOPE("TrampleMask::Upload");
+
+    m_Stats = {};
+    BuildRegions(std::max(MaxRegionSize / m_Config.TileSize, 1u));
+    if (m_Regions.empty())
+        return;
+
+    if (pStagingBuffer != nullptr)
+        MaxBytes = std::min(MaxBytes, pStagingBuffer->GetDesc().Size);
+
+    struct RegionUpload
+    {
+        Box    DstBox;
+        Uint64 SrcOffset;
+        Uint32 Stride;
+    };
+    std::vector<RegionUpload> Uploads;
+
+    // #Los rectangulos que no entran quedan sucios para el siguiente frame; uno mas chico que
+    // venga despues todavia puede entrar
+    Uint64 Offset = 0;
+    for (const auto& Rgn : m_Regions)
+    {
+        const Uint32 X      = Rgn.X0 * m_Config.TileSize;
+        const Uint32 Y      = Rgn.Y0 * m_Config.TileSize;
+        const Uint32 Width  = (Rgn.X1 - Rgn.X0) * m_Config.TileSize;
+        const Uint32 Height = (Rgn.Y1 - Rgn.Y0) * m_Config.TileSize;
+        const Uint32 Stride = pStagingBuffer != nullptr ? AlignUp(Width, m_RowAlignment) : Width;
+        const Uint64 Start  = pStagingBuffer != nullptr ? AlignUp(Offset, Uint64{m_OffsetAlignment}) : Offset;
+        if (Start + Uint64{Stride} * Height > MaxBytes)
+            continue;
+
+        Uploads.push_back({Box{X, X + Width, Y, Y + Height}, Start, Stride});
+        Offset = Start + Uint64{Stride} * Height;
+
+        for (Uint32 ty = Rgn.Y0; ty < Rgn.Y1; ++ty)
+            std::fill_n(m_DirtyTiles.begin() + ty * m_TilesPerSide + Rgn.X0, Rgn.X1 - Rgn.X0, Uint8{0});
+        m_Stats.Tiles += (Rgn.X1 - Rgn.X0) * (Rgn.Y1 - Rgn.Y0);
+    }
+    m_Stats.Regions      = static_cast<Uint32>(Uploads.size());
+    m_Stats.Bytes        = Offset;
+    m_Stats.PendingTiles = static_cast<Uint32>(std::count(m_DirtyTiles.begin(), m_DirtyTiles.end(), Uint8{1}));
+
+    if (pStagingBuffer != nullptr)
+    {
+        {
+            MapHelper<Uint8> Staging{pCtx, pStagingBuffer, MAP_WRITE, MAP_FLAG_DISCARD};
+            Uint8*           pDst = Staging;
+            for (const auto& Upload : Uploads)
+            {
+                const Uint32 Width = Upload.DstBox.Width();
+                for (Uint32 Row = 0; Row < Upload.DstBox.Height(); ++Row)
+                {
+                    std::memcpy(pDst + Upload.SrcOffset + Uint64{Row} * Upload.Stride,
+                                &m_Mask[(Upload.DstBox.MinY + Row) * m_Config.Size + Upload.DstBox.MinX], Width);
+                }
+            }
+        }
+        for (const auto& Upload : Uploads)
+        {
+            TextureSubResData SubRes{pStagingBuffer, Upload.SrcOffset, Upload.Stride};
+            pCtx->UpdateTexture(m_pTexture, 0, 0, Upload.DstBox, SubRes, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        }
+    }
+    else
+    {
+        for (const auto& Upload : Uploads)
+        {
+            TextureSubResData SubRes;
+            SubRes.pData  = &m_Mask[Upload.DstBox.MinY * m_Config.Size + Upload.DstBox.MinX];
+            SubRes.Stride = m_Config.Size;
+            pCtx->UpdateTexture(m_pTexture, 0, 0, Upload.DstBox, SubRes, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        }
+    }
+}
+
+bool TrampleMask::IsAreaClear(float MinX, float MinZ, float MaxX, float MaxZ) const
+{
+    if (!m_HasOrigin)
+        return true;
+
+    const int Size = static_cast<int>(m_Config.Size);
+    const int X0   = std::max(static_cast<int>(std::floor(MinX / m_Config.TexelSize)), m_OriginX);
+    const int X1   = std::min(static_cast<int>(std::floor(MaxX / m_Config.TexelSize)), m_OriginX + Size - 1);
+    const int Z0   = std::max(static_cast<int>(std::floor(MinZ / m_Config.TexelSize)), m_OriginZ);
+    const int Z1   = std::min(static_cast<int>(std::floor(MaxZ / m_Config.TexelSize)), m_OriginZ + Size - 1);
+    for (int z = Z0; z <= Z1; ++z)
+    {
+        const Uint8* Row = &m_Mask[PositiveMod(z, Size) * Size];
+        for (int x = X0; x <= X1; ++x)
+        {
+            if (Row[PositiveMod(x, Size)] != 0)
+                return false;
+        }
+    }
+    return true;
+}
+
+float4 TrampleMask::GetShaderParams(float Strength) const
+{
+    const float HalfSize = static_cast<float>(m_Config.Size / 2);
+    const float Window   = static_cast<float>(m_Config.Size) * m_Config.TexelSize;
+    return float4{(static_cast<float>(m_OriginX) + HalfSize) * m_Config.TexelSize,
+                  (static_cast<float>(m_OriginZ) + HalfSize) * m_Config.TexelSize,
+                  1.f / Window, Strength};
+}
+
+} // namespace Diligent
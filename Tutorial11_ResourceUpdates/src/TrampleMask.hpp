@@ -0,0 +1,125 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "RefCntAutoPtr.hpp"
+#include "BasicMath.hpp"
+
+namespace Diligent
+{
+
+// #Mascara de pisadas: el camino del jugador se pinta en una copia en CPU de una textura R8 que
+// cubre una ventana cuadrada alrededor de el. La ventana es toroidal (la textura se muestrea con
+// wrap), asi que cuando el jugador se mueve solo se borran las filas y columnas que entran.
+// Lo que cambia se marca por tiles; en cada frame los tiles sucios se juntan en la menor cantidad
+// de rectangulos posible y se suben todos juntos, con un limite de bytes por frame
+class TrampleMask
+{
+public:
+    struct Config
+    {
+        Uint32 Size         = 512;   // #Texels por lado de la textura
+        float  TexelSize    = 0.25f; // #Unidades de mundo por texel: la ventana mide Size * TexelSize
+        Uint32 TileSize     = 16;    // #Texels por lado de cada tile sucio
+        float  BrushRadius  = 1.2f;  // #Radio de la pisada
+        float  BrushFalloff = 0.5f;  // #Borde suave de la pisada
+    };
+
+    struct UploadStats
+    {
+        Uint32 Regions      = 0; // #Rectangulos subidos en el ultimo Upload
+        Uint64 Bytes        = 0; // #Incluido el padding de las filas
+        Uint32 Tiles        = 0; // #Tiles que cubren esos rectangulos
+        Uint32 PendingTiles = 0; // #Sucios que no entraron en el limite y quedan para el siguiente frame
+    };
+
+    void Initialize(IRenderDevice* pDevice, const Config& Cfg);
+
+    // #Mueve la ventana para que quede centrada en (X, Z) y borra lo que sale de ella
+    void Recenter(float X, float Z);
+
+    // #Pinta una pisada a lo largo del segmento (X0, Z0) - (X1, Z1)
+    void PaintStroke(float X0, float Z0, float X1, float Z1);
+
+    // #true si ningun texel del rectangulo [MinX, MaxX] x [MinZ, MaxZ] esta pisado. Lo que queda
+    // fuera de la ventana se considera sin pisar
+    bool IsAreaClear(float MinX, float MinZ, float MaxX, float MaxZ) const;
+
+    // #Borra toda la mascara
+    void Clear();
+
+    // #Sube los tiles sucios. Con pStagingBuffer (un buffer USAGE_DYNAMIC) todos los rectangulos
+    // se copian a el con un solo Map y la textura se actualiza desde ahi; si es null, cada
+    // rectangulo se pasa directo desde la copia en CPU. Ningun rectangulo mide mas de
+    // MaxRegionSize texels por lado y no se suben mas de MaxBytes por frame
+    void Upload(IDeviceContext* pCtx, IBuffer* pStagingBuffer, Uint32 MaxRegionSize, Uint64 MaxBytes);
+
+    // #Para el shader: xy - centro de la ventana, z - 1 / tamano de la ventana, w - Strength
+    float4 GetShaderParams(float Strength) const;
+
+    ITexture*          GetTexture() const { return m_pTexture; }
+    const Config&      GetConfig() const { return m_Config; }
+    const UploadStats& GetStats() const { return m_Stats; }
+
+    // #Los buffers de D3D12 y Vulkan se pueden usar como origen de UpdateTexture
+    static bool SupportsBufferUploads(IRenderDevice* pDevice);
+
+private:
+    // #Rectangulo en tiles, [X0, X1) x [Y0, Y1)
+    struct Region
+    {
+        Uint32 X0, Y0, X1, Y1;
+    };
+
+    Uint8& Texel(int GlobalX, int GlobalZ);
+    void   MarkDirty(int GlobalX, int GlobalZ);
+    void   ClearColumns(int FirstGlobalX, int NumColumns);
+    void   ClearRows(int FirstGlobalZ, int NumRows);
+    void   BuildRegions(Uint32 MaxRegionTiles);
+
+    Config m_Config;
+    Uint32 m_TilesPerSide = 0;
+    int    m_OriginX      = 0; // #Texel global de la esquina de la ventana
+    int    m_OriginZ      = 0;
+    bool   m_HasOrigin    = false;
+
+    std::vector<Uint8>  m_Mask;       // #Size x Size, indexado por texel global modulo Size
+    std::vector<Uint8>  m_DirtyTiles; // #1 si el tile cambio desde el ultimo Upload
+    std::vector<Region> m_Regions;
+    UploadStats         m_Stats;
+
+    RefCntAutoPtr<ITexture> m_pTexture;
+    Uint32                  m_RowAlignment    = 1; // #Stride de cada fila en el staging buffer
+    Uint32                  m_OffsetAlignment = 4; // #Comienzo de cada rectangulo en el staging buffer
+};
+
+} // namespace Diligent
@@ -0,0 +1,114 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include <algorithm>
+
+#include "TransientConstantRing.hpp"
+#include "Align.hpp"
+#include "GpuMemoryRegistry.hpp"
+
+namespace Diligent
+{
+
+void TransientConstantRing::Initialize(IRenderDevice* pDevice, const char* Name, Uint32 Capacity)
+{
+    m_Alignment = std::max(pDevice->GetAdapterInfo().Buffer.ConstantBufferOffsetAlignment, 16u);
+    m_Capacity  = AlignUp(Capacity, m_Alignment);
+
+    BufferDesc CBDesc;
+    CBDesc.Name           = Name;
+    CBDesc.Usage          = USAGE_DYNAMIC;
+    CBDesc.BindFlags      = BIND_UNIFORM_BUFFER;
+    CBDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
+    CBDesc.Size           = m_Capacity;
+    m_pBuffer.Release();
+    GpuMemoryRegistry::Get().CreateBuffer(pDevice, CBDesc, nullptr, GpuMemoryRegistry::CATEGORY_CONSTANTS, &m_pBuffer);
+
+    m_Stats          = {};
+    m_Stats.Capacity = m_Capacity;
+    m_NeedDiscard    = true;
+}
+
+void TransientConstantRing::BeginFrame()
+{
+    if (m_FrameMaps > 0)
+    {
+        m_Stats.FrameBytes     = m_FrameBytes;
+        m_Stats.HighWaterBytes = std::max(m_Stats.HighWaterBytes, m_FrameBytes);
+        m_Stats.FrameMaps      = m_FrameMaps;
+        m_Stats.FrameDiscards  = m_FrameDiscards;
+        m_Stats.Overflows += m_FrameDiscards - 1;
+    }
+
+    m_Offset        = 0;
+    m_NeedDiscard   = true;
+    m_FrameBytes    = 0;
+    m_FrameMaps     = 0;
+    m_FrameDiscards = 0;
+}
+
+void* TransientConstantRing::Map(IDeviceContext* pCtx, Uint32 Size, Uint32& Offset)
+{
+    VERIFY(Size <= m_Capacity, "Constant block (", Size, " bytes) does not fit in the ring (", m_Capacity, " bytes)");
+
+    const Uint32 AlignedSize = AlignUp(Size, m_Alignment);
+    if (m_Offset + AlignedSize > m_Capacity)
+    {
+        // #No cabe: se renombra el buffer entero. Los draws anteriores siguen viendo la memoria
+        // vieja, porque cada DISCARD le da al buffer memoria nueva
+        m_Offset      = 0;
+        m_NeedDiscard = true;
+    }
+
+    const MAP_FLAGS MapFlags = m_NeedDiscard ? MAP_FLAG_DISCARD : MAP_FLAG_NO_OVERWRITE;
+    if (m_NeedDiscard)
+        ++m_FrameDiscards;
+    m_NeedDiscard = false;
+
+    PVoid pData = nullptr;
+    pCtx->MapBuffer(m_pBuffer, MAP_WRITE, MapFlags, pData);
+
+    Offset = m_Offset;
+    m_Offset += AlignedSize;
+    m_FrameBytes += AlignedSize;
+    ++m_FrameMaps;
+
+    return pData != nullptr ? static_cast<Uint8*>(pData) + Offset : nullptr;
+}
+
+void TransientConstantRing::Unmap(IDeviceContext* pCtx)
+{
+    pCtx->UnmapBuffer(m_pBuffer, MAP_WRITE);
+}
+
+void TransientConstantRing::ResetHighWater()
+{
+    m_Stats.HighWaterBytes = 0;
+    m_Stats.Overflows      = 0;
+}
+
+} // namespace Diligent
@@ -0,0 +1,89 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "Buffer.h"
+#include "RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+// #Constant buffer dinamico grande del que se sacan las constantes de muchos draws en un frame.
+// El primer Map() del frame usa MAP_FLAG_DISCARD y los siguientes MAP_FLAG_NO_OVERWRITE sobre
+// la parte que todavia no se uso; cada draw ve su parte con un dynamic offset
+// (IShaderResourceVariable::SetBufferOffset). El engine ya guarda la memoria de cada frame en
+// vuelo en su dynamic heap y la recicla con fences, asi que aqui no hace falta un buffer por frame.
+// Solo lo puede usar un contexto (el que hizo el DISCARD)
+class TransientConstantRing
+{
+public:
+    struct Stats
+    {
+        Uint32 Capacity       = 0;
+        Uint32 FrameBytes     = 0; // #Usado en el ultimo frame, contando lo que no cupo
+        Uint32 HighWaterBytes = 0; // #Maximo de FrameBytes: con Capacity >= esto no hay DISCARD extra
+        Uint32 FrameMaps      = 0;
+        Uint32 FrameDiscards  = 0; // #1 si todo cupo; mas si se lleno y hubo que volver a empezar
+        Uint64 Overflows      = 0; // #Total de DISCARD extra desde el ultimo ResetHighWater()
+    };
+
+    void Initialize(IRenderDevice* pDevice, const char* Name, Uint32 Capacity);
+
+    // #Antes del primer Map() de cada frame
+    void BeginFrame();
+
+    // #Reserva Size bytes (alineados a ConstantBufferOffsetAlignment) y los mapea. Offset es el
+    // dynamic offset del bloque dentro del buffer. Hay que llamar Unmap() antes de dibujar
+    void* Map(IDeviceContext* pCtx, Uint32 Size, Uint32& Offset);
+    void  Unmap(IDeviceContext* pCtx);
+
+    IBuffer* GetBuffer() const { return m_pBuffer; }
+    Uint32   GetAlignment() const { return m_Alignment; }
+    Uint32   GetCapacity() const { return m_Capacity; }
+
+    // #Stats del ultimo frame completo
+    const Stats& GetStats() const { return m_Stats; }
+    void         ResetHighWater();
+
+private:
+    RefCntAutoPtr<IBuffer> m_pBuffer;
+
+    Uint32 m_Capacity  = 0;
+    Uint32 m_Alignment = 1;
+
+    Uint32 m_Offset        = 0;
+    bool   m_NeedDiscard   = true;
+    Uint32 m_FrameBytes    = 0;
+    Uint32 m_FrameMaps     = 0;
+    Uint32 m_FrameDiscards = 0;
+    Stats  m_Stats;
+};
+
+} // namespace Diligent
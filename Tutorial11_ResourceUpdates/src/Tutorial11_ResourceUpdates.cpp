@@ -27,14 +27,30 @@
 
 #include <math.h>
 #include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <iomanip>
 
 #include "Tutorial11_ResourceUpdates.hpp"
+#include "ImageResample.hpp"
+#include "GpuMemoryRegistry.hpp"
 #include "MapHelper.hpp"
 #include "GraphicsUtilities.h"
 #include "TextureUtilities.h"
+#include "TextureLoader.h"
 #include "ColorConversion.h"
+#include "CommandLineParser.hpp"
+#include "GraphicsAccessories.hpp"
+#include "Align.hpp"
+#include "FileSystem.hpp"
 #include "imgui.h"
 
+#if VULKAN_SUPPORTED
+#    include "EngineFactoryVk.h"
+#endif
+
 namespace Diligent
 {
 
@@ -46,20 +62,15 @@ SampleBase* CreateSample()
 namespace
 {
 
-// Layout of this structure matches the one we defined in the pipeline state
-
-struct Vertex
-{
-    Diligent::float3 Pos;
-    Diligent::float2 UV;
-};
-
 constexpr float A  = 0.15f; // #Lado
 constexpr float Hc = 2.8f;  // #Altura
 constexpr float Hb = 1.6f;  // #Base
 
+// #El viento refuerza los vertices por encima de esta altura (la punta de los quads altos)
+constexpr float TallBladeMinHeight = 0.5f * (Hb + Hc);
+
 // # Vertices del pasto
-const Vertex CubeVerts[] =
+const MeshVertex CubeVerts[] =
     {
 
         {float3(-1, 0.00f, -1), float2(0, 1)}, // 0
@@ -99,11 +110,126 @@ const Vertex CubeVerts[] =
 
         {float3(0.0f, 0.35f, -1.1f), float2(1, 1)}, // 26 
         {float3(0.0f, 1.45f, -1.4f), float2(1, 0)}, // 27 
+
+        // #Tarjeta del LOD 2, se orienta hacia la camara con la matriz de mundo
+        {float3(-1.4f, 0.00f, 0.0f), float2(0, 1)}, // 28
+        {float3(+1.4f, 0.00f, 0.0f), float2(1, 1)}, // 29
+        {float3(+1.4f, Hc, 0.0f), float2(1, 0)},    // 30
+        {float3(-1.4f, Hc, 0.0f), float2(0, 0)},    // 31
+};
+
+// #Rango de indices de cada LOD en el index buffer del pasto
+const MeshIndexRange GrassLODs[] =
+    {
+        {0, 48},  // #Malla completa (antes 45, que dejaba afuera el ultimo triangulo)
+        {48, 12}, // #Solo los dos quads altos cruzados (vertices 4-11)
+        {60, 6},  // #Tarjeta (vertices 28-31)
+};
+
+// clang-format off
+// #Indices del pasto
+const Uint32 GrassIndices[] =
+{
+     4,  5,  6,   4,  6,  7,
+     8,  9, 10,   8, 10, 11,
+    12, 13, 14,  12, 14, 15,
+    16, 17, 18,  16, 18, 19,
+    20, 21,  5,   20,  5,  4,   
+    22, 23,  8,   22,  8,  9,
+    24, 25,  4,   24,  4,  8,
+    26, 27, 13,   26, 13, 17,
+
+    // #LOD 1
+     4,  5,  6,   4,  6,  7,
+     8,  9, 10,   8, 10, 11,
+
+    // #LOD 2
+    28, 29, 30,  28, 30, 31
+};
+// clang-format on
+
+// #Layout del cbuffer Constants de cube.vsh
+struct VSConstants
+{
+    float4x4 WorldViewProj;
+    float4   TuftOrigin;    // #Solo lo usa el pasto dibujado tuft por tuft, para muestrear el viento
+    float4   DrawParams;    // #x - capa del texture array (los tufts instanciados la llevan en Bend.w)
+    float4   GroundXZ;      // #Solo el piso: xy - escala y zw - traslacion de local a mundo en XZ
+    float4   GroundTrample; // #Solo el piso: parametros del trample mask, w = 0 para no usarlo
+    float4   MeshScale;     // #Piso y jugador: escala de la posicion cuantizada (ver PackedMesh::PosScale)
 };
+
+// #Layout del cbuffer GrassConstants de cube.vsh
+struct GrassConstants
+{
+    float4 Time;        // x - tiempo, y - frecuencia, z - amplitud, w - escala de tiempo
+    float4 Shape;       // x - amplitud base, y - escala de altura, z - ganancia de altura, w - bias de altura
+    float4 Vertex;      // x - fase por vertice, y - boost de las hojas altas, z - inclinacion
+    float4 Direction;   // xy - direccion del viento en XZ, zw - velocidad de scroll del ruido
+    float4 NoiseParams; // x - frecuencia del ruido, y - fuerza, z - desfase maximo
+    float4 Debug;       // x - 1 si se colorea cada tuft segun su LOD
+    float4 Trample;     // xy - centro de la ventana del trample mask, z - 1 / tamano de la ventana, w - intensidad
+    float4 MeshScale;   // xyz - escala de la posicion cuantizada de la malla del pasto
+};
+
+// #Hash de la posicion de un tuft en una grilla de 1 cm
+Uint32 HashTuftPosition(float x, float z)
+{
+    const auto ix = static_cast<Uint32>(static_cast<int>(std::floor(x * 100.f)));
+    const auto iz = static_cast<Uint32>(static_cast<int>(std::floor(z * 100.f)));
+    Uint32     h  = ix * 73856093u ^ iz * 19349663u;
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    return h;
+}
+
+// #Posiciones de los NPCs para los snapshots de la simulacion
+void CopyAgentPositions(const WanderingAgents& Agents, std::vector<float2>& Out)
+{
+    Out.resize(Agents.GetCount());
+    for (Uint32 a = 0; a < Agents.GetCount(); ++a)
+        Out[a] = float2{Agents.GetX()[a], Agents.GetZ()[a]};
+}
+
+// #Formatos que escribe tools/GrassTextureBaker
+bool IsBakedTextureFormat(TEXTURE_FORMAT Format)
+{
+    return Format == TEX_FORMAT_BC1_UNORM_SRGB || Format == TEX_FORMAT_BC3_UNORM_SRGB;
+}
+
+// #Decodifica grassN con todos sus mips. Solo usa el CPU, asi que corre en cualquier hilo. Si
+// existe grassN.dds (comprimido y con los mips ya hechos) se usa ese; si no, grassN.png
+RefCntAutoPtr<ITextureLoader> DecodeGrassTexture(Uint32 Index, bool AllowBaked = true)
+{
+    TextureLoadInfo loadInfo;
+    loadInfo.IsSRGB = true;
+
+    const auto BakedFileName = "grass" + std::to_string(Index) + ".dds";
+    if (AllowBaked && FileSystem::FileExists(BakedFileName.c_str()))
+    {
+        RefCntAutoPtr<ITextureLoader> pLoader;
+        CreateTextureLoaderFromFile(BakedFileName.c_str(), IMAGE_FILE_FORMAT_DDS, loadInfo, &pLoader);
+        if (pLoader && IsBakedTextureFormat(pLoader->GetTextureDesc().Format))
+            return pLoader;
+        LOG_WARNING_MESSAGE("Failed to load ", BakedFileName, " as a BC1 or BC3 texture. Falling back to the PNG.");
+    }
+
+    const auto                    FileName = "grass" + std::to_string(Index) + ".png";
+    RefCntAutoPtr<ITextureLoader> pLoader;
+    CreateTextureLoaderFromFile(FileName.c_str(), IMAGE_FILE_FORMAT_UNKNOWN, loadInfo, &pLoader);
+    if (!pLoader || pLoader->GetTextureDesc().Format != TEX_FORMAT_RGBA8_UNORM_SRGB)
+    {
+        LOG_ERROR_MESSAGE("Failed to load ", FileName, " as an RGBA8 image");
+        return {};
+    }
+    return pLoader;
+}
+
 } 
 
 // #Vertices del jugador
-const Vertex SimpleCubeVerts[] =
+const MeshVertex SimpleCubeVerts[] =
     {
         {float3(-0.5f, -0.5f, 0.5f), float2(0, 1)},
         {float3(0.5f, -0.5f, 0.5f), float2(1, 1)},
@@ -146,7 +272,7 @@ const Uint32 SimpleCubeIndices[] =
         20, 21, 22, 22, 23, 20};
 
 // #Piso
-const Vertex GroundPlaneVerts[] =
+const MeshVertex GroundPlaneVerts[] =
     {
         {float3(-60.f, -0.30f, -60.f), float2(0.0f, 0.0f)},
         {float3(60.f, -0.30f, -60.f), float2(1.0f, 0.0f)},
@@ -158,8 +284,16 @@ const Uint32 GroundPlaneIndices[] =
         0, 2, 1, 0, 3, 2  
 };
 
-void Tutorial11_ResourceUpdates::CreatePipelineStates()
+// #Crea los PSOs de una fase del arranque. Corre en el thread pool del arranque, asi que los
+// deja en Loads en vez de en los miembros que lee Render(); cada fase compila su propio pixel
+// shader para no esperar a las otras. Los shaders y PSOs salen de m_ShaderCache si ya estaban
+void Tutorial11_ResourceUpdates::CreatePipelineStates(Uint32 Phase, const SwapChainDesc& SCDesc, StartupLoads& Loads)
 {
+    auto&      PhaseInfo   = Loads.Phases[Phase];
+    const auto CountLookup = [&PhaseInfo](bool FromCache) {
+        ++(FromCache ? PhaseInfo.CacheHits : PhaseInfo.CacheMisses);
+    };
+
     // Pipeline state object encompasses configuration of all GPU stages
 
     GraphicsPipelineStateCreateInfo PSOCreateInfo;
@@ -175,9 +309,9 @@ void Tutorial11_ResourceUpdates::CreatePipelineStates()
     // This tutorial will render to a single render target
     PSOCreateInfo.GraphicsPipeline.NumRenderTargets             = 1;
     // Set render target format which is the format of the swap chain's color buffer
-    PSOCreateInfo.GraphicsPipeline.RTVFormats[0]                = m_pSwapChain->GetDesc().ColorBufferFormat;
+    PSOCreateInfo.GraphicsPipeline.RTVFormats[0]                = SCDesc.ColorBufferFormat;
     // Set depth buffer format which is the format of the swap chain's back buffer
-    PSOCreateInfo.GraphicsPipeline.DSVFormat                    = m_pSwapChain->GetDesc().DepthBufferFormat;
+    PSOCreateInfo.GraphicsPipeline.DSVFormat                    = SCDesc.DepthBufferFormat;
     // Primitive topology defines what kind of primitives will be rendered by this pipeline state
     PSOCreateInfo.GraphicsPipeline.PrimitiveTopology            = PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
     // Cull back faces
@@ -201,24 +335,35 @@ void Tutorial11_ResourceUpdates::CreatePipelineStates()
     // converted from linear to gamma space by the GPU. However, some platforms (e.g. Android in GLES mode,
     // or Emscripten in WebGL mode) do not support gamma-correction. In this case the application
     // has to do the conversion manually.
-    ShaderMacro Macros[] = {{"CONVERT_PS_OUTPUT_TO_GAMMA", m_ConvertPSOutputToGamma ? "1" : "0"}};
+    ShaderMacro Macros[] = {{"CONVERT_PS_OUTPUT_TO_GAMMA", m_ConvertPSOutputToGamma ? "1" : "0"}, {"GRASS_INSTANCED", "0"}, {"GRASS_WIND", "0"}};
     ShaderCI.Macros      = {Macros, _countof(Macros)};
 
     // Create a shader source stream factory to load shaders from files.
     RefCntAutoPtr<IShaderSourceInputStreamFactory> pShaderSourceFactory;
     m_pEngineFactory->CreateDefaultShaderSourceStreamFactory(nullptr, &pShaderSourceFactory);
     ShaderCI.pShaderSourceStreamFactory = pShaderSourceFactory;
-    // Create a vertex shader
-    RefCntAutoPtr<IShader> pVS;
+
+    // #Compute shader del culling del pasto (ver GrassGpuCulling). Todas sus variables son
+    // mutables porque el SRB se vuelve a crear cuando cambia el tamano del campo
+    if (Phase == STARTUP_PHASE_GRASS_CULL_PSO)
     {
-        ShaderCI.Desc.ShaderType = SHADER_TYPE_VERTEX;
+        const auto  GroupSize    = std::to_string(GrassGpuCulling::ThreadGroupSize);
+        ShaderMacro CullMacros[] = {{"THREAD_GROUP_SIZE", GroupSize.c_str()}};
+        ShaderCI.Macros          = {CullMacros, _countof(CullMacros)};
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_COMPUTE;
         ShaderCI.EntryPoint      = "main";
-        ShaderCI.Desc.Name       = "Cube VS";
-        ShaderCI.FilePath        = "cube.vsh";
-        m_pDevice->CreateShader(ShaderCI, &pVS);
-        // Create dynamic uniform buffer that will store our transformation matrix
-        // Dynamic buffers can be frequently updated by the CPU
-        CreateUniformBuffer(m_pDevice, sizeof(float4x4), "VS constants CB", &m_VSConstants);
+        ShaderCI.Desc.Name       = "Grass cull CS";
+        ShaderCI.FilePath        = "grass_cull.csh";
+        RefCntAutoPtr<IShader> pCS;
+        CountLookup(m_ShaderCache.CreateShader(ShaderCI, &pCS));
+
+        ComputePipelineStateCreateInfo CullPSOCreateInfo;
+        CullPSOCreateInfo.PSODesc.Name                               = "Grass cull PSO";
+        CullPSOCreateInfo.PSODesc.PipelineType                       = PIPELINE_TYPE_COMPUTE;
+        CullPSOCreateInfo.PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+        CullPSOCreateInfo.pCS                                        = pCS;
+        CountLookup(m_ShaderCache.CreateComputePipelineState(CullPSOCreateInfo, &Loads.pGrassCullPSO));
+        return;
     }
 
     // Create a pixel shader
@@ -228,21 +373,15 @@ void Tutorial11_ResourceUpdates::CreatePipelineStates()
         ShaderCI.EntryPoint      = "main";
         ShaderCI.Desc.Name       = "Cube PS";
         ShaderCI.FilePath        = "cube.psh";
-        m_pDevice->CreateShader(ShaderCI, &pPS);
+        CountLookup(m_ShaderCache.CreateShader(ShaderCI, &pPS));
     }
 
-    // clang-format off
     // Define vertex shader input layout
-    LayoutElement LayoutElems[] =
-    {
-        // Attribute 0 - vertex position
-        LayoutElement{0, 0, 3, VT_FLOAT32, False},
-        // Attribute 1 - texture coordinates
-        LayoutElement{1, 0, 2, VT_FLOAT32, False}
-    };
-    // clang-format on
+    // #Las tres mallas se construyen con el mismo formato (ver BuildMeshes)
+    LayoutElement LayoutElems[2];
+    // Attribute 0 - vertex position, attribute 1 - texture coordinates
+    GetMeshLayoutElements(m_GrassMesh.Format, LayoutElems[0], LayoutElems[1]);
 
-    PSOCreateInfo.pVS = pVS;
     PSOCreateInfo.pPS = pPS;
 
     PSOCreateInfo.GraphicsPipeline.InputLayout.LayoutElements = LayoutElems;
@@ -252,38 +391,169 @@ void Tutorial11_ResourceUpdates::CreatePipelineStates()
     PSOCreateInfo.PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_STATIC;
 
     // clang-format off
-    // Shader variables should typically be mutable, which means they are expected
-    // to change on a per-instance basis
-    ShaderResourceVariableDesc Vars[] = 
-    {
-        {SHADER_TYPE_PIXEL, "g_Texture", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}
-    };
-    PSOCreateInfo.PSODesc.ResourceLayout.Variables    = Vars;
-    PSOCreateInfo.PSODesc.ResourceLayout.NumVariables = _countof(Vars);
-
     // Define immutable sampler for g_Texture. Immutable samplers should be used whenever possible
     SamplerDesc SamLinearClampDesc
     {
         FILTER_TYPE_LINEAR, FILTER_TYPE_LINEAR, FILTER_TYPE_LINEAR, 
         TEXTURE_ADDRESS_CLAMP, TEXTURE_ADDRESS_CLAMP, TEXTURE_ADDRESS_CLAMP
     };
-    ImmutableSamplerDesc ImtblSamplers[] = 
+
+    // #La textura de ruido del viento se muestrea en el vertex shader y se tiene que repetir. El
+    // trample mask es una ventana toroidal alrededor del jugador, asi que tambien se repite
+    SamplerDesc SamLinearWrapDesc
+    {
+        FILTER_TYPE_LINEAR, FILTER_TYPE_LINEAR, FILTER_TYPE_LINEAR, 
+        TEXTURE_ADDRESS_WRAP, TEXTURE_ADDRESS_WRAP, TEXTURE_ADDRESS_WRAP
+    };
+    // clang-format on
+
+    // clang-format off
+    // #Input layout de los caminos instanciados (pasto y NPCs): la malla en el primer slot y una
+    // matriz de mundo con el bend por instancia en el segundo
+    LayoutElement InstLayoutElems[] =
     {
-        {SHADER_TYPE_PIXEL, "g_Texture", SamLinearClampDesc}
+        // Per-vertex data - first buffer slot, same as LayoutElems
+        LayoutElems[0],
+        LayoutElems[1],
+
+        // Per-instance data - second buffer slot
+        // Attributes 2-5 - rows of the tuft world matrix
+        LayoutElement{2, 1, 4, VT_FLOAT32, False, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+        LayoutElement{3, 1, 4, VT_FLOAT32, False, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+        LayoutElement{4, 1, 4, VT_FLOAT32, False, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+        LayoutElement{5, 1, 4, VT_FLOAT32, False, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+        // Attribute 6 - tuft bend
+        LayoutElement{6, 1, 4, VT_FLOAT32, False, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE}
     };
     // clang-format on
-    PSOCreateInfo.PSODesc.ResourceLayout.ImmutableSamplers    = ImtblSamplers;
-    PSOCreateInfo.PSODesc.ResourceLayout.NumImmutableSamplers = _countof(ImtblSamplers);
-    m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pPSO);
 
-    // Since we did not explicitly specify the type for 'Constants' variable, default
-    // type (SHADER_RESOURCE_VARIABLE_TYPE_STATIC) will be used. Static variables never
-    // change and are bound directly to the pipeline state object.
-    m_pPSO->GetStaticVariableByName(SHADER_TYPE_VERTEX, "Constants")->Set(m_VSConstants);
+    // #El trample mask se crea en Initialize() antes de cargar los PSOs; es el mismo para todos
+    auto* pTrampleMaskSRV = m_TrampleMask.GetTexture()->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
+
+    if (Phase == STARTUP_PHASE_SCENE_PSO)
+    {
+        // Create a vertex shader
+        RefCntAutoPtr<IShader> pVS;
+        {
+            ShaderCI.Desc.ShaderType = SHADER_TYPE_VERTEX;
+            ShaderCI.EntryPoint      = "main";
+            ShaderCI.Desc.Name       = "Cube VS";
+            ShaderCI.FilePath        = "cube.vsh";
+            CountLookup(m_ShaderCache.CreateShader(ShaderCI, &pVS));
+        }
+        PSOCreateInfo.pVS = pVS;
+
+        // clang-format off
+        // Shader variables should typically be mutable, which means they are expected
+        // to change on a per-instance basis
+        ShaderResourceVariableDesc Vars[] = 
+        {
+            {SHADER_TYPE_PIXEL,  "g_Texture", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+            // #Mutable para poder darle un dynamic offset distinto en cada draw
+            {SHADER_TYPE_VERTEX, "Constants", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}
+        };
+        PSOCreateInfo.PSODesc.ResourceLayout.Variables    = Vars;
+        PSOCreateInfo.PSODesc.ResourceLayout.NumVariables = _countof(Vars);
+
+        ImmutableSamplerDesc ImtblSamplers[] = 
+        {
+            {SHADER_TYPE_PIXEL, "g_Texture",      SamLinearClampDesc},
+            {SHADER_TYPE_PIXEL, "g_TrampleMask",  SamLinearWrapDesc}
+        };
+        // clang-format on
+        PSOCreateInfo.PSODesc.ResourceLayout.ImmutableSamplers    = ImtblSamplers;
+        PSOCreateInfo.PSODesc.ResourceLayout.NumImmutableSamplers = _countof(ImtblSamplers);
+        CountLookup(m_ShaderCache.CreateGraphicsPipelineState(PSOCreateInfo, &Loads.pPSO));
+
+        // #Solo cambia CullMode, asi que con la cache los dos PSOs comparten los shaders compilados
+        PSOCreateInfo.PSODesc.Name                             = "Cube PSO (no culling)";
+        PSOCreateInfo.GraphicsPipeline.RasterizerDesc.CullMode = CULL_MODE_NONE;
+        CountLookup(m_ShaderCache.CreateGraphicsPipelineState(PSOCreateInfo, &Loads.pPSO_NoCull));
+
+        // #Los NPCs: cube.vsh con GRASS_INSTANCED=1 y sin viento, la matriz de cada uno llega
+        // por instancia y el constant buffer solo lleva ViewProj
+        RefCntAutoPtr<IShader> pAgentVS;
+        {
+            ShaderMacro AgentMacros[] = {{"CONVERT_PS_OUTPUT_TO_GAMMA", m_ConvertPSOutputToGamma ? "1" : "0"}, {"GRASS_INSTANCED", "1"}, {"GRASS_WIND", "0"}};
+            ShaderCI.Macros          = {AgentMacros, _countof(AgentMacros)};
+            ShaderCI.Desc.ShaderType = SHADER_TYPE_VERTEX;
+            ShaderCI.EntryPoint      = "main";
+            ShaderCI.Desc.Name       = "Agent instanced VS";
+            ShaderCI.FilePath        = "cube.vsh";
+            CountLookup(m_ShaderCache.CreateShader(ShaderCI, &pAgentVS));
+        }
+        PSOCreateInfo.PSODesc.Name                                = "Agent instanced PSO";
+        PSOCreateInfo.pVS                                         = pAgentVS;
+        PSOCreateInfo.GraphicsPipeline.InputLayout.LayoutElements = InstLayoutElems;
+        PSOCreateInfo.GraphicsPipeline.InputLayout.NumElements    = _countof(InstLayoutElems);
+        CountLookup(m_ShaderCache.CreateGraphicsPipelineState(PSOCreateInfo, &Loads.pAgentPSO));
+
+        for (auto* pScenePSO : {Loads.pPSO.RawPtr(), Loads.pPSO_NoCull.RawPtr(), Loads.pAgentPSO.RawPtr()})
+        {
+            if (pScenePSO != nullptr)
+                pScenePSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "g_TrampleMask")->Set(pTrampleMaskSRV);
+        }
+        return;
+    }
 
+    // #PSOs del pasto. Son el mismo cube.vsh compilado con GRASS_WIND=1, que evalua el viento
+    // en el vertex shader; el camino instanciado ademas usa GRASS_INSTANCED=1 y lee la matriz
+    // de mundo y el bend de cada tuft desde un segundo vertex buffer
     PSOCreateInfo.GraphicsPipeline.RasterizerDesc.CullMode = CULL_MODE_NONE;
-    m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pPSO_NoCull);
-    m_pPSO_NoCull->GetStaticVariableByName(SHADER_TYPE_VERTEX, "Constants")->Set(m_VSConstants);
+
+    // clang-format off
+    ImmutableSamplerDesc GrassImtblSamplers[] = 
+    {
+        {SHADER_TYPE_PIXEL,  "g_Texture",   SamLinearClampDesc},
+        {SHADER_TYPE_VERTEX, "g_WindNoise", SamLinearWrapDesc},
+        {SHADER_TYPE_VERTEX | SHADER_TYPE_PIXEL, "g_TrampleMask", SamLinearWrapDesc}
+    };
+    // clang-format on
+    PSOCreateInfo.PSODesc.ResourceLayout.ImmutableSamplers    = GrassImtblSamplers;
+    PSOCreateInfo.PSODesc.ResourceLayout.NumImmutableSamplers = _countof(GrassImtblSamplers);
+
+    // clang-format off
+    // #Cada hilo que graba pasto usa sus propios constant buffers, asi que van en el SRB
+    ShaderResourceVariableDesc GrassVars[] = 
+    {
+        {SHADER_TYPE_PIXEL,  "g_Texture",      SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {SHADER_TYPE_VERTEX, "Constants",      SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {SHADER_TYPE_VERTEX, "GrassConstants", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}
+    };
+    // clang-format on
+    PSOCreateInfo.PSODesc.ResourceLayout.Variables    = GrassVars;
+    PSOCreateInfo.PSODesc.ResourceLayout.NumVariables = _countof(GrassVars);
+
+    const bool             Instanced = Phase == STARTUP_PHASE_GRASS_INST_PSO;
+    RefCntAutoPtr<IShader> pGrassVS;
+    {
+        ShaderMacro GrassMacros[] = {{"CONVERT_PS_OUTPUT_TO_GAMMA", m_ConvertPSOutputToGamma ? "1" : "0"}, {"GRASS_INSTANCED", Instanced ? "1" : "0"}, {"GRASS_WIND", "1"}};
+        ShaderCI.Macros          = {GrassMacros, _countof(GrassMacros)};
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_VERTEX;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = Instanced ? "Grass instanced VS" : "Grass VS";
+        ShaderCI.FilePath        = "cube.vsh";
+        CountLookup(m_ShaderCache.CreateShader(ShaderCI, &pGrassVS));
+    }
+
+    PSOCreateInfo.PSODesc.Name = Instanced ? "Grass instanced PSO" : "Grass PSO";
+    PSOCreateInfo.pVS          = pGrassVS;
+    if (Instanced)
+    {
+        PSOCreateInfo.GraphicsPipeline.InputLayout.LayoutElements = InstLayoutElems;
+        PSOCreateInfo.GraphicsPipeline.InputLayout.NumElements    = _countof(InstLayoutElems);
+    }
+
+    auto& pGrassPSO = Instanced ? Loads.pGrassInstPSO : Loads.pGrassPSO;
+    CountLookup(m_ShaderCache.CreateGraphicsPipelineState(PSOCreateInfo, &pGrassPSO));
+    if (pGrassPSO)
+    {
+        pGrassPSO->GetStaticVariableByName(SHADER_TYPE_VERTEX, "g_WindNoise")->Set(m_WindNoiseTexture->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+        // #El vertex shader aplasta los tufts pisados; el pixel shader del pasto no lo usa, pero
+        // cube.psh lo declara igual
+        pGrassPSO->GetStaticVariableByName(SHADER_TYPE_VERTEX, "g_TrampleMask")->Set(pTrampleMaskSRV);
+        pGrassPSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "g_TrampleMask")->Set(pTrampleMaskSRV);
+    }
 }
 
 void Tutorial11_ResourceUpdates::CreateVertexBuffers()
@@ -306,40 +576,51 @@ void Tutorial11_ResourceUpdates::CreateVertexBuffers()
         }
 
         VertBuffDesc.BindFlags = BIND_VERTEX_BUFFER;
-        VertBuffDesc.Size      = sizeof(CubeVerts);
+        VertBuffDesc.Size      = static_cast<Uint64>(m_GrassMesh.VertexData.size());
         BufferData VBData;
-        VBData.pData    = CubeVerts;
-        VBData.DataSize = sizeof(CubeVerts);
-        m_pDevice->CreateBuffer(VertBuffDesc, i < 2 ? &VBData : nullptr, &VertexBuffer);
+        VBData.pData    = m_GrassMesh.VertexData.data();
+        VBData.DataSize = VertBuffDesc.Size;
+        GpuMemoryRegistry::Get().CreateBuffer(m_pDevice, VertBuffDesc, i < 2 ? &VBData : nullptr, GpuMemoryRegistry::CATEGORY_GEOMETRY, &VertexBuffer);
     }
 }
 
-void Tutorial11_ResourceUpdates::CreateIndexBuffer()
+// #Suelda y ordena las mallas para el cache de vertices, las convierte al formato de los vertex
+// buffers y deja en el log cuanto se gano y cuanto se perdio
+void Tutorial11_ResourceUpdates::BuildMeshes()
 {
-    // #Indices del pasto
-    const Uint32 Indices[] =
-    {
-         4,  5,  6,   4,  6,  7,
-         8,  9, 10,   8, 10, 11,
-        12, 13, 14,  12, 14, 15,
-        16, 17, 18,  16, 18, 19,
-        20, 21,  5,   20,  5,  4,   
-        22, 23,  8,   22,  8,  9,
-        24, 25,  4,   24,  4,  8,
-        26, 27, 13,   26, 13, 17
-    };
-    // clang-format on
+    const auto Format = m_CompactVertices ? MESH_VERTEX_FORMAT_COMPACT : MESH_VERTEX_FORMAT_FLOAT32;
+    const auto Flags  = MESH_BUILD_FLAG_WELD | MESH_BUILD_FLAG_OPTIMIZE_VERTEX_CACHE;
+
+    // #Cada LOD del pasto se optimiza por separado para que sus rangos de indices sigan valiendo
+    m_GrassMesh  = BuildMesh("Grass", CubeVerts, _countof(CubeVerts), GrassIndices, _countof(GrassIndices), Format, Flags, GrassLODs, _countof(GrassLODs));
+    m_PlayerMesh = BuildMesh("Player", SimpleCubeVerts, _countof(SimpleCubeVerts), SimpleCubeIndices, _countof(SimpleCubeIndices), Format, Flags);
+    m_GroundMesh = BuildMesh("Ground", GroundPlaneVerts, _countof(GroundPlaneVerts), GroundPlaneIndices, _countof(GroundPlaneIndices), Format, Flags);
 
+    for (const auto* pMesh : {&m_GrassMesh, &m_PlayerMesh, &m_GroundMesh})
+    {
+        const auto& Report = pMesh->Report;
+        LOG_INFO_MESSAGE(pMesh->Name, " mesh: ", Report.InputVertices, " -> ", pMesh->NumVertices, " vertices (", Report.WeldedVertices,
+                         " welded, ", Report.UnusedVertices, " unused), ACMR ", Report.ACMRBefore, " -> ", Report.ACMRAfter);
+        LOG_INFO_MESSAGE(pMesh->Name, " mesh (", GetMeshVertexFormatName(pMesh->Format), "): ", Report.VertexBytes + Report.IndexBytes,
+                         " bytes (", Report.Float32Bytes, " in float32), max position error ", Report.MaxPosError,
+                         ", max UV error ", Report.MaxUVError);
+        if (Report.NumClamped > 0)
+            LOG_WARNING_MESSAGE(pMesh->Name, " mesh: ", Report.NumClamped, " components were clamped during quantization");
+    }
+}
+
+void Tutorial11_ResourceUpdates::CreateIndexBuffer()
+{
     // Create index buffer
     BufferDesc IndBuffDesc;
     IndBuffDesc.Name      = "Cube index buffer";
     IndBuffDesc.Usage     = USAGE_IMMUTABLE;
     IndBuffDesc.BindFlags = BIND_INDEX_BUFFER;
-    IndBuffDesc.Size      = sizeof(Indices);
+    IndBuffDesc.Size      = static_cast<Uint64>(m_GrassMesh.IndexData.size());
     BufferData IBData;
-    IBData.pData    = Indices;
-    IBData.DataSize = sizeof(Indices);
-    m_pDevice->CreateBuffer(IndBuffDesc, &IBData, &m_CubeIndexBuffer);
+    IBData.pData    = m_GrassMesh.IndexData.data();
+    IBData.DataSize = IndBuffDesc.Size;
+    GpuMemoryRegistry::Get().CreateBuffer(m_pDevice, IndBuffDesc, &IBData, GpuMemoryRegistry::CATEGORY_GEOMETRY, &m_CubeIndexBuffer);
 }
 
 
@@ -350,45 +631,115 @@ void Tutorial11_ResourceUpdates::CreatePlayerCube()
     VertBuffDesc.Name      = "Player cube vertex buffer";
     VertBuffDesc.Usage     = USAGE_IMMUTABLE;
     VertBuffDesc.BindFlags = BIND_VERTEX_BUFFER;
-    VertBuffDesc.Size      = sizeof(SimpleCubeVerts);
+    VertBuffDesc.Size      = static_cast<Uint64>(m_PlayerMesh.VertexData.size());
     BufferData VBData;
-    VBData.pData    = SimpleCubeVerts;
-    VBData.DataSize = sizeof(SimpleCubeVerts);
-    m_pDevice->CreateBuffer(VertBuffDesc, &VBData, &m_PlayerCubeVertexBuffer);
+    VBData.pData    = m_PlayerMesh.VertexData.data();
+    VBData.DataSize = VertBuffDesc.Size;
+    GpuMemoryRegistry::Get().CreateBuffer(m_pDevice, VertBuffDesc, &VBData, GpuMemoryRegistry::CATEGORY_GEOMETRY, &m_PlayerCubeVertexBuffer);
 
     BufferDesc IndexBuffDesc;
     IndexBuffDesc.Name      = "Player cube index buffer";
     IndexBuffDesc.Usage     = USAGE_IMMUTABLE;
     IndexBuffDesc.BindFlags = BIND_INDEX_BUFFER;
-    IndexBuffDesc.Size      = sizeof(SimpleCubeIndices);
+    IndexBuffDesc.Size      = static_cast<Uint64>(m_PlayerMesh.IndexData.size());
     BufferData IBData;
-    IBData.pData    = SimpleCubeIndices;
-    IBData.DataSize = sizeof(SimpleCubeIndices);
-    m_pDevice->CreateBuffer(IndexBuffDesc, &IBData, &m_PlayerCubeIndexBuffer);
+    IBData.pData    = m_PlayerMesh.IndexData.data();
+    IBData.DataSize = IndexBuffDesc.Size;
+    GpuMemoryRegistry::Get().CreateBuffer(m_pDevice, IndexBuffDesc, &IBData, GpuMemoryRegistry::CATEGORY_GEOMETRY, &m_PlayerCubeIndexBuffer);
 }
 
 // #Dibuja el cubo del jugador
-void Tutorial11_ResourceUpdates::DrawPlayerCube(const float4x4& WVPMatrix, IShaderResourceBinding* pSRB)
+void Tutorial11_ResourceUpdates::DrawPlayerCube(const float4x4& WVPMatrix, Uint32 TextureSlice)
 {
+    GRASS_PROFILE_SCOPE("DrawPlayerCube");
+
     // Bind vertex buffer
     IBuffer* pBuffs[] = {m_PlayerCubeVertexBuffer};
     m_pImmediateContext->SetVertexBuffers(0, 1, pBuffs, nullptr, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, SET_VERTEX_BUFFERS_FLAG_RESET);
     m_pImmediateContext->SetIndexBuffer(m_PlayerCubeIndexBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
-    // Commit shader resources
-    m_pImmediateContext->CommitShaderResources(pSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-
     {
         // #Informacion del mapaaa
-        MapHelper<float4x4> CBConstants(m_pImmediateContext, m_VSConstants, MAP_WRITE, MAP_FLAG_DISCARD);
-        *CBConstants = WVPMatrix;
+        Uint32 Offset      = 0;
+        auto*  CBConstants = static_cast<VSConstants*>(m_SceneConstants.Map(m_pImmediateContext, sizeof(VSConstants), Offset));
+        CBConstants->WorldViewProj = WVPMatrix;
+        CBConstants->TuftOrigin    = float4{0, 0, 0, 1};
+        CBConstants->DrawParams    = float4{static_cast<float>(TextureSlice), 0, 0, 0};
+        CBConstants->GroundXZ      = float4{0, 0, 0, 0};
+        CBConstants->GroundTrample = float4{0, 0, 0, 0};
+        CBConstants->MeshScale     = m_PlayerMesh.PosScale;
+        m_SceneConstants.Unmap(m_pImmediateContext);
+        m_SceneSRB->GetVariableByName(SHADER_TYPE_VERTEX, "Constants")->SetBufferOffset(Offset);
     }
 
+    // Commit shader resources
+    m_pImmediateContext->CommitShaderResources(m_SceneSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
     DrawIndexedAttribs DrawAttrs;
-    DrawAttrs.IndexType  = VT_UINT32;
-    DrawAttrs.NumIndices = 36; 
+    DrawAttrs.IndexType  = m_PlayerMesh.IndexType;
+    DrawAttrs.NumIndices = m_PlayerMesh.NumIndices;
     DrawAttrs.Flags      = DRAW_FLAG_VERIFY_ALL;
     m_pImmediateContext->DrawIndexed(DrawAttrs);
+
+    ++m_FrameCounters.DrawCalls;
+    m_FrameCounters.UploadBytes += sizeof(VSConstants);
+}
+
+// #Los NPCs: la malla del jugador un poco mas chica, una instancia por NPC. Antes iba un
+// DrawPlayerCube por NPC y cada uno gastaba un bloque del ring de la escena, que con miles de NPCs
+// se llenaba varias veces por frame
+void Tutorial11_ResourceUpdates::DrawAgents(const float4x4& ViewProj)
+{
+    GRASS_PROFILE_SCOPE("DrawAgents");
+
+    if (!m_AgentSRB || !m_AgentInstanceBuffer)
+        return;
+
+    const Uint32 Capacity  = static_cast<Uint32>(m_AgentInstanceBuffer->GetDesc().Size / sizeof(GrassInstance));
+    const Uint32 NumAgents = std::min(static_cast<Uint32>(m_RenderAgentPos.size()), Capacity);
+    VERIFY(NumAgents == m_RenderAgentPos.size(), "The agent instance buffer is smaller than the number of agents. ResetAgents() must grow it.");
+    if (NumAgents == 0)
+        return;
+
+    {
+        MapHelper<GrassInstance> InstData(m_pImmediateContext, m_AgentInstanceBuffer, MAP_WRITE, MAP_FLAG_DISCARD);
+        for (Uint32 a = 0; a < NumAgents; ++a)
+        {
+            const auto& AgentPos = m_RenderAgentPos[a];
+            InstData[a].World    = float4x4::Scale(1.2f) * float4x4::Translation(AgentPos.x, 0.6f, AgentPos.y);
+            InstData[a].Bend     = float4{0, 0, 0, static_cast<float>(PlayerTextureSlice)};
+        }
+    }
+
+    {
+        Uint32 Offset      = 0;
+        auto*  CBConstants = static_cast<VSConstants*>(m_SceneConstants.Map(m_pImmediateContext, sizeof(VSConstants), Offset));
+        CBConstants->WorldViewProj = ViewProj;
+        CBConstants->TuftOrigin    = float4{0, 0, 0, 1};
+        CBConstants->DrawParams    = float4{static_cast<float>(PlayerTextureSlice), 0, 0, 0};
+        CBConstants->GroundXZ      = float4{0, 0, 0, 0};
+        CBConstants->GroundTrample = float4{0, 0, 0, 0};
+        CBConstants->MeshScale     = m_PlayerMesh.PosScale;
+        m_SceneConstants.Unmap(m_pImmediateContext);
+        m_AgentSRB->GetVariableByName(SHADER_TYPE_VERTEX, "Constants")->SetBufferOffset(Offset);
+    }
+
+    m_pImmediateContext->SetPipelineState(m_pAgentPSO);
+
+    IBuffer* pBuffs[] = {m_PlayerCubeVertexBuffer, m_AgentInstanceBuffer};
+    m_pImmediateContext->SetVertexBuffers(0, _countof(pBuffs), pBuffs, nullptr, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, SET_VERTEX_BUFFERS_FLAG_RESET);
+    m_pImmediateContext->SetIndexBuffer(m_PlayerCubeIndexBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pImmediateContext->CommitShaderResources(m_AgentSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    DrawIndexedAttribs DrawAttrs;
+    DrawAttrs.IndexType    = m_PlayerMesh.IndexType;
+    DrawAttrs.NumIndices   = m_PlayerMesh.NumIndices;
+    DrawAttrs.NumInstances = NumAgents;
+    DrawAttrs.Flags        = DRAW_FLAG_VERIFY_ALL;
+    m_pImmediateContext->DrawIndexed(DrawAttrs);
+
+    ++m_FrameCounters.DrawCalls;
+    m_FrameCounters.UploadBytes += sizeof(VSConstants) + sizeof(GrassInstance) * NumAgents;
 }
 
 // #Lo mismo pero para el piso
@@ -399,416 +750,2622 @@ void Tutorial11_ResourceUpdates::CreateGroundPlane()
     VertBuffDesc.Name      = "Ground plane vertex buffer";
     VertBuffDesc.Usage     = USAGE_IMMUTABLE;
     VertBuffDesc.BindFlags = BIND_VERTEX_BUFFER;
-    VertBuffDesc.Size      = sizeof(GroundPlaneVerts);
+    VertBuffDesc.Size      = static_cast<Uint64>(m_GroundMesh.VertexData.size());
     BufferData VBData;
-    VBData.pData    = GroundPlaneVerts;
-    VBData.DataSize = sizeof(GroundPlaneVerts);
-    m_pDevice->CreateBuffer(VertBuffDesc, &VBData, &m_GroundPlaneVertexBuffer);
+    VBData.pData    = m_GroundMesh.VertexData.data();
+    VBData.DataSize = VertBuffDesc.Size;
+    GpuMemoryRegistry::Get().CreateBuffer(m_pDevice, VertBuffDesc, &VBData, GpuMemoryRegistry::CATEGORY_GEOMETRY, &m_GroundPlaneVertexBuffer);
 
     // Create ground plane index buffer
     BufferDesc IndexBuffDesc;
     IndexBuffDesc.Name      = "Ground plane index buffer";
     IndexBuffDesc.Usage     = USAGE_IMMUTABLE;
     IndexBuffDesc.BindFlags = BIND_INDEX_BUFFER;
-    IndexBuffDesc.Size      = sizeof(GroundPlaneIndices);
+    IndexBuffDesc.Size      = static_cast<Uint64>(m_GroundMesh.IndexData.size());
     BufferData IBData;
-    IBData.pData    = GroundPlaneIndices;
-    IBData.DataSize = sizeof(GroundPlaneIndices);
-    m_pDevice->CreateBuffer(IndexBuffDesc, &IBData, &m_GroundPlaneIndexBuffer);
+    IBData.pData    = m_GroundMesh.IndexData.data();
+    IBData.DataSize = IndexBuffDesc.Size;
+    GpuMemoryRegistry::Get().CreateBuffer(m_pDevice, IndexBuffDesc, &IBData, GpuMemoryRegistry::CATEGORY_GEOMETRY, &m_GroundPlaneIndexBuffer);
 }
 
-void Tutorial11_ResourceUpdates::DrawGroundPlane(const float4x4& WVPMatrix, IShaderResourceBinding* pSRB)
+void Tutorial11_ResourceUpdates::DrawGroundPlane(const float4x4& WVPMatrix, const float4& WorldXZ, Uint32 TextureSlice)
 {
+    GRASS_PROFILE_SCOPE("DrawGroundPlane");
+
     // Bind vertex and index buffers
     IBuffer* pBuffs[] = {m_GroundPlaneVertexBuffer};
     m_pImmediateContext->SetVertexBuffers(0, 1, pBuffs, nullptr, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, SET_VERTEX_BUFFERS_FLAG_RESET);
     m_pImmediateContext->SetIndexBuffer(m_GroundPlaneIndexBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
-    // Commit shader resources
-    m_pImmediateContext->CommitShaderResources(pSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-
     {
-        // Map the buffer and write current world-view-projection matrix
-        MapHelper<float4x4> CBConstants(m_pImmediateContext, m_VSConstants, MAP_WRITE, MAP_FLAG_DISCARD);
-        *CBConstants = WVPMatrix;
+        // #Se escribe la matriz en el ring y el SRB apunta a ese bloque
+        Uint32 Offset      = 0;
+        auto*  CBConstants = static_cast<VSConstants*>(m_SceneConstants.Map(m_pImmediateContext, sizeof(VSConstants), Offset));
+        CBConstants->WorldViewProj = WVPMatrix;
+        CBConstants->TuftOrigin    = float4{0, 0, 0, 1};
+        CBConstants->DrawParams    = float4{static_cast<float>(TextureSlice), 0, 0, 0};
+        CBConstants->GroundXZ      = WorldXZ;
+        CBConstants->GroundTrample = m_TrampleMask.GetShaderParams(m_UseTrampleMask ? m_TrampleStrength : 0.f);
+        CBConstants->MeshScale     = m_GroundMesh.PosScale;
+        m_SceneConstants.Unmap(m_pImmediateContext);
+        m_SceneSRB->GetVariableByName(SHADER_TYPE_VERTEX, "Constants")->SetBufferOffset(Offset);
     }
 
+    // Commit shader resources
+    m_pImmediateContext->CommitShaderResources(m_SceneSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
     DrawIndexedAttribs DrawAttrs;
-    DrawAttrs.IndexType  = VT_UINT32;
-    DrawAttrs.NumIndices = 6; // 2 triangles, 3 vertices each
+    DrawAttrs.IndexType  = m_GroundMesh.IndexType;
+    DrawAttrs.NumIndices = m_GroundMesh.NumIndices; // 2 triangles, 3 vertices each
     DrawAttrs.Flags      = DRAW_FLAG_VERIFY_ALL;
     m_pImmediateContext->DrawIndexed(DrawAttrs);
+
+    ++m_FrameCounters.DrawCalls;
+    m_FrameCounters.UploadBytes += sizeof(VSConstants);
+}
+
+// #Mientras se decodifican las imagenes se dibuja con este array: una capa de 1x1 por cada
+// grassN.png, gris para el jugador y verde para el resto
+void Tutorial11_ResourceUpdates::CreatePlaceholderTexture()
+{
+    TextureDesc ArrDesc;
+    ArrDesc.Name      = "Placeholder texture array";
+    ArrDesc.Type      = RESOURCE_DIM_TEX_2D_ARRAY;
+    ArrDesc.Width     = 1;
+    ArrDesc.Height    = 1;
+    ArrDesc.ArraySize = static_cast<Uint32>(NumTextures);
+    ArrDesc.MipLevels = 1;
+    ArrDesc.Format    = TEX_FORMAT_RGBA8_UNORM_SRGB;
+    ArrDesc.Usage     = USAGE_IMMUTABLE;
+    ArrDesc.BindFlags = BIND_SHADER_RESOURCE;
+
+    std::array<Uint32, NumTextures>            Texels;
+    std::array<TextureSubResData, NumTextures> SubResources;
+    for (size_t i = 0; i < NumTextures; ++i)
+    {
+        Texels[i]       = i == PlayerTextureSlice ? 0xFF808080u : 0xFF2E7A3Au; // ABGR
+        SubResources[i] = {&Texels[i], 4};
+    }
+
+    TextureData InitData{SubResources.data(), static_cast<Uint32>(SubResources.size())};
+    GpuMemoryRegistry::Get().CreateTexture(m_pDevice, ArrDesc, &InitData, GpuMemoryRegistry::CATEGORY_TEXTURES, &m_TextureArray);
 }
 
-void Tutorial11_ResourceUpdates::LoadTextures()
+// #Todas las texturas grassN en un Texture2DArray con todos sus mips, para que un solo SRB sirva
+// para el piso, el jugador y cualquier variante de tuft. Si todas vienen de grassN.dds (ver
+// tools/GrassTextureBaker) con el mismo formato, tamano y mips, los bloques se suben tal cual.
+// Si no, se usan los PNG: el array tiene el tamano de la imagen mas grande; las mas chicas usan
+// sus propios mips donde coinciden los tamanos y el resto se escala. Corre en el thread pool del
+// arranque cuando ya se decodificaron todas
+RefCntAutoPtr<ITexture> Tutorial11_ResourceUpdates::CreateTextureArray(std::array<RefCntAutoPtr<ITextureLoader>, NumTextures>& Loaders)
 {
-    for (size_t i = 0; i < m_Textures.size(); ++i)
+    for (const auto& pLoader : Loaders)
+    {
+        if (!pLoader)
+            return {};
+    }
+
+    const auto& FirstDesc = Loaders[0]->GetTextureDesc();
+
+    bool UseBaked = true;
+    for (const auto& pLoader : Loaders)
     {
-        // Load texture
-        TextureLoadInfo   loadInfo;
-        std::stringstream FileNameSS;
-        FileNameSS << "grass" << i << ".png";
-        auto FileName   = FileNameSS.str();
-        loadInfo.IsSRGB = true;
-        loadInfo.Usage  = USAGE_IMMUTABLE;
-        if (i == 2)
+        const auto& SrcDesc = pLoader->GetTextureDesc();
+        UseBaked            = UseBaked && IsBakedTextureFormat(SrcDesc.Format) && SrcDesc.Format == FirstDesc.Format &&
+            SrcDesc.Width == FirstDesc.Width && SrcDesc.Height == FirstDesc.Height && SrcDesc.MipLevels == FirstDesc.MipLevels;
+    }
+    if (!UseBaked)
+    {
+        // #No se pueden mezclar capas comprimidas con las de los PNG
+        for (Uint32 i = 0; i < NumTextures; ++i)
         {
-            loadInfo.Usage = USAGE_DEFAULT;
-            // Disable mipmapping for simplicity as we will only update mip level 0
-            loadInfo.MipLevels = 1;
+            if (IsBakedTextureFormat(Loaders[i]->GetTextureDesc().Format))
+            {
+                LOG_WARNING_MESSAGE("grass", i, ".dds does not match the other grass textures. Falling back to grass", i, ".png.");
+                Loaders[i] = DecodeGrassTexture(i, false);
+                if (!Loaders[i])
+                    return {};
+            }
         }
-        else if (i == 3)
+    }
+
+    Uint32 Width = 0, Height = 0;
+    for (const auto& pLoader : Loaders)
+    {
+        const auto& SrcDesc = pLoader->GetTextureDesc();
+        Width               = std::max(Width, SrcDesc.Width);
+        Height              = std::max(Height, SrcDesc.Height);
+    }
+
+    TextureDesc ArrDesc;
+    ArrDesc.Name      = "Grass texture array";
+    ArrDesc.Type      = RESOURCE_DIM_TEX_2D_ARRAY;
+    ArrDesc.Width     = Width;
+    ArrDesc.Height    = Height;
+    ArrDesc.ArraySize = static_cast<Uint32>(NumTextures);
+    ArrDesc.MipLevels = UseBaked ? FirstDesc.MipLevels : ComputeMipLevelsCount(Width, Height);
+    ArrDesc.Format    = UseBaked ? FirstDesc.Format : TEX_FORMAT_RGBA8_UNORM_SRGB;
+    ArrDesc.Usage     = USAGE_IMMUTABLE;
+    ArrDesc.BindFlags = BIND_SHADER_RESOURCE;
+
+    // #Los subrecursos van por capa y dentro de cada capa por mip
+    std::vector<TextureSubResData>  SubResources;
+    std::vector<std::vector<Uint8>> ResampledData;
+    ResampledData.reserve(NumTextures * ArrDesc.MipLevels);
+    for (size_t i = 0; i < NumTextures; ++i)
+    {
+        const auto& SrcDesc = Loaders[i]->GetTextureDesc();
+        for (Uint32 Mip = 0; Mip < ArrDesc.MipLevels; ++Mip)
         {
-            // Disable mipmapping
-            loadInfo.MipLevels      = 1;
-            loadInfo.Usage          = USAGE_DYNAMIC;
-            loadInfo.CPUAccessFlags = CPU_ACCESS_WRITE;
-        }
+            if (UseBaked)
+            {
+                SubResources.push_back(Loaders[i]->GetSubresourceData(Mip));
+                continue;
+            }
+
+            const Uint32 MipW = std::max(Width >> Mip, 1u);
+            const Uint32 MipH = std::max(Height >> Mip, 1u);
 
-        auto& Tex = m_Textures[i];
-        CreateTextureFromFile(FileName.c_str(), loadInfo, m_pDevice, &Tex);
-        // Get shader resource view from the texture
-        auto TextureSRV = Tex->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
+            // #Primero se busca un mip de la imagen que ya tenga el tamano justo
+            bool Found = false;
+            for (Uint32 SrcMip = 0; SrcMip < SrcDesc.MipLevels && !Found; ++SrcMip)
+            {
+                if (std::max(SrcDesc.Width >> SrcMip, 1u) == MipW && std::max(SrcDesc.Height >> SrcMip, 1u) == MipH)
+                {
+                    SubResources.push_back(Loaders[i]->GetSubresourceData(SrcMip));
+                    Found = true;
+                }
+            }
+            if (!Found)
+            {
+                const auto& Src = Loaders[i]->GetSubresourceData(0);
+                ResampledData.emplace_back(size_t{MipW} * MipH * 4);
+                ResampleRGBA8(static_cast<const Uint8*>(Src.pData), SrcDesc.Width, SrcDesc.Height, static_cast<size_t>(Src.Stride),
+                              ResampledData.back().data(), MipW, MipH);
+                SubResources.push_back({ResampledData.back().data(), Uint64{MipW} * 4});
+            }
+        }
+    }
 
-        // Since we are using mutable variable, we must create shader resource binding object
-        // http://diligentgraphics.com/2016/03/23/resource-binding-model-in-diligent-engine-2-0/
-        m_pPSO->CreateShaderResourceBinding(&(m_SRBs[i]), true);
-        // Set texture SRV in the SRB
-        m_SRBs[i]->GetVariableByName(SHADER_TYPE_PIXEL, "g_Texture")->Set(TextureSRV);
+    RefCntAutoPtr<ITexture> pTextureArray;
+    TextureData             InitData{SubResources.data(), static_cast<Uint32>(SubResources.size())};
+    GpuMemoryRegistry::Get().CreateTexture(m_pDevice, ArrDesc, &InitData, GpuMemoryRegistry::CATEGORY_TEXTURES, &pTextureArray);
+    if (pTextureArray)
+    {
+        LOG_INFO_MESSAGE("Grass texture array: ", Width, "x", Height, "x", NumTextures, ", ", ArrDesc.MipLevels, " mips, ",
+                         GetTextureFormatAttribs(ArrDesc.Format).Name, ", ", GetStagingTextureDataSize(ArrDesc) >> 10, " KB",
+                         UseBaked ? " (baked)" : " (from PNG)");
     }
+    return pTextureArray;
 }
 
+// #El SRB del piso y el jugador. Se vuelve a crear cuando cambia m_TextureArray, porque una
+// variable mutable no se puede reasignar
+void Tutorial11_ResourceUpdates::CreateSceneSRB()
+{
+    m_SceneSRB.Release();
+    // Since we are using mutable variable, we must create shader resource binding object
+    // http://diligentgraphics.com/2016/03/23/resource-binding-model-in-diligent-engine-2-0/
+    m_pPSO->CreateShaderResourceBinding(&m_SceneSRB, true);
+    // Set texture SRV in the SRB
+    m_SceneSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_Texture")->Set(m_TextureArray->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+    // #Solo se ve un VSConstants del ring; el draw elige cual con SetBufferOffset
+    m_SceneSRB->GetVariableByName(SHADER_TYPE_VERTEX, "Constants")->SetBufferRange(m_SceneConstants.GetBuffer(), 0, sizeof(VSConstants));
+
+    // #Los NPCs usan el mismo texture array y el mismo ring
+    m_AgentSRB.Release();
+    if (m_pAgentPSO)
+    {
+        m_pAgentPSO->CreateShaderResourceBinding(&m_AgentSRB, true);
+        m_AgentSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_Texture")->Set(m_TextureArray->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+        m_AgentSRB->GetVariableByName(SHADER_TYPE_VERTEX, "Constants")->SetBufferRange(m_SceneConstants.GetBuffer(), 0, sizeof(VSConstants));
+    }
+}
 
-void Tutorial11_ResourceUpdates::Initialize(const SampleInitInfo& InitInfo)
+// #Textura de ruido (value noise que se repite) que el vertex shader del pasto muestrea
+// en la posicion de cada tuft, para que no todos se muevan igual
+void Tutorial11_ResourceUpdates::CreateWindNoiseTexture()
 {
-    SampleBase::Initialize(InitInfo);
+    constexpr Uint32 Size  = WindNoiseSize;
+    constexpr Uint32 Cells = 8;
 
-    CreatePipelineStates();
-    CreateVertexBuffers();
-    CreateIndexBuffer();
-    //# Crea el jugador y piso
-    CreatePlayerCube();
-    CreateGroundPlane();
-    LoadTextures();
+    std::mt19937                          gen{1};
+    std::uniform_real_distribution<float> dist{0.f, 1.f};
 
+    float Lattice[Cells][Cells];
+    for (Uint32 y = 0; y < Cells; ++y)
+        for (Uint32 x = 0; x < Cells; ++x)
+            Lattice[y][x] = dist(gen);
+
+    std::vector<Uint8> Texels(Size * Size);
+    for (Uint32 y = 0; y < Size; ++y)
     {
-        BufferDesc VertBuffDesc;
-        VertBuffDesc.Name           = "Texture update buffer";
-        VertBuffDesc.Usage          = USAGE_DYNAMIC;
-        VertBuffDesc.BindFlags      = BIND_VERTEX_BUFFER; // We do not really bind the buffer, but D3D11 wants at least one bind flag bit
-        VertBuffDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
-        VertBuffDesc.Size           = MaxUpdateRegionSize * MaxUpdateRegionSize * 4;
-        m_pDevice->CreateBuffer(VertBuffDesc, nullptr, &m_TextureUpdateBuffer);
+        for (Uint32 x = 0; x < Size; ++x)
+        {
+            float  fx = static_cast<float>(x * Cells) / Size;
+            float  fy = static_cast<float>(y * Cells) / Size;
+            Uint32 x0 = static_cast<Uint32>(fx), x1 = (x0 + 1) % Cells;
+            Uint32 y0 = static_cast<Uint32>(fy), y1 = (y0 + 1) % Cells;
+            float  tx = fx - x0;
+            float  ty = fy - y0;
+            tx        = tx * tx * (3.f - 2.f * tx);
+            ty        = ty * ty * (3.f - 2.f * ty);
+
+            float v0 = Lattice[y0][x0] + (Lattice[y0][x1] - Lattice[y0][x0]) * tx;
+            float v1 = Lattice[y1][x0] + (Lattice[y1][x1] - Lattice[y1][x0]) * tx;
+            float v  = v0 + (v1 - v0) * ty;
+
+            Texels[y * Size + x] = static_cast<Uint8>(v * 255.f + 0.5f);
+        }
     }
 
-    // #Infor necesarioa para deformar
-    constexpr int GRID = 50;
-    m_GrassDeformed.resize(GRID * GRID, false);
-    m_GrassDeformX.resize(GRID * GRID, 0.0f);
-    m_GrassDeformZ.resize(GRID * GRID, 0.0f);
+    TextureDesc TexDesc;
+    TexDesc.Name      = "Wind noise texture";
+    TexDesc.Type      = RESOURCE_DIM_TEX_2D;
+    TexDesc.Width     = Size;
+    TexDesc.Height    = Size;
+    TexDesc.Format    = TEX_FORMAT_R8_UNORM;
+    TexDesc.MipLevels = 1;
+    TexDesc.Usage     = USAGE_IMMUTABLE;
+    TexDesc.BindFlags = BIND_SHADER_RESOURCE;
+
+    TextureSubResData Level0{Texels.data(), Size};
+    TextureData       InitData{&Level0, 1};
+    GpuMemoryRegistry::Get().CreateTexture(m_pDevice, TexDesc, &InitData, GpuMemoryRegistry::CATEGORY_TEXTURES, &m_WindNoiseTexture);
 }
 
-void Tutorial11_ResourceUpdates::DrawCube(const float4x4& WVPMatrix, Diligent::IBuffer* pVertexBuffer, Diligent::IShaderResourceBinding* pSRB)
+void Tutorial11_ResourceUpdates::UpdateGrassConstants(IDeviceContext* pCtx, IBuffer* pGrassConstants)
 {
-    // Bind vertex buffer
-    IBuffer* pBuffs[] = {pVertexBuffer};
-    m_pImmediateContext->SetVertexBuffers(0, 1, pBuffs, nullptr, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, SET_VERTEX_BUFFERS_FLAG_RESET);
-    m_pImmediateContext->SetIndexBuffer(m_CubeIndexBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-
-    // Commit shader resources. RESOURCE_STATE_TRANSITION_MODE_TRANSITION mode
-    // makes sure that resources are transitioned to required states.
-    m_pImmediateContext->CommitShaderResources(pSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    GRASS_PROFILE_SCOPE("UpdateGrassConstants");
+
+    MapHelper<GrassConstants> CBGrass(pCtx, pGrassConstants, MAP_WRITE, MAP_FLAG_DISCARD);
+
+    CBGrass->Time        = float4{static_cast<float>(m_CurrTime), m_Wind.IdleFrequency, m_Wind.IdleAmplitude, m_Wind.TimeScale};
+    CBGrass->Shape       = float4{m_Wind.BaseAmplitude, m_Wind.HeightScale, m_Wind.HeightGain, m_Wind.HeightBias};
+    CBGrass->Vertex      = float4{m_Wind.PhasePerVertex, m_Wind.TallBladeBoost, m_Wind.Tilt, TallBladeMinHeight};
+    CBGrass->Direction   = float4{std::cos(m_Wind.DirectionAngle), std::sin(m_Wind.DirectionAngle), m_Wind.NoiseScroll.x, m_Wind.NoiseScroll.y};
+    CBGrass->NoiseParams = float4{m_Wind.NoiseFrequency, m_Wind.NoiseStrength, m_Wind.NoisePhase, 0};
+    CBGrass->Debug       = float4{m_LODDebugView ? 1.f : 0.f, 0, 0, 0};
+    CBGrass->Trample     = m_TrampleMask.GetShaderParams(m_UseTrampleMask ? m_TrampleStrength : 0.f);
+    CBGrass->MeshScale   = m_GrassMesh.PosScale;
+}
 
+// #Un slot por contexto que graba pasto: sus constant buffers, su buffer de instancias
+// (matriz de mundo + bend de cada tuft) y los SRBs que los enlazan
+void Tutorial11_ResourceUpdates::CreateGrassRecordSlots(Uint32 MaxInstances)
+{
+    m_GrassSlots.clear();
+    m_GrassSlots.resize(1 + m_MaxWorkerThreads);
+    for (auto& Slot : m_GrassSlots)
     {
-        // Map the buffer and write current world-view-projection matrix
-        MapHelper<float4x4> CBConstants(m_pImmediateContext, m_VSConstants, MAP_WRITE, MAP_FLAG_DISCARD);
-        *CBConstants = WVPMatrix;
+        Slot.VSConstants.Initialize(m_pDevice, "Grass VS constants ring", GrassConstantRingSize);
+        // #Constantes del viento, se actualizan una vez por frame
+        CreateUniformBuffer(m_pDevice, sizeof(GrassConstants), "Grass constants CB", &Slot.GrassConstants);
+        GpuMemoryRegistry::Get().Track(Slot.GrassConstants, GpuMemoryRegistry::CATEGORY_CONSTANTS);
+
+        BufferDesc InstBuffDesc;
+        InstBuffDesc.Name = "Grass instance data buffer";
+        // #Dinamico para poder llenarlo desde un deferred context sin transiciones de estado
+        InstBuffDesc.Usage          = USAGE_DYNAMIC;
+        InstBuffDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
+        InstBuffDesc.BindFlags      = BIND_VERTEX_BUFFER;
+        InstBuffDesc.Size           = sizeof(GrassInstance) * MaxInstances;
+        GpuMemoryRegistry::Get().CreateBuffer(m_pDevice, InstBuffDesc, nullptr, GpuMemoryRegistry::CATEGORY_PER_INSTANCE, &Slot.InstanceBuffer);
+
+        for (auto& Instances : Slot.Instances)
+            Instances.reserve(MaxInstances);
+
+        // #Si los PSOs todavia se estan compilando, PollAsyncLoads crea los SRBs cuando llegan
+        if (m_pGrassPSO && m_pGrassInstPSO)
+            CreateGrassSRBs(Slot);
     }
 
-    DrawIndexedAttribs DrawAttrs;     // This is an indexed draw call
-    DrawAttrs.IndexType  = VT_UINT32; // Index type
-    DrawAttrs.NumIndices = 45;        // Updated for the new triangles (16 triangles * 3 vertices)
-    // Verify the state of vertex and index buffers
-    DrawAttrs.Flags = DRAW_FLAG_VERIFY_ALL;
-    m_pImmediateContext->DrawIndexed(DrawAttrs);
+    // #Los deferred contexts no pueden hacer transiciones de estado, asi que los recursos
+    // inmutables que usa el pasto se dejan en su estado final desde el principio
+    // clang-format off
+    StateTransitionDesc Barriers[] =
+    {
+        {m_CubeVertexBuffer[0], RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_VERTEX_BUFFER,   STATE_TRANSITION_FLAG_UPDATE_STATE},
+        {m_CubeIndexBuffer,     RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_INDEX_BUFFER,    STATE_TRANSITION_FLAG_UPDATE_STATE},
+        {m_TextureArray,        RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, STATE_TRANSITION_FLAG_UPDATE_STATE},
+        {m_WindNoiseTexture,    RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, STATE_TRANSITION_FLAG_UPDATE_STATE}
+    };
+    // clang-format on
+    m_pImmediateContext->TransitionResourceStates(_countof(Barriers), Barriers);
 }
 
-// #Matriz para facilitar la vista (antes la usaba para la camara que se movia pero eso se quito)
-static Diligent::float4x4 MakeViewMatrix(const Diligent::float3& eye,
-                                         const Diligent::float3& target,
-                                         const Diligent::float3& up)
+// #Los PSOs del pasto tienen su propio layout, asi que necesitan su propio SRB. Se vuelven a
+// crear cuando llegan los PSOs o cambia m_TextureArray
+void Tutorial11_ResourceUpdates::CreateGrassSRBs(GrassRecordSlot& Slot)
 {
-    using namespace Diligent;
-    float3 z = normalize(target - eye);
-    float3 x = normalize(cross(up, z));
-    float3 y = cross(z, x);
+    Slot.GrassSRB.Release();
+    Slot.GrassInstSRB.Release();
 
-    return float4x4{
-        x.x, y.x, z.x, 0,
-        x.y, y.y, z.y, 0,
-        x.z, y.z, z.z, 0,
-        -dot(x, eye),
-        -dot(y, eye),
-        -dot(z, eye),
-        1};
+    auto* pGrassTexSRV = m_TextureArray->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
+    m_pGrassPSO->CreateShaderResourceBinding(&Slot.GrassSRB, true);
+    m_pGrassInstPSO->CreateShaderResourceBinding(&Slot.GrassInstSRB, true);
+    for (auto* pSRB : {Slot.GrassSRB.RawPtr(), Slot.GrassInstSRB.RawPtr()})
+    {
+        pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_Texture")->Set(pGrassTexSRV);
+        pSRB->GetVariableByName(SHADER_TYPE_VERTEX, "Constants")->SetBufferRange(Slot.VSConstants.GetBuffer(), 0, sizeof(VSConstants));
+        pSRB->GetVariableByName(SHADER_TYPE_VERTEX, "GrassConstants")->Set(Slot.GrassConstants);
+    }
+    Slot.pConstantsVar     = Slot.GrassSRB->GetVariableByName(SHADER_TYPE_VERTEX, "Constants");
+    Slot.pInstConstantsVar = Slot.GrassInstSRB->GetVariableByName(SHADER_TYPE_VERTEX, "Constants");
 }
 
-// #Adicional para direccionar
-static Diligent::float2 DirAwayFrom(const Diligent::float3& player,
-                                    const Diligent::float3& tuft)
+// #(Re)crea el campo con m_FieldConfig y todo lo que depende de la cantidad de tufts
+void Tutorial11_ResourceUpdates::InitializeGrassField()
 {
-    float dx = tuft.x - player.x;
-    float dz = tuft.z - player.z;
-    float d2 = dx * dx + dz * dz;
-    if (d2 < 1e-6f)
-        return {0, 0};
-    float invLen = 1.0f / std::sqrt(d2);
-    return {dx * invLen, dz * invLen};
-}
+    // #Todo lo que se guarda por tuft residente cuenta para el presupuesto del campo, incluidos
+    // los buffers de instancias y las listas por LOD de cada slot de grabacion
+    m_FieldConfig.ExtraBytesPerTuft = static_cast<Uint32>(sizeof(Uint8) + GrassDeformation::BytesPerTuft + 2 * sizeof(float) +
+                                                          (1 + m_MaxWorkerThreads) * (1 + GrassNumLODs) * sizeof(GrassInstance) +
+                                                          (m_GpuCullingSupported ? GrassGpuCulling::BytesPerTuft : 0));
+
+    m_GrassField.Initialize(m_FieldConfig);
+    m_GrassField.LoadAround(m_PlayerX, m_PlayerZ);
+    m_TuftLOD.assign(m_GrassField.GetTuftCapacity(), 0);
+    m_GrassDeform.Initialize(m_GrassField);
+    ResetSimSnapshots();
+    m_VisibleChunks.clear();
+    m_ChunkBaker.Reset();
+
+    CreateGrassRecordSlots(m_GrassField.GetTuftCapacity());
+
+    if (m_GpuCullingSupported)
+    {
+        GrassGpuCulling::LODRange LODs[GrassNumLODs];
+        for (Uint32 LOD = 0; LOD < GrassNumLODs; ++LOD)
+            LODs[LOD] = {GrassLODs[LOD].FirstIndex, GrassLODs[LOD].NumIndices};
+        m_GpuCulling.Initialize(m_pDevice, m_GrassField.GetTuftCapacity(), LODs, m_pSwapChain->GetDesc().BufferCount);
+        m_GpuCullTuftsDirty = true;
+    }
 
+    const auto& Stats = m_GrassField.GetPagingStats();
+    LOG_INFO_MESSAGE("Grass field: ", Stats.TotalTufts, " tufts in ", Stats.TotalChunks, " chunks, up to ",
+                     Stats.MaxResidentChunks, " resident chunks (", m_FieldConfig.MemoryBudgetMB, " MB budget)");
+}
 
-void Tutorial11_ResourceUpdates::Render()
+void Tutorial11_ResourceUpdates::ModifyEngineInitInfo(const ModifyEngineInitInfoAttribs& Attribs)
 {
-    auto*  pRTV       = m_pSwapChain->GetCurrentBackBufferRTV();
-    auto*  pDSV       = m_pSwapChain->GetDepthBufferDSV();
-    float4 ClearColor = {0.35f, 0.35f, 0.35f, 1.0f};
-    if (m_ConvertPSOutputToGamma)
-        ClearColor = LinearToSRGB(ClearColor);
-    m_pImmediateContext->ClearRenderTarget(pRTV, ClearColor.Data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-    m_pImmediateContext->ClearDepthStencil(pDSV, CLEAR_DEPTH_FLAG, 1.f, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    SampleBase::ModifyEngineInitInfo(Attribs);
 
-    m_pImmediateContext->SetPipelineState(m_pPSO);
+    // #Un deferred context por cada hilo que puede grabar pasto, al menos 2. hardware_concurrency()
+    // puede devolver 0, asi que no se le resta nada antes del max
+    Attribs.EngineCI.NumDeferredContexts = std::max(std::thread::hardware_concurrency(), 3u) - 1;
 
-    // #CVariables varias, para camara, movimiento, tracking, etc
-    auto SrfPre = GetSurfacePretransformMatrix({0, 0, 1});
-    auto Proj   = GetAdjustedProjectionMatrix(PI_F / 5.f, 0.1f, 200.f);
+    // #Para medir cada pasada en la GPU; si el dispositivo no las tiene solo se pierden esas columnas
+    Attribs.EngineCI.Features.TimestampQueries          = DEVICE_FEATURE_STATE_OPTIONAL;
+    Attribs.EngineCI.Features.PipelineStatisticsQueries = DEVICE_FEATURE_STATE_OPTIONAL;
+#if VULKAN_SUPPORTED
+    if (Attribs.DeviceType == RENDER_DEVICE_TYPE_VULKAN)
+    {
+        // #Cada contexto mapea su buffer de instancias (todo el campo) con DISCARD cada frame
+        auto& EngineVkCI               = static_cast<EngineVkCreateInfo&>(Attribs.EngineCI);
+        EngineVkCI.DynamicHeapSize     = 64 << 20;
+        EngineVkCI.DynamicHeapPageSize = 1 << 20;
+    }
+#endif
+}
 
-    constexpr float DEG2RAD = PI_F / 180.f;
-    float           pitch   = -42.f * DEG2RAD;
-    float           yaw     = 180.f * DEG2RAD;
-    float3          eye     = {0.f, 29.f, 32.f};
+Tutorial11_ResourceUpdates::~Tutorial11_ResourceUpdates()
+{
+    Shutdown();
+}
 
-    float  cp = std::cos(pitch), sp = std::sin(pitch);
-    float  cy = std::cos(yaw), sy = std::sin(yaw);
-    float3 fwd = {sy * cp, sp, cy * cp};
+void Tutorial11_ResourceUpdates::Shutdown()
+{
+    if (m_IsShutDown)
+        return;
+    m_IsShutDown = true;
 
-    auto View     = MakeViewMatrix(eye, eye + fwd, {0, 1, 0});
-    auto ViewProj = SrfPre * View * Proj;
+    StopSimulationThread();
 
+    // #Las tareas del arranque escriben en m_Startup
+    if (m_Startup)
+    {
+        for (auto& pTask : m_Startup->Tasks)
+        {
+            if (pTask)
+                pTask->WaitForCompletion();
+        }
+        m_Startup.reset();
+    }
+    StopWorkerThreads();
+    m_GrassField.StopLoader();
+    // #Soltar el pool espera a sus hilos
+    m_pThreadPool.Release();
+    m_FrameCapture.Stop(m_pImmediateContext);
 
-    constexpr int   GRID = 50;
-    constexpr float STEP = 1.4f;
-    constexpr float HALF = STEP * (GRID - 1) * 0.5f;
+    // #Ya no queda ningun hilo del sample grabando eventos
+    CpuProfiler::Get().EndFrame();
 
-    constexpr float RADIUS   = 3.4f;  
-    constexpr float MAX_BEND = 0.45f; 
+    if (m_pImmediateContext)
+    {
+        m_pImmediateContext->Flush();
+        m_pImmediateContext->WaitForIdle();
+    }
 
-    m_pImmediateContext->SetPipelineState(m_pPSO_NoCull);
-    float4x4 GroundWorld = float4x4::Identity();
-    DrawGroundPlane(GroundWorld * ViewProj, m_SRBs[1]);
+    // #Recursos de GPU del sample. En el destructor se soltarian igual, pero FinishBenchmark() sale
+    // con std::exit, que no destruye el sample
+    m_CmdListPtrs.clear();
+    m_GrassSlots.clear();
+    m_GpuCulling = GrassGpuCulling{};
+    m_ChunkBaker.Reset();
+    m_TrampleMask    = TrampleMask{};
+    m_GpuQueries     = GpuPassQueries{};
+    m_FramePacer     = FramePacer{};
+    m_SceneConstants = TransientConstantRing{};
+    m_SceneSRB.Release();
+    m_AgentSRB.Release();
+    m_pPSO.Release();
+    m_pPSO_NoCull.Release();
+    m_pAgentPSO.Release();
+    m_pGrassPSO.Release();
+    m_pGrassInstPSO.Release();
+    for (auto& pBuffer : m_CubeVertexBuffer)
+        pBuffer.Release();
+    m_CubeIndexBuffer.Release();
+    m_TextureUpdateBuffer.Release();
+    m_GroundPlaneVertexBuffer.Release();
+    m_GroundPlaneIndexBuffer.Release();
+    m_PlayerCubeVertexBuffer.Release();
+    m_PlayerCubeIndexBuffer.Release();
+    m_AgentInstanceBuffer.Release();
+    m_TextureArray.Release();
+    m_WindNoiseTexture.Release();
+    m_pDeferredContexts.clear();
+
+    // #El registro es global y no tiene que sobrevivir al device con weak pointers a sus recursos
+    GpuMemoryRegistry::Get().Reset();
+}
 
-    float3 vel    = m_PlayerVel;
-    float  velLen = std::sqrt(vel.x * vel.x + vel.z * vel.z);
-    if (velLen > 1e-4f)
-        vel /= velLen;
+void Tutorial11_ResourceUpdates::StartWorkerThreads(Uint32 NumThreads)
+{
+    m_WorkerThreads.resize(NumThreads);
+    m_GrassBands.resize(NumThreads);
+    m_CmdLists.resize(NumThreads);
+    for (Uint32 t = 0; t < m_WorkerThreads.size(); ++t)
+    {
+        m_WorkerThreads[t] = std::thread(GrassWorkerThreadFunc, this, t);
+    }
+}
 
-    const float VELOCITY_INFLUENCE = 2.0f;
-    const float POSITION_INFLUENCE = 4.5f;
+void Tutorial11_ResourceUpdates::StopWorkerThreads()
+{
+    m_RecordGrassSignal.Trigger(true, -1);
 
-    // #Generacion del grid de pasto
-    for (int gz = 0; gz < GRID; ++gz)
+    for (auto& thread : m_WorkerThreads)
+    {
+        thread.join();
+    }
+    m_RecordGrassSignal.Reset();
+    m_WorkerThreads.clear();
+    m_GrassBands.clear();
+    m_CmdLists.clear();
+}
+
+void Tutorial11_ResourceUpdates::GrassWorkerThreadFunc(Tutorial11_ResourceUpdates* pThis, Uint32 ThreadNum)
+{
+    // Every thread should use its own deferred context
+    IDeviceContext* pDeferredCtx     = pThis->m_pDeferredContexts[ThreadNum];
+    const int       NumWorkerThreads = static_cast<int>(pThis->m_WorkerThreads.size());
+
+    const std::string ThreadName = "Grass worker " + std::to_string(ThreadNum);
+    CpuProfiler::SetThreadName(ThreadName.c_str());
+    for (;;)
     {
-        for (int gx = 0; gx < GRID; ++gx)
+        // Wait for the signal
+        auto SignaledValue = pThis->m_RecordGrassSignal.Wait(true, NumWorkerThreads);
+        if (SignaledValue < 0)
+            return;
+
+        pDeferredCtx->Begin(0);
+
+        // #Graba la banda de chunks de este hilo con su propio slot
+        const auto& Band = pThis->m_GrassBands[ThreadNum];
+        pThis->RecordGrassBand(pDeferredCtx, pThis->m_GrassSlots[1 + ThreadNum], Band.first, Band.second);
+
+        // Finish command list
+        RefCntAutoPtr<ICommandList> pCmdList;
+        pDeferredCtx->FinishCommandList(&pCmdList);
+        pThis->m_CmdLists[ThreadNum] = pCmdList;
+
         {
-            float xPos = -HALF + gx * STEP;
-            float zPos = -HALF + gz * STEP;
+            std::lock_guard<std::mutex> Lock{pThis->m_NumThreadsCompletedMtx};
+            // Increment the number of completed threads
+            ++pThis->m_NumThreadsCompleted;
+            if (pThis->m_NumThreadsCompleted == NumWorkerThreads)
+                pThis->m_ExecuteCommandListsSignal.Trigger();
+        }
 
-            float dx = xPos - m_PlayerX;
-            float dz = zPos - m_PlayerZ;
-            float d2 = dx * dx + dz * dz;
+        pThis->m_GotoNextFrameSignal.Wait(true, NumWorkerThreads);
+
+        // Call FinishFrame() to release dynamic resources allocated by deferred contexts
+        // IMPORTANT: we must wait until the command lists are submitted for execution
+        //            because FinishFrame() invalidates all dynamic resources.
+        // IMPORTANT: In Metal backend FinishFrame must be called from the same
+        //            thread that issued rendering commands.
+        pDeferredCtx->FinishFrame();
+
+        ++pThis->m_NumThreadsReady;
+        // We must wait until all threads reach this point, because
+        // m_GotoNextFrameSignal must be unsignaled before we proceed to
+        // m_RecordGrassSignal to avoid one thread going through the loop twice in
+        // a row.
+        while (pThis->m_NumThreadsReady < NumWorkerThreads)
+            std::this_thread::yield();
+        VERIFY_EXPR(!pThis->m_GotoNextFrameSignal.IsTriggered());
+    }
+}
 
-            float bendX = 0.f, bendZ = 0.f;
+void Tutorial11_ResourceUpdates::Initialize(const SampleInitInfo& InitInfo)
+{
+    m_StartupStart = std::chrono::high_resolution_clock::now();
+    SampleBase::Initialize(InitInfo);
 
-            if (d2 < RADIUS * RADIUS)
-            {
-                float dist = std::sqrt(d2);
-                float w    = 1.f - dist / RADIUS;
-                w          = w * w; 
+    CpuProfiler::SetThreadName("Main");
+
+    // #Cada buffer dinamico cuenta una copia por back buffer, lo que puede ir la GPU detras del CPU
+    GpuMemoryRegistry::Get().SetDynamicCopies(m_pSwapChain->GetDesc().BufferCount);
+
+    // #Los PSOs del pasto necesitan la textura de ruido, que es chica y se genera aqui. Todo lo
+    // demas que tarda se carga en segundo plano mientras se crea el resto
+    CreateWindNoiseTexture();
+    m_TrampleMask.Initialize(m_pDevice, TrampleMask::Config{});
+    m_TrampleBufferUploads = TrampleMask::SupportsBufferUploads(m_pDevice);
+    m_GpuCullingSupported = GrassGpuCulling::IsSupported(m_pDevice);
+    m_UseGpuCulling       = m_UseGpuCulling && m_GpuCullingSupported;
+    // #El input layout de los PSOs depende del formato de las mallas
+    BuildMeshes();
+    StartAsyncLoads();
+
+    // #Los chunks lejanos se hornean con la tarjeta del LOD 2, hasta 8 nuevos por frame
+    m_ChunkBaker.Initialize(m_pDevice, m_GrassMesh, GrassLODs[GrassNumLODs - 1], 512, 8);
+
+    // #Las matrices del piso, del jugador y de los chunks horneados salen de un ring de constantes
+    // (ver TransientConstantRing)
+    m_SceneConstants.Initialize(m_pDevice, "Scene VS constants ring", 128 << 10);
+    CreatePlaceholderTexture();
+    CreateVertexBuffers();
+    CreateIndexBuffer();
+    //# Crea el jugador y piso
+    CreatePlayerCube();
+    CreateGroundPlane();
 
-                float inv = dist > 1e-4f ? 1.f / dist : 0.f;
-                float ux  = dx * inv;
-                float uz  = dz * inv;
+    // #La GPU puede ir hasta un frame por cada back buffer detras del CPU
+    m_GpuQueries.Initialize(m_pDevice, m_pSwapChain->GetDesc().BufferCount);
+    m_FramePacer.Initialize(m_pDevice);
+    m_FramePacer.SetMeasureLatency(m_LatencyMode);
 
-                // #Bend dependiendo de la pos
-                float posBendX = uz * MAX_BEND * w * POSITION_INFLUENCE;
-                float posBendZ = -ux * MAX_BEND * w * POSITION_INFLUENCE;
+    if (!m_CapturePath.empty())
+    {
+        m_CaptureConfig.Directory = m_CapturePath;
+        m_CaptureConfig.Format    = m_CaptureFormat == "raw" ? FrameCapture::FORMAT_RAW : FrameCapture::FORMAT_PNG;
+        m_FrameCapture.Start(m_pDevice, m_CaptureConfig);
+    }
 
-                // #Velocidad
-                float velBendX = -vel.z * MAX_BEND * w * VELOCITY_INFLUENCE;
-                float velBendZ = vel.x * MAX_BEND * w * VELOCITY_INFLUENCE;
+    {
+        BufferDesc VertBuffDesc;
+        VertBuffDesc.Name           = "Texture update buffer";
+        VertBuffDesc.Usage          = USAGE_DYNAMIC;
+        VertBuffDesc.BindFlags      = BIND_VERTEX_BUFFER; // We do not really bind the buffer, but D3D11 wants at least one bind flag bit
+        VertBuffDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
+        VertBuffDesc.Size           = MaxUpdateRegionSize * MaxUpdateRegionSize * 4;
+        GpuMemoryRegistry::Get().CreateBuffer(m_pDevice, VertBuffDesc, nullptr, GpuMemoryRegistry::CATEGORY_STAGING, &m_TextureUpdateBuffer);
+    }
+    m_LastTramplePos = float2{m_PlayerX, m_PlayerZ};
 
-                bendX = posBendX + velBendX;
-                bendZ = posBendZ + velBendZ;
-            }
+    m_MaxWorkerThreads = static_cast<Uint32>(m_pDeferredContexts.size());
+    m_NumWorkerThreads = static_cast<int>(std::min(4u, m_MaxWorkerThreads));
+    m_GrassCPUTimeByThreads.assign(m_MaxWorkerThreads + 1, -1.0);
 
-            float4x4 World = float4x4::RotationX(bendX) *
-                float4x4::RotationZ(bendZ) *
-                float4x4::Translation(xPos, 0.f, zPos);
+    InitializeGrassField();
 
-            DrawCube(World * ViewProj,
-                     m_CubeVertexBuffer[2],
-                     m_SRBs[1]);
+    // #Se elige el mejor kernel de bend que soporte el CPU y se compara contra la version
+    // escalar, con el jugador en medio del campo y moviendose en diagonal
+    m_BendKernel = GetBestGrassBendKernel();
+    {
+        GrassBendParams TestParams;
+        TestParams.PlayerX = 0.3f;
+        TestParams.PlayerZ = -0.7f;
+        TestParams.VelDirX = 0.6f;
+        TestParams.VelDirZ = 0.8f;
+
+        const float MaxDiff = ValidateGrassBendKernel(m_BendKernel, TestParams, m_GrassField.GetTuftX(), m_GrassField.GetTuftZ(), m_GrassField.GetTuftCapacity());
+        if (MaxDiff > 1e-4f)
+        {
+            LOG_WARNING_MESSAGE("Grass bend kernel ", GetGrassBendKernelName(m_BendKernel), " differs from the scalar version by ", MaxDiff, ". Falling back to the scalar kernel.");
+            m_BendKernel = GrassBendKernel::Scalar;
+        }
+        else
+        {
+            LOG_INFO_MESSAGE("Grass bend kernel: ", GetGrassBendKernelName(m_BendKernel), " (max error vs scalar: ", MaxDiff, ")");
         }
     }
 
-    float4x4 PlayerWorld = float4x4::Translation(m_PlayerX, 1.0f, m_PlayerZ);
-    PlayerWorld *= float4x4::Scale(1.5f, 1.5f, 1.5f);
-    DrawPlayerCube(PlayerWorld * ViewProj, m_SRBs[0]);
+    if (m_BenchmarkFrames > 0)
+    {
+        if (m_BenchmarkWorkers >= 0)
+            m_NumWorkerThreads = std::min(m_BenchmarkWorkers, static_cast<int>(m_MaxWorkerThreads));
+        m_BenchmarkPath.Initialize(m_BenchmarkSeed, m_GrassField.GetHalfSize() * 0.8f);
+        m_BenchmarkRecorder.Reset(m_BenchmarkFrames, m_BenchmarkWarmup);
+        // #El primer frame con culling en la GPU (en el warm-up) se compara contra el CPU
+        m_ValidateGpuCulling = m_UseGpuCulling;
+        LOG_INFO_MESSAGE("Running benchmark: ", m_BenchmarkFrames, " frames (+", m_BenchmarkWarmup, " warm-up), seed ", m_BenchmarkSeed);
+    }
+    ResetAgents();
+    StartWorkerThreads(m_NumWorkerThreads);
+
+    m_NumPoolThreads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    ThreadPoolCreateInfo PoolCI;
+    PoolCI.NumThreads = m_NumPoolThreads;
+    m_pThreadPool     = CreateThreadPool(PoolCI);
+    StartSimulationThread();
+
+    // #El benchmark tiene que medir siempre la escena completa
+    if (m_BenchmarkFrames > 0)
+        PollAsyncLoads(true);
+
+    m_StartupInitMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - m_StartupStart).count();
+    LOG_INFO_MESSAGE("Startup: Initialize() took ", std::fixed, std::setprecision(1), m_StartupInitMs, " ms");
 }
 
-void Tutorial11_ResourceUpdates::UpdateBuffer(Diligent::Uint32 BufferIndex)
+// #Todo lo que tarda en cargar va a un thread pool propio: cada PSO con sus shaders y la
+// decodificacion de cada grassN.png; la ultima imagen en terminar crea el texture array. El pool
+// es aparte para que las tareas de GrassDeformation no queden en cola detras de una compilacion
+void Tutorial11_ResourceUpdates::StartAsyncLoads()
 {
-    Uint32 NumVertsToUpdate  = std::uniform_int_distribution<Uint32>{2, 5}(m_gen);
-    Uint32 FirstVertToUpdate = std::uniform_int_distribution<Uint32>{0, static_cast<Uint32>(28) - NumVertsToUpdate}(m_gen);
-    Vertex Vertices[28];
-    for (Uint32 v = 0; v < NumVertsToUpdate; ++v)
+    m_Startup.reset(new StartupLoads);
+    auto& Loads = *m_Startup;
+    Loads.Phases[STARTUP_PHASE_SCENE_PSO].Name      = "Scene PSOs";
+    Loads.Phases[STARTUP_PHASE_GRASS_PSO].Name      = "Grass PSO";
+    Loads.Phases[STARTUP_PHASE_GRASS_INST_PSO].Name = "Grass instanced PSO";
+    Loads.Phases[STARTUP_PHASE_GRASS_CULL_PSO].Name = "Grass cull PSO";
+    for (Uint32 i = 0; i < NumTextures; ++i)
+        Loads.Phases[STARTUP_PHASE_DECODE_TEXTURE + i].Name = "Decode grass" + std::to_string(i) + ".png";
+    Loads.Phases[STARTUP_PHASE_TEXTURE_ARRAY].Name = "Texture array";
+
+    // #En OpenGL el contexto es de un solo hilo: ahi solo la decodificacion va al pool y los PSOs
+    // y el array se crean en el hilo principal
+    Loads.DeviceOnMainThread = m_pDevice->GetDeviceInfo().IsGLDevice();
+
+    ThreadPoolCreateInfo PoolCI;
+    PoolCI.NumThreads = std::min(std::max(std::thread::hardware_concurrency(), 2u) - 1, Uint32{STARTUP_PHASE_TEXTURE_ARRAY});
+    Loads.pThreadPool = CreateThreadPool(PoolCI);
+
+    // #"off" compila todo como antes; sin --shader_cache se usa un archivo por backend y por gamma
+    const auto CachePath = m_ShaderCachePath.empty() ? ShaderStateCache::GetCachePath(m_pDevice->GetDeviceInfo().Type, m_ConvertPSOutputToGamma) : m_ShaderCachePath;
+    m_ShaderCache.Initialize(m_pDevice, CachePath != "off" ? CachePath : "");
+
+    const auto SCDesc = m_pSwapChain->GetDesc();
+    for (Uint32 Phase = STARTUP_PHASE_SCENE_PSO; Phase <= STARTUP_PHASE_GRASS_CULL_PSO; ++Phase)
     {
-        auto        SrcInd  = FirstVertToUpdate + v;
-        const auto& SrcVert = CubeVerts[SrcInd];
-        Vertices[v].UV      = SrcVert.UV;
-        Vertices[v].Pos     = SrcVert.Pos * static_cast<float>(1 + 0.2 * sin(m_CurrTime * (1.0 + SrcInd * 0.2)));
+        // #Sin compute shaders o draws indirectos el culling queda en el CPU
+        if (Phase == STARTUP_PHASE_GRASS_CULL_PSO && !m_GpuCullingSupported)
+            continue;
+        if (Loads.DeviceOnMainThread)
+        {
+            RunStartupPhase(Phase, [&]() { CreatePipelineStates(Phase, SCDesc, Loads); });
+            continue;
+        }
+        Loads.Tasks[Phase] = EnqueueAsyncWork(Loads.pThreadPool,
+                                              [this, Phase, SCDesc, &Loads](Uint32 /*ThreadId*/) {
+                                                  RunStartupPhase(Phase, [&]() { CreatePipelineStates(Phase, SCDesc, Loads); });
+                                                  return ASYNC_TASK_STATUS_COMPLETE;
+                                              });
+    }
+
+    for (Uint32 i = 0; i < NumTextures; ++i)
+    {
+        Loads.Tasks[STARTUP_PHASE_DECODE_TEXTURE + i] =
+            EnqueueAsyncWork(Loads.pThreadPool,
+                             [this, i, &Loads](Uint32 /*ThreadId*/) {
+                                 RunStartupPhase(STARTUP_PHASE_DECODE_TEXTURE + i, [&]() { Loads.Loaders[i] = DecodeGrassTexture(i); });
+                                 if (Loads.NumDecoded.fetch_add(1) + 1 == NumTextures && !Loads.DeviceOnMainThread)
+                                     RunStartupPhase(STARTUP_PHASE_TEXTURE_ARRAY, [&]() { Loads.pTextureArray = CreateTextureArray(Loads.Loaders); });
+                                 return ASYNC_TASK_STATUS_COMPLETE;
+                             });
     }
-    m_pImmediateContext->UpdateBuffer(
-        m_CubeVertexBuffer[BufferIndex],    // Device context to use for the operation
-        FirstVertToUpdate * sizeof(Vertex), // Start offset in bytes
-        NumVertsToUpdate * sizeof(Vertex),  // Data size in bytes
-        Vertices,                           // Data pointer
-        RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 }
 
-// #FUncion para calcular la velocidad y tener informacion relevante
-void Tutorial11_ResourceUpdates::UpdatePlayerVelocity(float dt)
+void Tutorial11_ResourceUpdates::RunStartupPhase(Uint32 Phase, const std::function<void()>& Job)
 {
-    float vx = (m_PlayerX - m_PrevPlayerX) / dt;
-    float vz = (m_PlayerZ - m_PrevPlayerZ) / dt;
+    GRASS_PROFILE_SCOPE("StartupPhase");
 
-    const float SMOOTH = 10.0f; 
+    auto& Info   = m_Startup->Phases[Phase];
+    Info.StartMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - m_StartupStart).count();
+    Job();
+    Info.EndMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - m_StartupStart).count();
+}
 
-    const float threshold = 0.2f;
-    if (std::abs(vx) > threshold || std::abs(vz) > threshold)
+// #Instala lo que ya termino de cargar. Corre en el hilo principal al principio de Update(),
+// cuando ningun worker esta grabando pasto. Con Wait = true espera a que termine todo
+void Tutorial11_ResourceUpdates::PollAsyncLoads(bool Wait)
+{
+    if (!m_Startup)
+        return;
+
+    GRASS_PROFILE_SCOPE("PollAsyncLoads");
+
+    auto&      Loads      = *m_Startup;
+    const auto IsFinished = [&](Uint32 Phase) {
+        const auto& pTask = Loads.Tasks[Phase];
+        if (pTask && Wait)
+            pTask->WaitForCompletion();
+        return !pTask || pTask->IsFinished();
+    };
+
+    if (!Loads.SceneInstalled && IsFinished(STARTUP_PHASE_SCENE_PSO))
     {
-        m_PlayerVel.x = vx * 0.7f + m_PlayerVel.x * 0.3f;
-        m_PlayerVel.z = vz * 0.7f + m_PlayerVel.z * 0.3f;
+        m_pPSO        = Loads.pPSO;
+        m_pPSO_NoCull = Loads.pPSO_NoCull;
+        m_pAgentPSO   = Loads.pAgentPSO;
+        if (m_pPSO)
+            CreateSceneSRB();
+        Loads.SceneInstalled = true;
     }
-    else
+
+    if (!Loads.GrassInstalled && IsFinished(STARTUP_PHASE_GRASS_PSO) && IsFinished(STARTUP_PHASE_GRASS_INST_PSO))
     {
-        m_PlayerVel.x += (vx - m_PlayerVel.x) * (1.f - expf(-SMOOTH * dt));
-        m_PlayerVel.z += (vz - m_PlayerVel.z) * (1.f - expf(-SMOOTH * dt));
+        m_pGrassPSO     = Loads.pGrassPSO;
+        m_pGrassInstPSO = Loads.pGrassInstPSO;
+        if (m_pGrassPSO && m_pGrassInstPSO)
+        {
+            for (auto& Slot : m_GrassSlots)
+                CreateGrassSRBs(Slot);
+        }
+        Loads.GrassInstalled = true;
     }
 
-    if (std::abs(vx) < 0.01f && std::abs(vz) < 0.01f)
+    if (!Loads.CullInstalled && IsFinished(STARTUP_PHASE_GRASS_CULL_PSO))
     {
-        m_PlayerVel.x *= 0.85f;
-        m_PlayerVel.z *= 0.85f;
+        if (Loads.pGrassCullPSO)
+            m_GpuCulling.SetPipelineState(Loads.pGrassCullPSO);
+        Loads.CullInstalled = true;
+    }
+
+    if (!Loads.TexturesInstalled)
+    {
+        bool Decoded = true;
+        for (Uint32 i = 0; i < NumTextures; ++i)
+            Decoded = IsFinished(STARTUP_PHASE_DECODE_TEXTURE + i) && Decoded;
+
+        if (Decoded)
+        {
+            if (Loads.DeviceOnMainThread)
+                RunStartupPhase(STARTUP_PHASE_TEXTURE_ARRAY, [&]() { Loads.pTextureArray = CreateTextureArray(Loads.Loaders); });
+
+            if (Loads.pTextureArray)
+            {
+                m_TextureArray = Loads.pTextureArray;
+                // #Los deferred contexts no hacen transiciones (ver CreateGrassRecordSlots)
+                StateTransitionDesc Barrier{m_TextureArray, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, STATE_TRANSITION_FLAG_UPDATE_STATE};
+                m_pImmediateContext->TransitionResourceStates(1, &Barrier);
+
+                if (m_pPSO)
+                    CreateSceneSRB();
+                if (m_pGrassPSO && m_pGrassInstPSO)
+                {
+                    for (auto& Slot : m_GrassSlots)
+                        CreateGrassSRBs(Slot);
+                }
+            }
+            else
+            {
+                LOG_ERROR_MESSAGE("Failed to create the grass texture array. The placeholder texture will be used instead.");
+            }
+            Loads.TexturesInstalled = true;
+        }
+    }
+
+    if (!Loads.SceneInstalled || !Loads.GrassInstalled || !Loads.CullInstalled || !Loads.TexturesInstalled)
+        return;
+
+    // #Las fases se solapan, asi que su suma es lo que costaria cargar todo en serie
+    m_StartupLoadedMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - m_StartupStart).count();
+    double SumMs = 0;
+    for (const auto& Phase : Loads.Phases)
+    {
+        if (Phase.EndMs < 0)
+            continue;
+        SumMs += Phase.EndMs - Phase.StartMs;
+        LOG_INFO_MESSAGE("Startup phase '", Phase.Name, "': ", std::fixed, std::setprecision(1), Phase.StartMs, " - ", Phase.EndMs,
+                         " ms (", Phase.EndMs - Phase.StartMs, " ms)");
+    }
+    LOG_INFO_MESSAGE("Startup: all assets installed after ", std::fixed, std::setprecision(1), m_StartupLoadedMs, " ms (",
+                     SumMs, " ms of loads if run serially)");
+
+    if (m_ShaderCache.IsEnabled())
+    {
+        // #Una fase sin fallos no compilo nada; lo que se ahorro es lo que tardo la ultima vez que
+        // si compilo. Las fases corren en paralelo, asi que es tiempo de CPU, no de espera
+        Uint32 Hits = 0, Misses = 0;
+        double SavedMs = 0;
+        for (Uint32 p = STARTUP_PHASE_SCENE_PSO; p <= STARTUP_PHASE_GRASS_CULL_PSO; ++p)
+        {
+            const auto& Phase = Loads.Phases[p];
+            if (Phase.EndMs < 0)
+                continue; // #La fase no corrio (p. ej. no hay compute shaders)
+            const double DurationMs = Phase.EndMs - Phase.StartMs;
+            Hits += Phase.CacheHits;
+            Misses += Phase.CacheMisses;
+            if (Phase.CacheMisses == 0)
+            {
+                const double ColdMs = m_ShaderCache.GetColdTimeMs(Phase.Name);
+                if (ColdMs >= 0)
+                    SavedMs += std::max(ColdMs - DurationMs, 0.0);
+            }
+            else if (Phase.CacheHits == 0)
+            {
+                m_ShaderCache.SetColdTimeMs(Phase.Name, DurationMs);
+            }
+        }
+        m_ShaderCacheHits    = Hits;
+        m_ShaderCacheMisses  = Misses;
+        m_ShaderCacheSavedMs = SavedMs;
+        LOG_INFO_MESSAGE("Shader cache ", m_ShaderCache.GetPath(), ": ", Hits, " hits, ", Misses, " misses, ", std::fixed, std::setprecision(1),
+                         SavedMs, " ms of compilation saved");
+
+        if (Misses > 0 && !m_ShaderCache.Save())
+            LOG_WARNING_MESSAGE("Failed to write shader cache ", m_ShaderCache.GetPath());
+    }
+
+    m_Startup.reset();
+}
+
+// #Los recursos del pasto ya estan en el estado correcto (ver CreateGrassRecordSlots), asi que
+// todo se verifica en vez de hacer transiciones; asi funciona igual en los deferred contexts.
+// Las constantes del tuft ya estan en el ring, en ConstantsOffset
+void Tutorial11_ResourceUpdates::DrawCube(IDeviceContext* pCtx, GrassRecordSlot& Slot, Uint32 ConstantsOffset, Uint32 LOD)
+{
+    GRASS_PROFILE_SCOPE("DrawCube");
+
+    Slot.pConstantsVar->SetBufferOffset(ConstantsOffset);
+    pCtx->CommitShaderResources(Slot.GrassSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+
+    DrawIndexedAttribs DrawAttrs;                             // This is an indexed draw call
+    DrawAttrs.IndexType          = m_GrassMesh.IndexType;     // Index type
+    DrawAttrs.NumIndices         = GrassLODs[LOD].NumIndices; // #Rango de indices del LOD elegido
+    DrawAttrs.FirstIndexLocation = GrassLODs[LOD].FirstIndex;
+    // Verify the state of vertex and index buffers
+    DrawAttrs.Flags = DRAW_FLAG_VERIFY_ALL;
+    pCtx->DrawIndexed(DrawAttrs);
+
+    auto& Stats = Slot.Stats[LOD];
+    ++Stats.Draws;
+    ++Stats.Tufts;
+    Stats.Triangles += GrassLODs[LOD].NumIndices / 3;
+}
+
+// #Un draw por tuft de Slot.Instances. Las constantes de todos los tufts se escriben con un solo
+// Map() por bloque que cabe en el ring, en vez de un Map con DISCARD por draw
+void Tutorial11_ResourceUpdates::DrawGrassCubes(IDeviceContext* pCtx, GrassRecordSlot& Slot, IBuffer* pVertexBuffer)
+{
+    GRASS_PROFILE_SCOPE("DrawGrassCubes");
+
+    // Bind vertex buffer
+    IBuffer* pBuffs[] = {pVertexBuffer};
+    pCtx->SetVertexBuffers(0, 1, pBuffs, nullptr, RESOURCE_STATE_TRANSITION_MODE_VERIFY, SET_VERTEX_BUFFERS_FLAG_RESET);
+    pCtx->SetIndexBuffer(m_CubeIndexBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+
+    auto&        Ring      = Slot.VSConstants;
+    const Uint32 Stride    = AlignUp(static_cast<Uint32>(sizeof(VSConstants)), Ring.GetAlignment());
+    const Uint32 BatchSize = Ring.GetCapacity() / Stride;
+    for (Uint32 LOD = 0; LOD < GrassNumLODs; ++LOD)
+    {
+        const auto& Instances = Slot.Instances[LOD];
+        for (size_t First = 0; First < Instances.size(); First += BatchSize)
+        {
+            const auto NumDraws = static_cast<Uint32>(std::min<size_t>(BatchSize, Instances.size() - First));
+
+            Uint32 BaseOffset = 0;
+            auto*  pData      = static_cast<Uint8*>(Ring.Map(pCtx, Stride * NumDraws, BaseOffset));
+            for (Uint32 i = 0; i < NumDraws; ++i)
+            {
+                const auto& World    = Instances[First + i].World;
+                auto&       CBConsts = *reinterpret_cast<VSConstants*>(pData + Stride * i);
+                CBConsts.WorldViewProj = World * m_GrassFrame.ViewProj;
+                // #La fila de traslacion de World es la posicion del tuft
+                CBConsts.TuftOrigin = float4{World.m[3][0], 0.f, World.m[3][2], static_cast<float>(LOD)};
+                CBConsts.DrawParams = float4{Instances[First + i].Bend.w, 0, 0, 0};
+            }
+            Ring.Unmap(pCtx);
+            Slot.UploadBytes += sizeof(VSConstants) * NumDraws;
+
+            for (Uint32 i = 0; i < NumDraws; ++i)
+                DrawCube(pCtx, Slot, BaseOffset + Stride * i, LOD);
+        }
     }
 }
 
-// #Mapea el buffer dinamico y actualiza las posiciones de los vertices
-constexpr float kIdleF = 1.7f;  
-constexpr float kIdleA  = 1.35f; 
-void Tutorial11_ResourceUpdates::MapDynamicBuffer(Diligent::Uint32 BufferIndex)
+// #Dibuja todos los tufts de Slot.Instances con un DrawIndexed por LOD
+void Tutorial11_ResourceUpdates::DrawGrassInstanced(IDeviceContext* pCtx, GrassRecordSlot& Slot, IBuffer* pVertexBuffer)
 {
-    MapHelper<Vertex> Vtx(m_pImmediateContext,
-                          m_CubeVertexBuffer[BufferIndex],
-                          MAP_WRITE,
-                          MAP_FLAG_DISCARD);
+    GRASS_PROFILE_SCOPE("DrawGrassInstanced");
 
-    for (Uint32 v = 0; v < _countof(CubeVerts); ++v)
+    // #Las listas de cada LOD quedan una detras de otra en el buffer de instancias
+    Uint32 FirstInstance[GrassNumLODs] = {};
+    Uint32 NumInstances                = 0;
+    for (Uint32 LOD = 0; LOD < GrassNumLODs; ++LOD)
     {
-        const auto& src = CubeVerts[v];
-        Vtx[v].UV       = src.UV;
+        FirstInstance[LOD] = NumInstances;
+        NumInstances += static_cast<Uint32>(Slot.Instances[LOD].size());
+    }
+    if (NumInstances == 0)
+        return;
 
-        if (v < 4)
+    {
+        MapHelper<GrassInstance> InstData(pCtx, Slot.InstanceBuffer, MAP_WRITE, MAP_FLAG_DISCARD);
+        for (Uint32 LOD = 0; LOD < GrassNumLODs; ++LOD)
         {
-            Vtx[v].Pos = src.Pos;
+            const auto& Instances = Slot.Instances[LOD];
+            if (!Instances.empty())
+                memcpy(&InstData[FirstInstance[LOD]], Instances.data(), sizeof(GrassInstance) * Instances.size());
+        }
+    }
+    Slot.UploadBytes += sizeof(GrassInstance) * NumInstances;
+
+    {
+        // #Con instancing el constant buffer solo lleva ViewProj, el mundo va por instancia
+        Uint32 Offset      = 0;
+        auto*  CBConstants = static_cast<VSConstants*>(Slot.VSConstants.Map(pCtx, sizeof(VSConstants), Offset));
+        CBConstants->WorldViewProj = m_GrassFrame.ViewProj;
+        CBConstants->TuftOrigin    = float4{0, 0, 0, 1};
+        Slot.VSConstants.Unmap(pCtx);
+        Slot.pInstConstantsVar->SetBufferOffset(Offset);
+    }
+    Slot.UploadBytes += sizeof(VSConstants);
+
+    pCtx->SetIndexBuffer(m_CubeIndexBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+    pCtx->CommitShaderResources(Slot.GrassInstSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+
+    for (Uint32 LOD = 0; LOD < GrassNumLODs; ++LOD)
+    {
+        const auto NumLODInstances = static_cast<Uint32>(Slot.Instances[LOD].size());
+        if (NumLODInstances == 0)
             continue;
+
+        // Bind per-vertex and per-instance buffers. The instance buffer offset selects the LOD list.
+        IBuffer* pBuffs[]  = {pVertexBuffer, Slot.InstanceBuffer};
+        Uint64   Offsets[] = {0, sizeof(GrassInstance) * FirstInstance[LOD]};
+        pCtx->SetVertexBuffers(0, _countof(pBuffs), pBuffs, Offsets, RESOURCE_STATE_TRANSITION_MODE_VERIFY, SET_VERTEX_BUFFERS_FLAG_RESET);
+
+        DrawIndexedAttribs DrawAttrs;
+        DrawAttrs.IndexType          = m_GrassMesh.IndexType;
+        DrawAttrs.NumIndices         = GrassLODs[LOD].NumIndices;
+        DrawAttrs.FirstIndexLocation = GrassLODs[LOD].FirstIndex;
+        DrawAttrs.NumInstances       = NumLODInstances;
+        DrawAttrs.Flags              = DRAW_FLAG_VERIFY_ALL;
+        pCtx->DrawIndexed(DrawAttrs);
+
+        auto& Stats = Slot.Stats[LOD];
+        ++Stats.Draws;
+        Stats.Tufts += NumLODInstances;
+        Stats.Triangles += Uint64{GrassLODs[LOD].NumIndices / 3} * NumLODInstances;
+    }
+}
+
+// #Graba los chunks m_VisibleChunks[FirstChunk .. FirstChunk + NumChunks) en pCtx: bend, LOD,
+// matrices y draws. Solo escribe en Slot y en los tufts de esos chunks, asi que varias bandas
+// se pueden grabar a la vez desde distintos hilos
+void Tutorial11_ResourceUpdates::RecordGrassBand(IDeviceContext* pCtx, GrassRecordSlot& Slot, Uint32 FirstChunk, Uint32 NumChunks)
+{
+    GRASS_PROFILE_SCOPE("RecordGrassBand");
+
+    const auto& Frame = m_GrassFrame;
+
+    for (auto& Instances : Slot.Instances)
+        Instances.clear();
+    Slot.Stats       = {};
+    Slot.UploadBytes = 0;
+    Slot.VSConstants.BeginFrame();
+
+    if (pCtx != m_pImmediateContext)
+    {
+        // Deferred contexts start in default state. We must bind everything to the context.
+        // Render targets are set and transitioned to correct states by the main thread, here we only verify the states.
+        auto* pRTV = m_pSwapChain->GetCurrentBackBufferRTV();
+        pCtx->SetRenderTargets(1, &pRTV, m_pSwapChain->GetDepthBufferDSV(), RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+    }
+
+    UpdateGrassConstants(pCtx, Slot.GrassConstants);
+    Slot.UploadBytes += sizeof(GrassConstants);
+    pCtx->SetPipelineState(m_UseInstancing ? m_pGrassInstPSO : m_pGrassPSO);
+
+    const float* TuftX = m_GrassField.GetTuftX();
+    const float* TuftZ = m_GrassField.GetTuftZ();
+
+    // #Bend interpolado entre los dos ultimos ticks (ver InterpolateSimSnapshots)
+    const float* TuftBendX = m_RenderBendX.data();
+    const float* TuftBendZ = m_RenderBendZ.data();
+
+    const Uint32 NumVariants = static_cast<Uint32>(std::max(m_NumGrassVariants, 1));
+
+    // #Generacion del grid de pasto
+    for (Uint32 c = FirstChunk; c < FirstChunk + NumChunks; ++c)
+    {
+        const auto& Chunk = m_GrassField.GetChunks()[m_VisibleChunks[c]];
+        for (Uint32 t = Chunk.FirstTuft; t < Chunk.FirstTuft + Chunk.NumTufts; ++t)
+        {
+            float xPos  = TuftX[t];
+            float zPos  = TuftZ[t];
+            float bendX = TuftBendX[t];
+            float bendZ = TuftBendZ[t];
+
+            // #LOD segun la distancia a la camara
+            float  camDx = xPos - Frame.Eye.x;
+            float  camDz = zPos - Frame.Eye.z;
+            float  camD  = std::sqrt(camDx * camDx + Frame.Eye.y * Frame.Eye.y + camDz * camDz);
+            Uint32 LOD   = SelectGrassLOD(m_TuftLOD[t], camD);
+            m_TuftLOD[t] = static_cast<Uint8>(LOD);
+
+            float4x4 World = float4x4::RotationX(bendX) *
+                float4x4::RotationZ(bendZ) *
+                float4x4::Translation(xPos, 0.f, zPos);
+            if (LOD == GrassNumLODs - 1)
+            {
+                // #La tarjeta gira en Y para quedar de frente a la camara
+                World = float4x4::RotationY(std::atan2(-camDx, -camDz)) * World;
+            }
+
+            // #La variante de textura sale de la posicion, asi no cambia si el chunk se recarga
+            const Uint32 Slice = FirstGrassTextureSlice + HashTuftPosition(xPos, zPos) % NumVariants;
+
+            // #Sin instancing tambien se juntan primero, asi las constantes de todos los
+            // draws se escriben de una vez
+            Slot.Instances[LOD].push_back({World, float4{bendX, bendZ, static_cast<float>(LOD), static_cast<float>(Slice)}});
         }
+    }
+
+    if (m_UseInstancing)
+        DrawGrassInstanced(pCtx, Slot, m_CubeVertexBuffer[0]);
+    else
+        DrawGrassCubes(pCtx, Slot, m_CubeVertexBuffer[0]);
+}
+
+// #Culling en el hilo principal y luego las bandas visibles se graban en paralelo
+void Tutorial11_ResourceUpdates::RenderGrass(const float4x4& ViewProj, const float3& Eye)
+{
+    GRASS_PROFILE_SCOPE("RenderGrass");
+    const auto StartTime = std::chrono::high_resolution_clock::now();
+
+    m_GrassFrame.ViewProj = ViewProj;
+    m_GrassFrame.Eye      = Eye;
 
-        float phase        = 0.30f * v;
-        float baseAmp      = 0.06f;
-        float heightFactor = src.Pos.y / 3.0f; 
-        float amp          = baseAmp * (heightFactor * 1.5f + 0.1f);
+    // #Con culling en la GPU no hay bandas ni workers: todo va en el immediate context
+    if (m_UseGpuCulling && m_UseInstancing && m_GpuCulling.IsReady())
+    {
+        m_BakedDraws = 0;
+        m_BakedTufts = 0;
+        RenderGrassGpuCulled();
+        m_GrassCPUTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+        return;
+    }
 
-        if (v >= 4 && v <= 11) amp *= 1.3f;
+    // #Solo se procesan los tufts de los chunks que quedan dentro del frustum
+    {
+        GRASS_PROFILE_SCOPE("GrassField::Cull");
+        m_GrassField.Cull(ViewProj, m_pDevice->GetDeviceInfo().IsGLDevice(), m_FrustumCulling, m_VisibleChunks, m_GrassCullStats);
+    }
+    // #Los chunks horneados salen de m_VisibleChunks antes de repartir las bandas
+    SelectBakedChunks(Eye);
+    const auto NumVisibleChunks = static_cast<Uint32>(m_VisibleChunks.size());
 
-        float disp = (amp * kIdleA) *
-            std::sin(m_CurrTime * 0.8f * kIdleF + phase);
+    if (!m_WorkerThreads.empty())
+    {
+        // #Bandas contiguas de chunks visibles, una por hilo
+        const auto NumBands = static_cast<Uint32>(m_WorkerThreads.size());
+        for (Uint32 b = 0; b < NumBands; ++b)
+        {
+            const Uint32 First = NumVisibleChunks * b / NumBands;
+            const Uint32 Last  = NumVisibleChunks * (b + 1) / NumBands;
+            m_GrassBands[b]    = {First, Last - First};
+        }
 
-        float tilt  = src.Pos.y * 0.02f; 
-        float swayX = 0, swayY = 0, swayZ = 0;
+        m_NumThreadsCompleted = 0;
+        m_RecordGrassSignal.Trigger(true);
 
-        if (m_MovementDirection == 0) 
         {
-            swayX = disp;
-            swayY = -disp * tilt;
+            GRASS_PROFILE_SCOPE("RenderGrass::WaitForWorkers");
+            m_ExecuteCommandListsSignal.Wait(true, 1);
         }
-        else 
+
+        // #Las command lists se ejecutan en orden de banda, asi el resultado no depende de que
+        // hilo termino primero
+        m_CmdListPtrs.resize(m_CmdLists.size());
+        for (Uint32 i = 0; i < m_CmdLists.size(); ++i)
+            m_CmdListPtrs[i] = m_CmdLists[i];
+
+        m_pImmediateContext->ExecuteCommandLists(static_cast<Uint32>(m_CmdListPtrs.size()), m_CmdListPtrs.data());
+
+        for (auto& cmdList : m_CmdLists)
         {
-            swayZ = disp;
-            swayY = -disp * tilt;
+            // Release command lists now to release all outstanding references.
+            // In d3d11 mode, command lists hold references to the swap chain's back buffer
+            // that cause swap chain resize to fail.
+            cmdList.Release();
         }
 
-        Vtx[v].Pos = float3{src.Pos.x + swayX,
-                            src.Pos.y + swayY,
-                            src.Pos.z + swayZ};
+        m_NumThreadsReady = 0;
+        m_GotoNextFrameSignal.Trigger(true);
+
+        // #Ejecutar command lists deja el immediate context sin render targets
+        auto* pRTV = m_pSwapChain->GetCurrentBackBufferRTV();
+        m_pImmediateContext->SetRenderTargets(1, &pRTV, m_pSwapChain->GetDepthBufferDSV(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    }
+    else
+    {
+        RecordGrassBand(m_pImmediateContext, m_GrassSlots[0], 0, NumVisibleChunks);
     }
-}
 
+    DrawBakedChunks(ViewProj);
 
+    // #Slot 0 solo se usa cuando no hay workers
+    m_LODStats = {};
+    for (Uint32 s = m_WorkerThreads.empty() ? 0 : 1; s <= m_WorkerThreads.size(); ++s)
+    {
+        for (Uint32 LOD = 0; LOD < GrassNumLODs; ++LOD)
+        {
+            const auto& SlotStats = m_GrassSlots[s].Stats[LOD];
+            m_LODStats[LOD].Draws += SlotStats.Draws;
+            m_LODStats[LOD].Tufts += SlotStats.Tufts;
+            m_LODStats[LOD].Triangles += SlotStats.Triangles;
+            m_FrameCounters.DrawCalls += SlotStats.Draws;
+        }
+        m_FrameCounters.UploadBytes += m_GrassSlots[s].UploadBytes;
+    }
 
-void Tutorial11_ResourceUpdates::Update(double CurrTime, double ElapsedTime, bool DoUpdateUI)
+    m_GrassCPUTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+}
+
+// #Saca de m_VisibleChunks los chunks que se pueden dibujar horneados: lejos de la camara, sin
+// bend y sin pisadas (el mesh horneado no tiene deformacion). Los que no estan horneados y ya no
+// entran en el presupuesto del frame se dibujan normalmente
+void Tutorial11_ResourceUpdates::SelectBakedChunks(const float3& Eye)
 {
-    SampleBase::Update(CurrTime, ElapsedTime, DoUpdateUI);
+    GRASS_PROFILE_SCOPE("SelectBakedChunks");
 
-    m_CurrTime = CurrTime;
+    m_BakedChunksToDraw.clear();
+    m_ChunkBaker.BeginFrame();
+    if (!m_UseChunkBaking)
+        return;
 
-    m_PrevPlayerX = m_PlayerX;
-    m_PrevPlayerZ = m_PlayerZ;
+    const float* TuftBendX   = m_RenderBendX.data();
+    const float* TuftBendZ   = m_RenderBendZ.data();
+    const Uint32 NumVariants = static_cast<Uint32>(std::max(m_NumGrassVariants, 1));
+    const bool   UseTrample  = m_UseTrampleMask && m_TrampleStrength > 0.f;
+    const float  MinDistSq   = m_BakeDistance * m_BakeDistance;
 
-    // #Velocidad del jugador
-    float moveSpeed = 2.0f * static_cast<float>(ElapsedTime);
+    const auto GetSlice = [NumVariants](float X, float Z) {
+        return FirstGrassTextureSlice + HashTuftPosition(X, Z) % NumVariants;
+    };
 
-    const auto& inputController = GetInputController();
+    Uint32 NumLiveChunks = 0;
+    for (Uint32 c : m_VisibleChunks)
+    {
+        const auto& Chunk  = m_GrassField.GetChunks()[c];
+        const auto& Bounds = Chunk.Bounds;
+
+        // #Distancia de la camara a la caja del chunk
+        const float Dx = std::max({Bounds.Min.x - Eye.x, 0.f, Eye.x - Bounds.Max.x});
+        const float Dy = std::max({Bounds.Min.y - Eye.y, 0.f, Eye.y - Bounds.Max.y});
+        const float Dz = std::max({Bounds.Min.z - Eye.z, 0.f, Eye.z - Bounds.Max.z});
+
+        bool AtRest = Dx * Dx + Dy * Dy + Dz * Dz >= MinDistSq;
+        for (Uint32 t = Chunk.FirstTuft; AtRest && t < Chunk.FirstTuft + Chunk.NumTufts; ++t)
+            AtRest = TuftBendX[t] == 0.f && TuftBendZ[t] == 0.f;
+        if (AtRest && UseTrample)
+            AtRest = m_TrampleMask.IsAreaClear(Bounds.Min.x, Bounds.Min.z, Bounds.Max.x, Bounds.Max.z);
+
+        // #Las tarjetas del chunk miran a la camara desde el centro, como en el camino sin hornear
+        const float Yaw    = std::atan2(Eye.x - (Bounds.Min.x + Bounds.Max.x) * 0.5f, Eye.z - (Bounds.Min.z + Bounds.Max.z) * 0.5f);
+        const auto* pBaked = AtRest ? m_ChunkBaker.GetOrBake(m_GrassField, Chunk, NumVariants, Yaw, GetSlice) : nullptr;
+        if (pBaked != nullptr)
+            m_BakedChunksToDraw.push_back(pBaked);
+        else
+            m_VisibleChunks[NumLiveChunks++] = c;
+    }
+    m_VisibleChunks.resize(NumLiveChunks);
+}
 
-    // #Inputs del jugador
-    if (inputController.IsKeyDown(InputKeys::MoveForward))
-        m_PlayerZ -= moveSpeed;
-    if (inputController.IsKeyDown(InputKeys::MoveBackward))
-        m_PlayerZ += moveSpeed;
+// #Un draw por cada variante de textura de cada chunk horneado, en el immediate context
+void Tutorial11_ResourceUpdates::DrawBakedChunks(const float4x4& ViewProj)
+{
+    GRASS_PROFILE_SCOPE("DrawBakedChunks");
 
-    if (inputController.IsKeyDown(InputKeys::MoveRight))
-        m_PlayerX -= moveSpeed;
-    if (inputController.IsKeyDown(InputKeys::MoveLeft))
-        m_PlayerX += moveSpeed;
+    m_BakedDraws = 0;
+    m_BakedTufts = 0;
+    if (m_BakedChunksToDraw.empty())
+        return;
 
-    m_PlayerMoveX = m_PlayerX - m_PrevPlayerX;
-    m_PlayerMoveZ = m_PlayerZ - m_PrevPlayerZ;
+    m_pImmediateContext->SetPipelineState(m_pPSO_NoCull);
+    for (const auto* pBaked : m_BakedChunksToDraw)
+    {
+        IBuffer* pBuffs[] = {pBaked->pVertexBuffer};
+        m_pImmediateContext->SetVertexBuffers(0, 1, pBuffs, nullptr, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, SET_VERTEX_BUFFERS_FLAG_RESET);
+        m_pImmediateContext->SetIndexBuffer(pBaked->pIndexBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
-    float moveLength = std::sqrt(m_PlayerMoveX * m_PlayerMoveX + m_PlayerMoveZ * m_PlayerMoveZ);
-    if (moveLength > 0.001f)
+        const float4x4 WVP = float4x4::Translation(pBaked->Origin) * ViewProj;
+        for (const auto& Range : pBaked->Slices)
+        {
+            Uint32 Offset      = 0;
+            auto*  CBConstants = static_cast<VSConstants*>(m_SceneConstants.Map(m_pImmediateContext, sizeof(VSConstants), Offset));
+            CBConstants->WorldViewProj = WVP;
+            CBConstants->TuftOrigin    = float4{0, 0, 0, 1};
+            CBConstants->DrawParams    = float4{static_cast<float>(Range.Slice), 0, 0, 0};
+            CBConstants->GroundXZ      = float4{0, 0, 0, 0};
+            CBConstants->GroundTrample = float4{0, 0, 0, 0};
+            CBConstants->MeshScale     = pBaked->PosScale;
+            m_SceneConstants.Unmap(m_pImmediateContext);
+            m_SceneSRB->GetVariableByName(SHADER_TYPE_VERTEX, "Constants")->SetBufferOffset(Offset);
+            m_pImmediateContext->CommitShaderResources(m_SceneSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+            DrawIndexedAttribs DrawAttrs;
+            DrawAttrs.IndexType          = pBaked->IndexType;
+            DrawAttrs.NumIndices         = Range.NumIndices;
+            DrawAttrs.FirstIndexLocation = Range.FirstIndex;
+            DrawAttrs.Flags              = DRAW_FLAG_VERIFY_ALL;
+            m_pImmediateContext->DrawIndexed(DrawAttrs);
+            ++m_BakedDraws;
+        }
+        m_BakedTufts += pBaked->NumTufts;
+    }
+
+    m_FrameCounters.DrawCalls += m_BakedDraws;
+    m_FrameCounters.UploadBytes += Uint64{m_BakedDraws} * sizeof(VSConstants);
+}
+
+// #Sube la posicion, la capa y si el slot esta ocupado de cada tuft residente. Solo hace falta
+// cuando se cargan o descargan chunks o cambia la cantidad de variantes de textura
+void Tutorial11_ResourceUpdates::UpdateGpuCullTufts()
+{
+    GRASS_PROFILE_SCOPE("UpdateGpuCullTufts");
+
+    const float* TuftX       = m_GrassField.GetTuftX();
+    const float* TuftZ       = m_GrassField.GetTuftZ();
+    const Uint32 NumVariants = static_cast<Uint32>(std::max(m_NumGrassVariants, 1));
+
+    m_GpuCullTufts.assign(m_GrassField.GetTuftCapacity(), GrassGpuCulling::Tuft{});
+    for (const auto& Chunk : m_GrassField.GetChunks())
     {
-        m_PlayerMoveX /= moveLength;
-        m_PlayerMoveZ /= moveLength;
+        for (Uint32 t = Chunk.FirstTuft; t < Chunk.FirstTuft + Chunk.NumTufts; ++t)
+        {
+            const Uint32 Slice = FirstGrassTextureSlice + HashTuftPosition(TuftX[t], TuftZ[t]) % NumVariants;
+            m_GpuCullTufts[t]  = {TuftX[t], TuftZ[t], static_cast<float>(Slice), 1.f};
+        }
     }
+    m_GpuCulling.UpdateTufts(m_pImmediateContext, m_GpuCullTufts);
+    m_FrameCounters.UploadBytes += sizeof(GrassGpuCulling::Tuft) * m_GpuCullTufts.size();
 
-    static constexpr const double UpdateBufferPeriod = 0.1;
-    if (CurrTime - m_LastBufferUpdateTime > UpdateBufferPeriod)
+    m_GpuCullTuftsDirty = false;
+    m_GpuCullVariants   = m_NumGrassVariants;
+}
+
+// #El compute shader decide que tufts se ven y con que LOD; el CPU solo sube el bend y manda
+// una cantidad fija de comandos. Los contadores de la UI llegan con unos frames de retraso
+void Tutorial11_ResourceUpdates::RenderGrassGpuCulled()
+{
+    GRASS_PROFILE_SCOPE("RenderGrassGpuCulled");
+
+    if (m_GpuCullTuftsDirty || m_GpuCullVariants != m_NumGrassVariants)
+        UpdateGpuCullTufts();
+
+    GrassGpuCulling::Params CullParams;
+    CullParams.ViewProj       = m_GrassFrame.ViewProj;
+    CullParams.Eye            = m_GrassFrame.Eye;
+    CullParams.IsGL           = m_pDevice->GetDeviceInfo().IsGLDevice();
+    CullParams.FrustumCulling = m_FrustumCulling;
+    CullParams.UseLOD         = m_UseLOD;
+    CullParams.LODHysteresis  = m_LODHysteresis;
+    CullParams.TuftRadius     = m_GrassField.GetConfig().TuftRadius;
+    for (Uint32 LOD = 0; LOD < GrassNumLODs - 1; ++LOD)
+        CullParams.LODDistance[LOD] = m_LODDistance[LOD];
+
+    if (m_ValidateGpuCulling)
+        m_GpuCulling.RequestValidation();
+    m_FrameCounters.UploadBytes += m_GpuCulling.Dispatch(m_pImmediateContext, CullParams, m_RenderBendX.data(), m_RenderBendZ.data());
+    if (m_ValidateGpuCulling)
     {
-        m_LastBufferUpdateTime = CurrTime;
-        UpdateBuffer(1);
+        const auto& Result = m_GpuCulling.GetValidation();
+        const auto  Log    = Result.Mismatches == 0 ? DEBUG_MESSAGE_SEVERITY_INFO : DEBUG_MESSAGE_SEVERITY_WARNING;
+        LOG_DEBUG_MESSAGE(Log, "GPU grass culling vs CPU reference: ", Result.Mismatches, " mismatches, max error ", Result.MaxError,
+                          ". Tufts per LOD (GPU/CPU): ", Result.GPUTufts[0], "/", Result.CPUTufts[0], ", ", Result.GPUTufts[1], "/",
+                          Result.CPUTufts[1], ", ", Result.GPUTufts[2], "/", Result.CPUTufts[2]);
+        m_ValidateGpuCulling = false;
     }
 
-    MapDynamicBuffer(2);
+    auto& Slot = m_GrassSlots[0];
+    Slot.VSConstants.BeginFrame();
+    UpdateGrassConstants(m_pImmediateContext, Slot.GrassConstants);
+    {
+        Uint32 Offset      = 0;
+        auto*  CBConstants = static_cast<VSConstants*>(Slot.VSConstants.Map(m_pImmediateContext, sizeof(VSConstants), Offset));
+        CBConstants->WorldViewProj = m_GrassFrame.ViewProj;
+        CBConstants->TuftOrigin    = float4{0, 0, 0, 1};
+        Slot.VSConstants.Unmap(m_pImmediateContext);
+        Slot.pInstConstantsVar->SetBufferOffset(Offset);
+    }
+    m_FrameCounters.UploadBytes += sizeof(GrassConstants) + sizeof(VSConstants);
+
+    m_pImmediateContext->SetPipelineState(m_pGrassInstPSO);
+    m_pImmediateContext->CommitShaderResources(Slot.GrassInstSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_FrameCounters.DrawCalls += m_GpuCulling.Draw(m_pImmediateContext, m_CubeVertexBuffer[0], m_CubeIndexBuffer, m_GrassMesh.IndexType);
+
+    // #Los chunks ya no se prueban en el CPU: solo se sabe cuantos tufts paso la GPU
+    m_GrassCullStats = {};
+    for (const auto& Chunk : m_GrassField.GetChunks())
+        m_GrassCullStats.TuftsTested += Chunk.NumTufts;
+    m_LODStats = {};
+    for (Uint32 LOD = 0; LOD < GrassNumLODs; ++LOD)
+    {
+        const Int32 NumTufts = m_GpuCulling.GetVisibleTufts(LOD);
+        m_LODStats[LOD].Draws = 1;
+        if (NumTufts < 0)
+            continue;
+        m_LODStats[LOD].Tufts     = static_cast<Uint32>(NumTufts);
+        m_LODStats[LOD].Triangles = Uint64{GrassLODs[LOD].NumIndices / 3} * static_cast<Uint32>(NumTufts);
+        m_GrassCullStats.TuftsVisible += static_cast<Uint32>(NumTufts);
+    }
+    m_GrassCullStats.TuftsCulled = m_GrassCullStats.TuftsTested - std::min(m_GrassCullStats.TuftsVisible, m_GrassCullStats.TuftsTested);
+}
+
+// #Elige el LOD de un tuft. Solo cambia de LOD cuando la distancia pasa el umbral por mas
+// de m_LODHysteresis, asi los tufts que estan justo en el borde no saltan de un LOD a otro
+Uint32 Tutorial11_ResourceUpdates::SelectGrassLOD(Uint32 CurrLOD, float Distance) const
+{
+    if (!m_UseLOD)
+        return 0;
+
+    Uint32 LOD = CurrLOD;
+    while (LOD < GrassNumLODs - 1 && Distance > m_LODDistance[LOD] + m_LODHysteresis)
+        ++LOD;
+    while (LOD > 0 && Distance < m_LODDistance[LOD - 1] - m_LODHysteresis)
+        --LOD;
+    return LOD;
+}
+
+// #Matriz para facilitar la vista (antes la usaba para la camara que se movia pero eso se quito)
+static Diligent::float4x4 MakeViewMatrix(const Diligent::float3& eye,
+                                         const Diligent::float3& target,
+                                         const Diligent::float3& up)
+{
+    using namespace Diligent;
+    float3 z = normalize(target - eye);
+    float3 x = normalize(cross(up, z));
+    float3 y = cross(z, x);
+
+    return float4x4{
+        x.x, y.x, z.x, 0,
+        x.y, y.y, z.y, 0,
+        x.z, y.z, z.z, 0,
+        -dot(x, eye),
+        -dot(y, eye),
+        -dot(z, eye),
+        1};
+}
+
+// #Adicional para direccionar
+static Diligent::float2 DirAwayFrom(const Diligent::float3& player,
+                                    const Diligent::float3& tuft)
+{
+    float dx = tuft.x - player.x;
+    float dz = tuft.z - player.z;
+    float d2 = dx * dx + dz * dz;
+    if (d2 < 1e-6f)
+        return {0, 0};
+    float invLen = 1.0f / std::sqrt(d2);
+    return {dx * invLen, dz * invLen};
+}
+
+
+void Tutorial11_ResourceUpdates::Render()
+{
+    GRASS_PROFILE_SCOPE("Render");
+    const auto RenderStart = std::chrono::high_resolution_clock::now();
+
+    if (m_StartupFirstFrameMs < 0)
+    {
+        m_StartupFirstFrameMs = std::chrono::duration<double, std::milli>(RenderStart - m_StartupStart).count();
+        LOG_INFO_MESSAGE("Startup: first frame after ", std::fixed, std::setprecision(1), m_StartupFirstFrameMs, " ms");
+    }
+
+    m_SceneConstants.BeginFrame();
+
+    auto*  pRTV       = m_pSwapChain->GetCurrentBackBufferRTV();
+    auto*  pDSV       = m_pSwapChain->GetDepthBufferDSV();
+    float4 ClearColor = {0.35f, 0.35f, 0.35f, 1.0f};
+    if (m_ConvertPSOutputToGamma)
+        ClearColor = LinearToSRGB(ClearColor);
+    m_GpuQueries.BeginPass(m_pImmediateContext, GpuPassQueries::PASS_CLEAR);
+    m_pImmediateContext->ClearRenderTarget(pRTV, ClearColor.Data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pImmediateContext->ClearDepthStencil(pDSV, CLEAR_DEPTH_FLAG, 1.f, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_GpuQueries.EndPass(m_pImmediateContext, GpuPassQueries::PASS_CLEAR);
+
+    // #Hasta que PollAsyncLoads instala los PSOs de la escena solo se limpia la pantalla
+    if (!m_SceneSRB)
+    {
+        m_FramePacer.EndFrame(m_pImmediateContext);
+        m_RenderCPUTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - RenderStart).count();
+        return;
+    }
+
+    m_pImmediateContext->SetPipelineState(m_pPSO);
+
+    // #CVariables varias, para camara, movimiento, tracking, etc
+    auto SrfPre = GetSurfacePretransformMatrix({0, 0, 1});
+    auto Proj   = GetAdjustedProjectionMatrix(PI_F / 5.f, 0.1f, 200.f);
+
+    constexpr float DEG2RAD = PI_F / 180.f;
+    float           pitch   = -42.f * DEG2RAD;
+    float           yaw     = 180.f * DEG2RAD;
+    float3          eye     = {0.f, 29.f, 32.f};
+    // #La camara se fija antes de grabar el pasto, asi que su late latch es al principio de Render()
+    m_LatchCameraPos = m_LateLatch ? LatchPlayerPosition() : m_RenderPlayerPos;
+    if (m_CameraFollowsPlayer)
+        eye += float3{m_LatchCameraPos.x, 0.f, m_LatchCameraPos.y};
+
+    float  cp = std::cos(pitch), sp = std::sin(pitch);
+    float  cy = std::cos(yaw), sy = std::sin(yaw);
+    float3 fwd = {sy * cp, sp, cy * cp};
+
+    auto View     = MakeViewMatrix(eye, eye + fwd, {0, 1, 0});
+    auto ViewProj = SrfPre * View * Proj;
+
+
+    m_pImmediateContext->SetPipelineState(m_pPSO_NoCull);
+    // #El piso de GroundPlaneVerts mide 120x120. Se agranda para cubrir el campo o, si se carga
+    // por chunks, el radio de carga alrededor del jugador
+    const auto& FieldCfg    = m_GrassField.GetConfig();
+    float4x4    GroundWorld = float4x4::Identity();
+    float4      GroundXZ;
+    if (FieldCfg.PageRadius > 0)
+    {
+        const float GroundScale = std::max(60.f, FieldCfg.PageRadius + FieldCfg.TuftRadius) / 60.f;
+        GroundWorld             = float4x4::Scale(GroundScale, 1.f, GroundScale) * float4x4::Translation(m_RenderPlayerPos.x, 0.f, m_RenderPlayerPos.y);
+        GroundXZ                = float4{GroundScale, GroundScale, m_RenderPlayerPos.x, m_RenderPlayerPos.y};
+    }
+    else
+    {
+        const float GroundScale = std::max(60.f, m_GrassField.GetHalfSize() + FieldCfg.TuftRadius) / 60.f;
+        GroundWorld             = float4x4::Scale(GroundScale, 1.f, GroundScale);
+        GroundXZ                = float4{GroundScale, GroundScale, 0.f, 0.f};
+    }
+    m_GpuQueries.BeginPass(m_pImmediateContext, GpuPassQueries::PASS_GROUND);
+    DrawGroundPlane(GroundWorld * ViewProj, GroundXZ, GroundTextureSlice);
+    m_GpuQueries.EndPass(m_pImmediateContext, GpuPassQueries::PASS_GROUND);
+
+    // #Una query de pipeline statistics no puede abarcar las command lists de los workers, asi que
+    // con workers solo se mide el tiempo del pasto
+    if (m_pGrassPSO && m_pGrassInstPSO)
+    {
+        m_GpuQueries.BeginPass(m_pImmediateContext, GpuPassQueries::PASS_GRASS, m_WorkerThreads.empty() || m_UseGpuCulling);
+        RenderGrass(ViewProj, eye);
+        m_GpuQueries.EndPass(m_pImmediateContext, GpuPassQueries::PASS_GRASS);
+    }
+
+    m_pImmediateContext->SetPipelineState(m_pPSO_NoCull);
+
+    m_GpuQueries.BeginPass(m_pImmediateContext, GpuPassQueries::PASS_PLAYER);
+    if (m_DrawAgents)
+    {
+        DrawAgents(ViewProj);
+        m_pImmediateContext->SetPipelineState(m_pPSO_NoCull);
+    }
+
+    // #Late latch: las constantes del jugador son lo ultimo que se escribe antes de enviar el
+    // frame, con la posicion de este instante y no la del principio del frame
+    const float2 PlayerPos   = m_LateLatch ? LatchPlayerPosition() : m_RenderPlayerPos;
+    float4x4     PlayerWorld = float4x4::Translation(PlayerPos.x, 1.0f, PlayerPos.y);
+    PlayerWorld *= float4x4::Scale(1.5f, 1.5f, 1.5f);
+    DrawPlayerCube(PlayerWorld * ViewProj, PlayerTextureSlice);
+    m_FramePacer.MarkLatch();
+    m_GpuQueries.EndPass(m_pImmediateContext, GpuPassQueries::PASS_PLAYER);
+
+    // #Se captura la escena sin la UI, que el framework dibuja despues de Render()
+    if (m_FrameCapture.IsActive())
+    {
+        m_FrameCapture.Capture(m_pImmediateContext, pRTV->GetTexture(), m_pDevice->GetDeviceInfo().IsGLDevice());
+        // #La copia deja el back buffer como COPY_SOURCE
+        m_pImmediateContext->SetRenderTargets(1, &pRTV, pDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    }
+
+    m_FramePacer.EndFrame(m_pImmediateContext);
+    m_RenderCPUTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - RenderStart).count();
+}
+
+void Tutorial11_ResourceUpdates::UpdateBuffer(Diligent::Uint32 BufferIndex)
+{
+    GRASS_PROFILE_SCOPE("UpdateBuffer");
+
+    // #Los vertices de origen son los de la malla ya soldada y reordenada, que es lo que hay en el buffer
+    const auto& SrcVerts          = m_GrassMesh.Vertices;
+    Uint32      NumVertsToUpdate  = std::uniform_int_distribution<Uint32>{2, 5}(m_gen);
+    Uint32      FirstVertToUpdate = std::uniform_int_distribution<Uint32>{0, m_GrassMesh.NumVertices - NumVertsToUpdate}(m_gen);
+    MeshVertex  Vertices[5];
+    for (Uint32 v = 0; v < NumVertsToUpdate; ++v)
+    {
+        auto        SrcInd  = FirstVertToUpdate + v;
+        const auto& SrcVert = SrcVerts[SrcInd];
+        Vertices[v].UV      = SrcVert.UV;
+        Vertices[v].Pos     = SrcVert.Pos * static_cast<float>(1 + 0.2 * sin(m_CurrTime * (1.0 + SrcInd * 0.2)));
+    }
+    // #Al formato del buffer; con vertices compactos lo que crece mas alla de la escala de la
+    // malla se recorta
+    Uint8        Packed[sizeof(Vertices)];
+    const Uint32 DataSize = EncodeMeshVertices(m_GrassMesh, Vertices, NumVertsToUpdate, Packed);
+    m_pImmediateContext->UpdateBuffer(
+        m_CubeVertexBuffer[BufferIndex],              // Device context to use for the operation
+        FirstVertToUpdate * m_GrassMesh.VertexStride, // Start offset in bytes
+        DataSize,                                     // Data size in bytes
+        Packed,                                       // Data pointer
+        RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_FrameCounters.UploadBytes += DataSize;
+}
+
+// #FUncion para calcular la velocidad y tener informacion relevante
+void Tutorial11_ResourceUpdates::UpdatePlayerVelocity(float dt)
+{
+    float vx = (m_PlayerX - m_PrevPlayerX) / dt;
+    float vz = (m_PlayerZ - m_PrevPlayerZ) / dt;
+
+    const float SMOOTH = 10.0f; 
+
+    const float threshold = 0.2f;
+    if (std::abs(vx) > threshold || std::abs(vz) > threshold)
+    {
+        m_PlayerVel.x = vx * 0.7f + m_PlayerVel.x * 0.3f;
+        m_PlayerVel.z = vz * 0.7f + m_PlayerVel.z * 0.3f;
+    }
+    else
+    {
+        m_PlayerVel.x += (vx - m_PlayerVel.x) * (1.f - expf(-SMOOTH * dt));
+        m_PlayerVel.z += (vz - m_PlayerVel.z) * (1.f - expf(-SMOOTH * dt));
+    }
+
+    if (std::abs(vx) < 0.01f && std::abs(vz) < 0.01f)
+    {
+        m_PlayerVel.x *= 0.85f;
+        m_PlayerVel.z *= 0.85f;
+    }
+}
+
+void Tutorial11_ResourceUpdates::StartSimulationThread()
+{
+    m_SimStop   = false;
+    m_SimThread = std::thread(SimulationThreadFunc, this);
+}
+
+void Tutorial11_ResourceUpdates::StopSimulationThread()
+{
+    if (!m_SimThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> Lock{m_SimMtx};
+        m_SimStop = true;
+    }
+    m_SimCV.notify_all();
+    m_SimThread.join();
+}
+
+void Tutorial11_ResourceUpdates::SimulationThreadFunc(Tutorial11_ResourceUpdates* pThis)
+{
+    CpuProfiler::SetThreadName("Simulation");
+
+    std::unique_lock<std::mutex> Lock{pThis->m_SimMtx};
+    for (;;)
+    {
+        pThis->m_SimCV.wait(Lock, [pThis] { return pThis->m_SimStop || pThis->m_SimTick < pThis->m_SimTargetTick; });
+        if (pThis->m_SimStop)
+            return;
+
+        // #El hilo principal no toca el estado de la simulacion hasta que m_SimTick llega a
+        // m_SimTargetTick (ver WaitForSimulation), asi que los ticks corren con el mutex tomado
+        while (pThis->m_SimTick < pThis->m_SimTargetTick)
+        {
+            pThis->SimulateTick(pThis->m_SimInput);
+            ++pThis->m_SimTick;
+            // #Solo se interpola entre los dos ultimos ticks, los anteriores no hace falta copiarlos
+            if (pThis->m_SimTick + 1 >= pThis->m_SimTargetTick)
+                pThis->PublishSimSnapshot();
+        }
+        pThis->m_SimCV.notify_all();
+    }
+}
+
+// #Un tick de SimTimeStep: mueve al jugador y a los NPCs, suaviza la velocidad del jugador y
+// avanza la deformacion del pasto
+void Tutorial11_ResourceUpdates::SimulateTick(const SimInput& Input)
+{
+    GRASS_PROFILE_SCOPE("SimulateTick");
+    const auto StartTime = std::chrono::high_resolution_clock::now();
+
+    m_PrevPlayerX = m_PlayerX;
+    m_PrevPlayerZ = m_PlayerZ;
+
+    // #Velocidad del jugador
+    const float moveSpeed = PlayerSpeed * static_cast<float>(SimTimeStep);
+
+    const float2 MoveDir = Input.ScriptedPath ? m_BenchmarkPath.GetMoveDirection(m_PlayerX, m_PlayerZ) : Input.MoveDir;
+    m_PlayerX += MoveDir.x * moveSpeed;
+    m_PlayerZ += MoveDir.y * moveSpeed;
+
+    m_PlayerMoveX = m_PlayerX - m_PrevPlayerX;
+    m_PlayerMoveZ = m_PlayerZ - m_PrevPlayerZ;
+
+    float moveLength = std::sqrt(m_PlayerMoveX * m_PlayerMoveX + m_PlayerMoveZ * m_PlayerMoveZ);
+    if (moveLength > 0.001f)
+    {
+        m_PlayerMoveX /= moveLength;
+        m_PlayerMoveZ /= moveLength;
+    }
+
+    UpdatePlayerVelocity(static_cast<float>(SimTimeStep));
+    m_Agents.Step(static_cast<float>(SimTimeStep));
+    UpdateGrassDeformation(Input.BendKernel, Input.ParallelDeform);
+
+    m_SimTickMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+}
+
+// #Escribe el tick actual en el snapshot mas viejo, que pasa a ser el actual
+void Tutorial11_ResourceUpdates::PublishSimSnapshot()
+{
+    auto& Snapshot   = m_SimSnapshots[1 - m_SimCurrSnapshot];
+    Snapshot.Tick    = m_SimTick;
+    Snapshot.PlayerX = m_PlayerX;
+    Snapshot.PlayerZ = m_PlayerZ;
+    m_GrassDeform.GetBentTufts(Snapshot.BentTufts);
+    CopyAgentPositions(m_Agents, Snapshot.Agents);
+    m_SimCurrSnapshot = 1 - m_SimCurrSnapshot;
+}
+
+// #Espera a que termine los ticks que se le pidieron en el frame anterior
+void Tutorial11_ResourceUpdates::WaitForSimulation()
+{
+    GRASS_PROFILE_SCOPE("WaitForSimulation");
+    const auto StartTime = std::chrono::high_resolution_clock::now();
+    {
+        std::unique_lock<std::mutex> Lock{m_SimMtx};
+        m_SimCV.wait(Lock, [this] { return m_SimTick >= m_SimTargetTick; });
+    }
+    m_SimWaitMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+}
+
+// #Convierte el tiempo del frame en ticks y se los pasa al hilo de simulacion. La cantidad de
+// ticks solo depende del tiempo acumulado, asi que el resultado es el mismo a cualquier frame rate
+void Tutorial11_ResourceUpdates::ScheduleSimulation(double ElapsedTime, const SimInput& Input)
+{
+    m_SimAccumulator += std::max(ElapsedTime, 0.0);
+    Uint32 NumTicks = static_cast<Uint32>(m_SimAccumulator / SimTimeStep);
+    m_SimAccumulator -= NumTicks * SimTimeStep;
+    NumTicks            = std::min(NumTicks, SimMaxTicksPerFrame);
+    m_SimTicksLastFrame = NumTicks;
+    if (NumTicks == 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> Lock{m_SimMtx};
+        m_SimInput = Input;
+        m_SimTargetTick += NumTicks;
+    }
+    m_SimCV.notify_all();
+}
+
+// #Arma el jugador y el bend que se dibujan en este frame. m_SimAccumulator es lo que sobro
+// despues del ultimo tick, asi que lo que se ve va un tick atras de la simulacion
+void Tutorial11_ResourceUpdates::InterpolateSimSnapshots()
+{
+    GRASS_PROFILE_SCOPE("InterpolateSimSnapshots");
+
+    const auto& Curr  = m_SimSnapshots[m_SimCurrSnapshot];
+    const auto& Prev  = m_SimSnapshots[1 - m_SimCurrSnapshot];
+    const float Alpha = static_cast<float>(m_SimAccumulator / SimTimeStep);
+
+    m_RenderPlayerPos = float2{Prev.PlayerX, Prev.PlayerZ} * (1.f - Alpha) + float2{Curr.PlayerX, Curr.PlayerZ} * Alpha;
+
+    // #Si la cantidad de NPCs cambio entre los dos snapshots no hay nada que interpolar
+    m_RenderAgentPos.resize(Curr.Agents.size());
+    for (size_t a = 0; a < Curr.Agents.size(); ++a)
+        m_RenderAgentPos[a] = Prev.Agents.size() == Curr.Agents.size() ? Prev.Agents[a] * (1.f - Alpha) + Curr.Agents[a] * Alpha : Curr.Agents[a];
+
+    for (Uint32 t : m_RenderBentTufts)
+    {
+        m_RenderBendX[t] = 0.f;
+        m_RenderBendZ[t] = 0.f;
+    }
+    m_RenderBentTufts.clear();
+
+    // #Un tuft que no esta en uno de los snapshots tenia bend 0 en ese tick
+    for (const auto& Bent : Prev.BentTufts)
+    {
+        m_RenderBendX[Bent.Tuft] = Bent.BendX * (1.f - Alpha);
+        m_RenderBendZ[Bent.Tuft] = Bent.BendZ * (1.f - Alpha);
+        m_RenderBentTufts.push_back(Bent.Tuft);
+    }
+    for (const auto& Bent : Curr.BentTufts)
+    {
+        m_RenderBendX[Bent.Tuft] += Bent.BendX * Alpha;
+        m_RenderBendZ[Bent.Tuft] += Bent.BendZ * Alpha;
+        m_RenderBentTufts.push_back(Bent.Tuft);
+    }
+}
+
+// #Extrapola al jugador desde el ultimo tick simulado hasta este instante con el input del frame,
+// igual que lo movera SimulateTick. Se limita a los ticks que se pueden simular en un frame por si
+// el frame se trabo. Los NPCs y el bend siguen interpolados: no dependen del input
+float2 Tutorial11_ResourceUpdates::LatchPlayerPosition() const
+{
+    const double Elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - m_LatchBaseTime).count();
+    const double Ahead   = std::min(std::max(Elapsed, 0.0), (SimMaxTicksPerFrame + 1) * SimTimeStep);
+    return m_LatchBasePos + m_LatchMoveDir * (PlayerSpeed * static_cast<float>(Ahead));
+}
+
+// #Vuelve a repartir m_NumAgents NPCs por el campo. Solo con la simulacion parada
+void Tutorial11_ResourceUpdates::ResetAgents()
+{
+    m_NumAgents = std::max(m_NumAgents, 0);
+    m_Agents.Initialize(static_cast<Uint32>(m_NumAgents), m_GrassField.GetHalfSize() * 0.9f, m_BenchmarkSeed);
+    ResetSimSnapshots();
+
+    const Uint64 InstanceBytes = sizeof(GrassInstance) * std::max(m_Agents.GetCount(), 1u);
+    if (!m_AgentInstanceBuffer || m_AgentInstanceBuffer->GetDesc().Size < InstanceBytes)
+    {
+        BufferDesc InstBuffDesc;
+        InstBuffDesc.Name           = "Agent instance data buffer";
+        InstBuffDesc.Usage          = USAGE_DYNAMIC;
+        InstBuffDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
+        InstBuffDesc.BindFlags      = BIND_VERTEX_BUFFER;
+        InstBuffDesc.Size           = InstanceBytes;
+        m_AgentInstanceBuffer.Release();
+        GpuMemoryRegistry::Get().CreateBuffer(m_pDevice, InstBuffDesc, nullptr, GpuMemoryRegistry::CATEGORY_PER_INSTANCE, &m_AgentInstanceBuffer);
+    }
+}
+
+// #Deja los dos snapshots en el estado actual, sin tufts doblados. Solo con la simulacion parada
+void Tutorial11_ResourceUpdates::ResetSimSnapshots()
+{
+    for (auto& Snapshot : m_SimSnapshots)
+    {
+        Snapshot.Tick    = m_SimTick;
+        Snapshot.PlayerX = m_PlayerX;
+        Snapshot.PlayerZ = m_PlayerZ;
+        m_GrassDeform.GetBentTufts(Snapshot.BentTufts);
+        CopyAgentPositions(m_Agents, Snapshot.Agents);
+    }
+    m_RenderPlayerPos = float2{m_PlayerX, m_PlayerZ};
+    CopyAgentPositions(m_Agents, m_RenderAgentPos);
+    m_RenderBendX.assign(m_GrassField.GetTuftCapacity(), 0.f);
+    m_RenderBendZ.assign(m_GrassField.GetTuftCapacity(), 0.f);
+    m_RenderBentTufts.clear();
+}
+
+// #Pinta el camino del jugador desde el frame anterior y sube lo que cambio
+void Tutorial11_ResourceUpdates::UpdateTrampleMask()
+{
+    GRASS_PROFILE_SCOPE("UpdateTrampleMask");
+
+    const float2 Pos = m_RenderPlayerPos;
+    m_TrampleMask.Recenter(Pos.x, Pos.y);
+    if (m_UseTrampleMask)
+        m_TrampleMask.PaintStroke(m_LastTramplePos.x, m_LastTramplePos.y, Pos.x, Pos.y);
+    m_LastTramplePos = Pos;
+
+    m_TrampleMask.Upload(m_pImmediateContext, m_TrampleBufferUploads ? m_TextureUpdateBuffer.RawPtr() : nullptr,
+                         MaxUpdateRegionSize, m_TextureUpdateBuffer->GetDesc().Size);
+    m_FrameCounters.UploadBytes += m_TrampleMask.GetStats().Bytes;
+}
+
+void Tutorial11_ResourceUpdates::Update(double CurrTime, double ElapsedTime, bool DoUpdateUI)
+{
+    // #Update() es lo primero de cada frame, asi que aqui se cierra el frame anterior del profiler
+    CpuProfiler::Get().EndFrame();
+    GRASS_PROFILE_SCOPE("Update");
+
+    // #Antes de leer el input: si la GPU tiene demasiados frames en cola se espera aca y no con
+    // el input ya leido
+    m_FramePacer.SetMeasureLatency(m_LatencyMode);
+    m_FramePacer.BeginFrame(m_pImmediateContext, static_cast<Uint32>(std::max(m_MaxFramesInFlight, 0)));
+
+    PollAsyncLoads(false);
+    GpuMemoryRegistry::Get().SetBudget(Uint64{static_cast<Uint32>(std::max(m_GpuMemoryBudgetMB, 0))} << 20);
+    GpuMemoryRegistry::Get().Update();
+
+    // #Desde aca hasta ScheduleSimulation() el hilo de simulacion esta parado y el estado de la
+    // simulacion se puede leer y cambiar (paging, UI, benchmark)
+    WaitForSimulation();
+    m_InteractionMs    = m_SimInteractionMs;
+    m_SimInteractionMs = 0;
+
+    const auto UpdateStart = std::chrono::high_resolution_clock::now();
+    if (m_BenchmarkFrames > 0)
+    {
+        RecordBenchmarkFrame(UpdateStart);
+
+        // #Un tick por frame para que todas las corridas simulen exactamente lo mismo
+        ElapsedTime = SimTimeStep;
+        CurrTime    = m_BenchmarkFrame * ElapsedTime;
+        ++m_BenchmarkFrame;
+    }
+    m_FrameCounters = {};
+
+    SampleBase::Update(CurrTime, ElapsedTime, DoUpdateUI);
+
+    m_CurrTime = CurrTime;
+
+    // #Los chunks que se descargan liberan su slot: se olvida el estado de sus tufts
+    m_GrassField.UpdatePaging(m_PlayerX, m_PlayerZ);
+    if (m_GrassField.GetPagingStats().Loaded > 0 || m_GrassField.GetPagingStats().Evicted > 0)
+        m_GpuCullTuftsDirty = true;
+    const auto& EvictedTufts = m_GrassField.GetEvictedTufts();
+    for (const auto& Evicted : EvictedTufts)
+    {
+        m_GrassDeform.ResetTufts(Evicted.FirstTuft, Evicted.NumTufts);
+        std::fill_n(m_TuftLOD.begin() + Evicted.FirstTuft, Evicted.NumTufts, Uint8{0});
+    }
+    if (!EvictedTufts.empty())
+    {
+        // #Los snapshots ya publicados tampoco pueden dejar bend en esos slots
+        const auto IsEvicted = [&EvictedTufts](const GrassDeformation::BentTuft& Bent) {
+            return std::any_of(EvictedTufts.begin(), EvictedTufts.end(),
+                               [&Bent](const GrassField::TuftRange& Range) { return Bent.Tuft - Range.FirstTuft < Range.NumTufts; });
+        };
+        for (auto& Snapshot : m_SimSnapshots)
+            Snapshot.BentTufts.erase(std::remove_if(Snapshot.BentTufts.begin(), Snapshot.BentTufts.end(), IsEvicted), Snapshot.BentTufts.end());
+    }
+    InterpolateSimSnapshots();
+    UpdateTrampleMask();
+
+    static constexpr const double UpdateBufferPeriod = 0.1;
+    if (CurrTime - m_LastBufferUpdateTime > UpdateBufferPeriod)
+    {
+        m_LastBufferUpdateTime = CurrTime;
+        UpdateBuffer(1);
+    }
+
+    UpdateScalingSweep();
+
+    if (DoUpdateUI && m_BenchmarkFrames == 0)
+        UpdateUI();
+
+    // #Los ticks de este frame corren mientras se dibuja
+    SimInput Input;
+    Input.ScriptedPath   = m_BenchmarkFrames > 0;
+    Input.BendKernel     = m_BendKernel;
+    Input.ParallelDeform = m_ParallelDeform;
+    if (!Input.ScriptedPath)
+    {
+        const auto& inputController = GetInputController();
+
+        // #Inputs del jugador
+        if (inputController.IsKeyDown(InputKeys::MoveForward))
+            Input.MoveDir.y -= 1.f;
+        if (inputController.IsKeyDown(InputKeys::MoveBackward))
+            Input.MoveDir.y += 1.f;
+
+        if (inputController.IsKeyDown(InputKeys::MoveRight))
+            Input.MoveDir.x -= 1.f;
+        if (inputController.IsKeyDown(InputKeys::MoveLeft))
+            Input.MoveDir.x += 1.f;
+    }
+    m_FramePacer.MarkInput();
+
+    // #Base del late latch: la simulacion esta parada, asi que m_PlayerX/Z es el ultimo tick. En
+    // el benchmark la direccion sale del camino, la del ultimo tick es la mejor estimacion
+    m_LatchBasePos = float2{m_PlayerX, m_PlayerZ};
+    m_LatchMoveDir = Input.ScriptedPath ? float2{m_PlayerMoveX, m_PlayerMoveZ} : Input.MoveDir;
+    ScheduleSimulation(ElapsedTime, Input);
+    // #Ese tick quedo m_SimTicksLastFrame ticks y m_SimAccumulator antes de ahora
+    const double LatchAhead = m_SimTicksLastFrame * SimTimeStep + m_SimAccumulator;
+    m_LatchBaseTime         = std::chrono::high_resolution_clock::now() -
+        std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(std::chrono::duration<double>(LatchAhead));
+
+    m_UpdateCPUTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - UpdateStart).count();
+}
+
+SampleBase::CommandLineStatus Tutorial11_ResourceUpdates::ProcessCommandLine(int argc, const char* const* argv)
+{
+    CommandLineParser ArgsParser{argc, argv};
+    ArgsParser.Parse("benchmark", m_BenchmarkFrames);
+    ArgsParser.Parse("benchmark_warmup", m_BenchmarkWarmup);
+    ArgsParser.Parse("benchmark_seed", m_BenchmarkSeed);
+    ArgsParser.Parse("benchmark_workers", m_BenchmarkWorkers);
+    ArgsParser.Parse("benchmark_output", m_BenchmarkOutput);
+    ArgsParser.Parse("shader_cache", m_ShaderCachePath);
+    ArgsParser.Parse("gpu_culling", m_UseGpuCulling);
+    ArgsParser.Parse("compact_vertices", m_CompactVertices);
+    ArgsParser.Parse("chunk_baking", m_UseChunkBaking);
+    ArgsParser.Parse("bake_distance", m_BakeDistance);
+    m_BakeDistance = std::max(m_BakeDistance, m_LODDistance[GrassNumLODs - 2]);
+    ArgsParser.Parse("agents", m_NumAgents);
+    ArgsParser.Parse("late_latch", m_LateLatch);
+    ArgsParser.Parse("max_frames_in_flight", m_MaxFramesInFlight);
+    ArgsParser.Parse("latency_mode", m_LatencyMode);
+    ArgsParser.Parse("gpu_budget_mb", m_GpuMemoryBudgetMB);
+    ArgsParser.Parse("capture", m_CapturePath);
+    ArgsParser.Parse("capture_every", m_CaptureConfig.Every);
+    ArgsParser.Parse("capture_format", m_CaptureFormat);
+    ArgsParser.Parse("capture_ring", m_CaptureConfig.RingSize);
+    ArgsParser.Parse("capture_drop", m_CaptureConfig.DropWhenBusy);
+    return CommandLineStatus::OK;
+}
+
+// #Se llama al principio de cada Update() con los datos del frame anterior
+void Tutorial11_ResourceUpdates::RecordBenchmarkFrame(std::chrono::high_resolution_clock::time_point UpdateStart)
+{
+    if (m_BenchmarkFrame > 0)
+    {
+        BenchmarkRecorder::FrameSample Sample;
+        Sample.CPUTimeMs   = m_UpdateCPUTimeMs + m_RenderCPUTimeMs;
+        Sample.FrameTimeMs = std::chrono::duration<double, std::milli>(UpdateStart - m_LastUpdateStart).count();
+        Sample.DrawCalls   = m_FrameCounters.DrawCalls;
+        Sample.UploadBytes = m_FrameCounters.UploadBytes;
+        Sample.BentTufts   = m_GrassDeform.GetStats().ActiveTufts;
+
+        Sample.InteractionMs = m_InteractionMs;
+        Sample.TuftTests     = m_GrassDeform.GetStats().TuftTests;
+
+        // #Solo los frames de los que se supo cuando termino la GPU desde la muestra anterior
+        Sample.FrameSlotWaitMs = m_FramePacer.GetWaitMs();
+        const auto& Latency    = m_FramePacer.GetLatencyStats().Last;
+        if (m_LatencyMode && Latency.Frame != m_LastLatencyFrame)
+        {
+            Sample.InputToPresentMs = Latency.InputToPresentMs;
+            Sample.InputToGpuMs     = Latency.InputToGpuMs;
+            m_LastLatencyFrame      = Latency.Frame;
+        }
+
+        Sample.GpuMemoryBytes = GpuMemoryRegistry::Get().GetTotalStats().Bytes;
+
+        Sample.TrampleRegions     = m_TrampleMask.GetStats().Regions;
+        Sample.TrampleUploadBytes = m_TrampleMask.GetStats().Bytes;
+        for (Uint32 p = 0; p < GpuPassQueries::PASS_COUNT; ++p)
+            Sample.GPUPasses[p] = m_GpuQueries.GetStats(static_cast<GpuPassQueries::PASS>(p));
+        m_BenchmarkRecorder.AddFrame(Sample);
+
+        if (m_BenchmarkRecorder.IsComplete())
+            FinishBenchmark();
+    }
+    m_LastUpdateStart = UpdateStart;
+}
+
+void Tutorial11_ResourceUpdates::FinishBenchmark()
+{
+    const auto Bool = [](bool b) { return std::string{b ? "true" : "false"}; };
+
+    // #Para dimensionar GrassConstantRingSize
+    Uint32 GrassRingPeak = 0;
+    for (const auto& Slot : m_GrassSlots)
+        GrassRingPeak = std::max(GrassRingPeak, Slot.VSConstants.GetStats().HighWaterBytes);
+
+    const auto& Registry = GpuMemoryRegistry::Get();
+
+    // #Antes de salir tienen que quedar escritos todos los frames capturados
+    const bool Capturing = m_FrameCapture.IsActive();
+    m_FrameCapture.Stop(m_pImmediateContext);
+    const auto CaptureStats = m_FrameCapture.GetStats();
+
+    std::vector<std::pair<std::string, std::string>> Info =
+        {
+            {"device", std::string{"\""} + GetRenderDeviceTypeString(m_pDevice->GetDeviceInfo().Type) + "\""},
+            {"seed", std::to_string(m_BenchmarkSeed)},
+            {"worker_threads", std::to_string(m_WorkerThreads.size())},
+            {"instancing", Bool(m_UseInstancing)},
+            {"lod", Bool(m_UseLOD)},
+            {"frustum_culling", Bool(m_FrustumCulling)},
+            {"bend_kernel", std::string{"\""} + GetGrassBendKernelName(m_BendKernel) + "\""},
+            {"tufts_per_side", std::to_string(m_GrassField.GetConfig().TuftsPerSide)},
+            {"resident_tufts", std::to_string(m_GrassField.GetTuftCapacity())},
+            {"gpu_timing", Bool(m_GpuQueries.IsTimingSupported())},
+            {"grass_constant_ring_bytes", std::to_string(GrassConstantRingSize)},
+            {"grass_constant_ring_peak_bytes", std::to_string(GrassRingPeak)},
+            {"gpu_pipeline_stats", Bool(m_GpuQueries.IsPipelineStatsSupported())},
+            {"startup_initialize_ms", std::to_string(m_StartupInitMs)},
+            {"startup_assets_ms", std::to_string(m_StartupLoadedMs)},
+            {"shader_cache_hits", std::to_string(m_ShaderCacheHits)},
+            {"shader_cache_misses", std::to_string(m_ShaderCacheMisses)},
+            {"shader_cache_saved_ms", std::to_string(m_ShaderCacheSavedMs)},
+            {"sim_time_step", std::to_string(SimTimeStep)},
+            {"trample_buffer_uploads", Bool(m_TrampleBufferUploads)},
+            {"compact_vertices", Bool(m_CompactVertices)},
+            {"grass_mesh_bytes", std::to_string(m_GrassMesh.Report.VertexBytes + m_GrassMesh.Report.IndexBytes)},
+            {"grass_mesh_max_position_error", std::to_string(m_GrassMesh.Report.MaxPosError)},
+            {"grass_mesh_acmr", std::to_string(m_GrassMesh.Report.ACMRAfter)},
+            {"agents", std::to_string(m_Agents.GetCount())},
+            {"late_latch", Bool(m_LateLatch)},
+            {"max_frames_in_flight", std::to_string(m_MaxFramesInFlight)},
+            {"latency_mode", Bool(m_LatencyMode)},
+            {"chunk_baking", Bool(m_UseChunkBaking)},
+            {"bake_distance", std::to_string(m_BakeDistance)},
+            {"gpu_culling", Bool(m_UseGpuCulling)},
+            {"gpu_culling_validated", Bool(m_GpuCulling.GetValidation().Done)},
+            {"gpu_culling_mismatches", std::to_string(m_GpuCulling.GetValidation().Mismatches)},
+            {"gpu_culling_max_error", std::to_string(m_GpuCulling.GetValidation().MaxError)},
+            {"gpu_memory_budget_mb", std::to_string(m_GpuMemoryBudgetMB)},
+            {"capture", Bool(Capturing)},
+            {"capture_every", std::to_string(m_FrameCapture.GetConfig().Every)},
+            {"capture_format", std::string{"\""} + FrameCapture::GetFormatName(m_FrameCapture.GetConfig().Format) + "\""},
+            {"capture_frames_written", std::to_string(CaptureStats.Written)},
+            {"capture_frames_dropped", std::to_string(CaptureStats.Dropped)},
+            {"capture_frames_failed", std::to_string(CaptureStats.Failed)},
+        };
+    // #"gpu_memory": {"Geometry": {"bytes": ..., "peak_bytes": ..., "resources": ...}, ..., "Total": {...}}
+    const auto MemoryJSON = [](const char* Name, const GpuMemoryRegistry::CategoryStats& Stats) {
+        return std::string{"\""} + Name + "\": {\"bytes\": " + std::to_string(Stats.Bytes) + ", \"peak_bytes\": " + std::to_string(Stats.PeakBytes) +
+            ", \"resources\": " + std::to_string(Stats.Resources) + "}";
+    };
+    std::string GpuMemory = "{";
+    for (Uint32 c = 0; c < GpuMemoryRegistry::CATEGORY_COUNT; ++c)
+    {
+        const auto Category = static_cast<GpuMemoryRegistry::CATEGORY>(c);
+        GpuMemory += MemoryJSON(GpuMemoryRegistry::GetCategoryName(Category), Registry.GetStats(Category)) + ", ";
+    }
+    GpuMemory += MemoryJSON("Total", Registry.GetTotalStats()) + "}";
+    Info.emplace_back("gpu_memory", GpuMemory);
+
+    const bool Written = m_BenchmarkRecorder.WriteJSON(m_BenchmarkOutput, Info);
+    if (Written)
+        LOG_INFO_MESSAGE("Benchmark results written to ", m_BenchmarkOutput);
+    else
+        LOG_ERROR_MESSAGE("Failed to write benchmark results to ", m_BenchmarkOutput);
+
+    // #SampleBase no tiene forma de pedirle a la app que se cierre, asi que se sale directamente.
+    // Antes hay que parar los hilos: std::exit destruye los singletons (CpuProfiler,
+    // GpuMemoryRegistry) que usan, y un std::thread sin join termina el proceso
+    Shutdown();
+    std::exit(Written ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+// #Empuja los tufts que pisan el jugador y los NPCs y avanza el resorte de todos los tufts
+// activos un tick
+void Tutorial11_ResourceUpdates::UpdateGrassDeformation(GrassBendKernel Kernel, bool Parallel)
+{
+    GRASS_PROFILE_SCOPE("UpdateGrassDeformation");
+    const auto StartTime = std::chrono::high_resolution_clock::now();
+
+    float3 vel    = m_PlayerVel;
+    float  velLen = std::sqrt(vel.x * vel.x + vel.z * vel.z);
+    if (velLen > 1e-4f)
+        vel /= velLen;
+
+    // #La forma del bend es la misma para todos; la posicion, la velocidad y el radio son de cada cuerpo
+    const GrassBendParams BendParams;
+
+    m_Interactors.clear();
+    m_Interactors.push_back({m_PlayerX, m_PlayerZ, vel.x, vel.z, BendParams.Radius});
+    m_Agents.AppendInteractors(m_Interactors);
+
+    // #Celdas del tamano de un chunk: cada chunk consulta una o pocas celdas
+    const auto& FieldCfg = m_GrassField.GetConfig();
+    m_InteractorGrid.Build(m_Interactors, static_cast<float>(FieldCfg.ChunkSize) * FieldCfg.Spacing);
+
+    m_GrassDeform.Step(m_GrassField, Kernel, BendParams, m_InteractorGrid, static_cast<float>(SimTimeStep),
+                       Parallel ? m_pThreadPool.RawPtr() : nullptr, m_NumPoolThreads);
+    m_SimInteractionMs += m_GrassDeform.GetStats().DisturbMs;
+
+    m_DeformCPUTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+}
+
+// #Barrido de escalado: mide el tiempo de CPU del pasto con 0, 1, ..., N workers (0 = todo en
+// el immediate context), ScalingSweepFrames frames cada uno, y deja los resultados en el log y la UI
+void Tutorial11_ResourceUpdates::UpdateScalingSweep()
+{
+    if (m_SweepThreads < 0)
+        return;
+
+    if (m_SweepFrame >= ScalingSweepWarmupFrames)
+        m_SweepAccumMs += m_GrassCPUTimeMs;
+    if (++m_SweepFrame < ScalingSweepWarmupFrames + ScalingSweepFrames)
+        return;
+
+    const double AvgMs                     = m_SweepAccumMs / ScalingSweepFrames;
+    m_GrassCPUTimeByThreads[m_SweepThreads] = AvgMs;
+    LOG_INFO_MESSAGE("Grass CPU time with ", m_SweepThreads, " worker thread(s): ", AvgMs, " ms (speed-up vs serial: ",
+                     m_GrassCPUTimeByThreads[0] / AvgMs, "x)");
+
+    m_SweepFrame   = 0;
+    m_SweepAccumMs = 0;
+    ++m_SweepThreads;
+    if (m_SweepThreads > static_cast<int>(m_MaxWorkerThreads))
+    {
+        m_SweepThreads     = -1;
+        m_NumWorkerThreads = m_SweepRestoreThreads;
+    }
+    else
+    {
+        m_NumWorkerThreads = m_SweepThreads;
+    }
+    StopWorkerThreads();
+    StartWorkerThreads(m_NumWorkerThreads);
+}
+
+void Tutorial11_ResourceUpdates::UpdateUI()
+{
+    ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Settings", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
+    {
+        if (m_Startup)
+            ImGui::TextDisabled("Loading shaders and textures...");
+
+        // #Permite comparar tiempos de frame entre los dos caminos
+        ImGui::Checkbox("Instanced grass", &m_UseInstancing);
+        ImGui::Checkbox("Frustum culling", &m_FrustumCulling);
+        ImGui::BeginDisabled(!m_GpuCullingSupported || !m_UseInstancing);
+        ImGui::Checkbox("GPU culling", &m_UseGpuCulling);
+        ImGui::SameLine();
+        if (ImGui::Button("Validate"))
+            m_ValidateGpuCulling = true;
+        ImGui::EndDisabled();
+        if (m_GpuCulling.GetValidation().Done)
+        {
+            const auto& Result = m_GpuCulling.GetValidation();
+            ImGui::Text("GPU vs CPU culling: %u mismatches, max error %.2e", Result.Mismatches, Result.MaxError);
+        }
+        // #Capas del texture array que se reparten entre los tufts
+        ImGui::SliderInt("Grass textures", &m_NumGrassVariants, 1, static_cast<int>(NumTextures - FirstGrassTextureSlice));
+
+        bool ProfilerEnabled = CpuProfiler::IsEnabled();
+        if (ImGui::Checkbox("CPU profiler", &ProfilerEnabled))
+            CpuProfiler::SetEnabled(ProfilerEnabled);
+        ImGui::SameLine();
+        ImGui::Checkbox("Show profiler", &m_ShowProfiler);
+
+        if (m_MaxWorkerThreads > 0)
+        {
+            ImGui::BeginDisabled(m_SweepThreads >= 0);
+            if (ImGui::SliderInt("Worker threads", &m_NumWorkerThreads, 0, static_cast<int>(m_MaxWorkerThreads)))
+            {
+                StopWorkerThreads();
+                StartWorkerThreads(m_NumWorkerThreads);
+            }
+            if (ImGui::Button("Measure thread scaling"))
+            {
+                m_SweepRestoreThreads = m_NumWorkerThreads;
+                m_SweepThreads        = 0;
+                m_SweepFrame          = 0;
+                m_SweepAccumMs        = 0;
+                m_NumWorkerThreads    = 0;
+                m_GrassCPUTimeByThreads.assign(m_MaxWorkerThreads + 1, -1.0);
+                StopWorkerThreads();
+            }
+            ImGui::EndDisabled();
+
+            ImGui::Text("Grass CPU time: %.3f ms", m_GrassCPUTimeMs);
+            for (size_t t = 0; t < m_GrassCPUTimeByThreads.size(); ++t)
+            {
+                if (m_GrassCPUTimeByThreads[t] >= 0)
+                    ImGui::Text("  %u workers: %.3f ms (%.2fx)", static_cast<Uint32>(t), m_GrassCPUTimeByThreads[t], m_GrassCPUTimeByThreads[0] / m_GrassCPUTimeByThreads[t]);
+            }
+        }
+
+        if (ImGui::BeginCombo("Bend kernel", GetGrassBendKernelName(m_BendKernel)))
+        {
+            for (Uint8 k = 0; k < static_cast<Uint8>(GrassBendKernel::Count); ++k)
+            {
+                const auto Kernel = static_cast<GrassBendKernel>(k);
+                if (!IsGrassBendKernelSupported(Kernel))
+                    continue;
+                if (ImGui::Selectable(GetGrassBendKernelName(Kernel), Kernel == m_BendKernel))
+                    m_BendKernel = Kernel;
+            }
+            ImGui::EndCombo();
+        }
+
+        const auto& Stats = m_GrassCullStats;
+        ImGui::Text("Chunks: %u tested, %u visible, %u culled", Stats.ChunksTested, Stats.ChunksVisible, Stats.ChunksCulled);
+        ImGui::Text("Tufts:  %u tested, %u visible, %u culled", Stats.TuftsTested, Stats.TuftsVisible, Stats.TuftsCulled);
+
+        if (ImGui::CollapsingHeader("Field"))
+        {
+            int TuftsPerSide = static_cast<int>(m_FieldConfig.TuftsPerSide);
+            if (ImGui::InputInt("Tufts per side", &TuftsPerSide, 10, 1000))
+                m_FieldConfig.TuftsPerSide = static_cast<Uint32>(clamp(TuftsPerSide, 1, 100000));
+            ImGui::SliderFloat("Spacing", &m_FieldConfig.Spacing, 0.25f, 4.f);
+            int ChunkSize = static_cast<int>(m_FieldConfig.ChunkSize);
+            if (ImGui::SliderInt("Chunk size", &ChunkSize, 2, 32))
+                m_FieldConfig.ChunkSize = static_cast<Uint32>(ChunkSize);
+            ImGui::SliderFloat("Page radius (0 = all)", &m_FieldConfig.PageRadius, 0.f, 200.f);
+            int BudgetMB = static_cast<int>(m_FieldConfig.MemoryBudgetMB);
+            if (ImGui::SliderInt("Memory budget (MB)", &BudgetMB, 1, 1024))
+                m_FieldConfig.MemoryBudgetMB = static_cast<Uint32>(BudgetMB);
+            ImGui::Text("Density: %.2f tufts per unit^2", 1.f / (m_FieldConfig.Spacing * m_FieldConfig.Spacing));
+
+            if (ImGui::Button("Small field"))
+            {
+                m_FieldConfig         = GrassField::Config{};
+                m_CameraFollowsPlayer = false;
+                InitializeGrassField();
+                ResetAgents();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Large world"))
+            {
+                // #16M tufts posibles, solo se cargan los que estan cerca del jugador
+                m_FieldConfig              = GrassField::Config{};
+                m_FieldConfig.TuftsPerSide = 4000;
+                m_FieldConfig.PageRadius   = 60.f;
+                m_CameraFollowsPlayer      = true;
+                InitializeGrassField();
+                ResetAgents();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Apply"))
+            {
+                InitializeGrassField();
+                ResetAgents();
+            }
+            ImGui::Checkbox("Camera follows player", &m_CameraFollowsPlayer);
+
+            const auto& Paging = m_GrassField.GetPagingStats();
+            ImGui::Text("Chunks: %u resident (max %u), %u pending, %u total", Paging.ResidentChunks, Paging.MaxResidentChunks, Paging.PendingChunks, Paging.TotalChunks);
+            ImGui::Text("Tufts: %llu in the world", static_cast<unsigned long long>(Paging.TotalTufts));
+            ImGui::Text("Memory: %.1f / %.1f MB", Paging.ResidentBytes / double{1 << 20}, Paging.BudgetBytes / double{1 << 20});
+        }
+
+        if (ImGui::CollapsingHeader("LOD"))
+        {
+            ImGui::Checkbox("Use LOD", &m_UseLOD);
+            ImGui::Checkbox("Color by LOD", &m_LODDebugView);
+            ImGui::SliderFloat("LOD 1 distance", &m_LODDistance[0], 5.f, 150.f);
+            if (ImGui::SliderFloat("LOD 2 distance", &m_LODDistance[1], m_LODDistance[0], 200.f))
+                m_BakeDistance = std::max(m_BakeDistance, m_LODDistance[GrassNumLODs - 2]);
+            ImGui::SliderFloat("Hysteresis", &m_LODHysteresis, 0.f, 10.f);
+            for (Uint32 LOD = 0; LOD < GrassNumLODs; ++LOD)
+            {
+                const auto& Stats = m_LODStats[LOD];
+                ImGui::Text("LOD %u: %u draws, %u tufts, %llu tris", LOD, Stats.Draws, Stats.Tufts, static_cast<unsigned long long>(Stats.Triangles));
+            }
+        }
+
+        if (ImGui::CollapsingHeader("Meshes"))
+        {
+            // #El formato se elige al arrancar (--compact_vertices) porque cambia el input layout
+            ImGui::Text("Vertex format: %s", GetMeshVertexFormatName(m_GrassMesh.Format));
+            for (const auto* pMesh : {&m_GrassMesh, &m_PlayerMesh, &m_GroundMesh})
+            {
+                const auto& Report = pMesh->Report;
+                ImGui::Text("%s: %u B (float32: %u B), %s indices", pMesh->Name, Report.VertexBytes + Report.IndexBytes, Report.Float32Bytes,
+                            pMesh->IndexType == VT_UINT16 ? "16-bit" : "32-bit");
+                ImGui::Text("  max error: position %.2e, UV %.2e", Report.MaxPosError, Report.MaxUVError);
+                ImGui::Text("  %u -> %u vertices, ACMR %.2f -> %.2f", Report.InputVertices, pMesh->NumVertices, Report.ACMRBefore, Report.ACMRAfter);
+            }
+
+            ImGui::Separator();
+            // #Solo en el camino de la CPU: con culling en la GPU no se hornea nada
+            ImGui::Checkbox("Bake distant chunks", &m_UseChunkBaking);
+            if (ImGui::SliderFloat("Bake distance", &m_BakeDistance, m_LODDistance[GrassNumLODs - 2], 200.f))
+                m_BakeDistance = std::max(m_BakeDistance, m_LODDistance[GrassNumLODs - 2]);
+            ImGui::TextDisabled("Baked chunks are LOD 2 cards without wind sway");
+            const auto& BakeStats = m_ChunkBaker.GetStats();
+            ImGui::Text("Baked: %u chunks, %u tufts, %u draws", static_cast<Uint32>(m_BakedChunksToDraw.size()), m_BakedTufts, m_BakedDraws);
+            ImGui::Text("Cache: %u chunks, %.2f MB, %u baked this frame", BakeStats.CachedChunks,
+                        static_cast<double>(BakeStats.CachedBytes) / (1 << 20), BakeStats.BakedLastFrame);
+        }
+
+        if (ImGui::CollapsingHeader("Deformation"))
+        {
+            auto& Params = m_GrassDeform.GetParams();
+            ImGui::Checkbox("Parallel simulation", &m_ParallelDeform);
+            ImGui::SliderFloat("Push stiffness", &Params.PushStiffness, 10.f, 400.f);
+            ImGui::SliderFloat("Push damping", &Params.PushDamping, 0.f, 40.f);
+            ImGui::SliderFloat("Recover delay", &Params.RecoverDelay, 0.f, 10.f);
+            ImGui::SliderFloat("Recover stiffness", &Params.RecoverStiffness, 0.1f, 40.f);
+            ImGui::SliderFloat("Recover damping", &Params.RecoverDamping, 0.f, 20.f);
+
+            const auto& Stats = m_GrassDeform.GetStats();
+            ImGui::Text("Active tufts: %u (+%u, -%u)", Stats.ActiveTufts, Stats.Activated, Stats.Deactivated);
+            ImGui::Text("Tasks: %u, %.3f ms", Stats.Tasks, m_DeformCPUTimeMs);
+            ImGui::Text("Simulation: %.0f Hz, %u ticks last frame, %.3f ms per tick", 1.0 / SimTimeStep, m_SimTicksLastFrame, m_SimTickMs);
+            ImGui::Text("Main thread waited %.3f ms for the simulation", m_SimWaitMs);
+        }
+
+        if (ImGui::CollapsingHeader("Interactors"))
+        {
+            // #La UI corre con la simulacion parada, asi que los NPCs se pueden volver a crear aca
+            if (ImGui::SliderInt("NPC agents", &m_NumAgents, 0, 4000))
+                ResetAgents();
+            if (ImGui::Button("Stress test"))
+            {
+                m_NumAgents = StressTestAgents;
+                ResetAgents();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("No agents"))
+            {
+                m_NumAgents = 0;
+                ResetAgents();
+            }
+            auto& AgentParams = m_Agents.GetParams();
+            ImGui::SliderFloat("Agent speed", &AgentParams.Speed, 0.f, 6.f);
+            ImGui::SliderFloat("Agent radius", &AgentParams.Radius, 0.2f, 4.f);
+            ImGui::Checkbox("Draw agents", &m_DrawAgents);
+
+            const auto& Stats     = m_GrassDeform.GetStats();
+            const auto& GridStats = m_InteractorGrid.GetStats();
+            ImGui::Text("Bodies: %u, %u cell entries in %u/%u buckets", Stats.Interactors, GridStats.Entries, GridStats.UsedBuckets, GridStats.Buckets);
+            ImGui::Text("Chunks touched: %u, chunk-body pairs: %u", Stats.ChunksTouched, Stats.CandidatePairs);
+            ImGui::Text("Tuft tests: %u per tick", Stats.TuftTests);
+            ImGui::Text("Interaction: %.3f ms per frame (%.3f ms last tick)", m_InteractionMs, Stats.DisturbMs);
+        }
+
+        if (ImGui::CollapsingHeader("Latency"))
+        {
+            ImGui::Checkbox("Late-latch player", &m_LateLatch);
+            // #0 = sin limite propio, solo el del swap chain
+            ImGui::SliderInt("Max frames in flight", &m_MaxFramesInFlight, 0, 3);
+            ImGui::Checkbox("Measure input latency", &m_LatencyMode);
+            ImGui::Text("Frames in flight: %u, waited %.3f ms", m_FramePacer.GetFramesInFlight(), m_FramePacer.GetWaitMs());
+
+            const auto& Latency = m_FramePacer.GetLatencyStats();
+            if (m_LatencyMode && Latency.Frames > 0)
+            {
+                // #Promedio y maximo de los ultimos Latency.Frames frames
+                ImGui::Text("Input -> latch:   %.2f ms (max %.2f)", Latency.Avg.InputToLatchMs, Latency.Max.InputToLatchMs);
+                ImGui::Text("Input -> submit:  %.2f ms (max %.2f)", Latency.Avg.InputToSubmitMs, Latency.Max.InputToSubmitMs);
+                ImGui::Text("Input -> Present: %.2f ms (max %.2f)", Latency.Avg.InputToPresentMs, Latency.Max.InputToPresentMs);
+                ImGui::Text("Input -> GPU done: %.2f ms (max %.2f)", Latency.Avg.InputToGpuMs, Latency.Max.InputToGpuMs);
+            }
+        }
+
+        if (ImGui::CollapsingHeader("GPU memory"))
+        {
+            // #Estimacion de GpuMemoryRegistry: no incluye el swap chain ni el padding del driver
+            auto& Registry = GpuMemoryRegistry::Get();
+            ImGui::SliderInt("Budget (MB)", &m_GpuMemoryBudgetMB, 0, 2048);
+            if (ImGui::BeginTable("GPU memory", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+            {
+                ImGui::TableSetupColumn("Category");
+                ImGui::TableSetupColumn("MB");
+                ImGui::TableSetupColumn("Peak MB");
+                ImGui::TableSetupColumn("Resources");
+                ImGui::TableHeadersRow();
+                const auto AddRow = [](const char* Name, const GpuMemoryRegistry::CategoryStats& Stats) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(Name);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.2f", static_cast<double>(Stats.Bytes) / (1 << 20));
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.2f", static_cast<double>(Stats.PeakBytes) / (1 << 20));
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%u", Stats.Resources);
+                };
+                for (Uint32 c = 0; c < GpuMemoryRegistry::CATEGORY_COUNT; ++c)
+                {
+                    const auto Category = static_cast<GpuMemoryRegistry::CATEGORY>(c);
+                    AddRow(GpuMemoryRegistry::GetCategoryName(Category), Registry.GetStats(Category));
+                }
+                AddRow("Total", Registry.GetTotalStats());
+                ImGui::EndTable();
+            }
+            if (Registry.IsOverBudget())
+                ImGui::TextColored(ImVec4{1.f, 0.5f, 0.2f, 1.f}, "Over budget by %.2f MB", static_cast<double>(Registry.GetTotalStats().Bytes - Registry.GetBudget()) / (1 << 20));
+            if (ImGui::Button("Reset memory peaks"))
+                Registry.ResetPeaks();
+        }
+
+        if (ImGui::CollapsingHeader("Frame capture"))
+        {
+            const bool Capturing = m_FrameCapture.IsActive();
+            ImGui::BeginDisabled(Capturing);
+            int Every = static_cast<int>(m_CaptureConfig.Every);
+            if (ImGui::SliderInt("Capture every", &Every, 1, 60))
+                m_CaptureConfig.Every = static_cast<Uint32>(Every);
+            int RingSize = static_cast<int>(m_CaptureConfig.RingSize);
+            if (ImGui::SliderInt("Staging textures", &RingSize, 2, 16))
+                m_CaptureConfig.RingSize = static_cast<Uint32>(RingSize);
+            if (ImGui::BeginCombo("Format", FrameCapture::GetFormatName(m_CaptureConfig.Format)))
+            {
+                for (Uint32 f = 0; f < FrameCapture::FORMAT_COUNT; ++f)
+                {
+                    const auto Format = static_cast<FrameCapture::FORMAT>(f);
+                    if (ImGui::Selectable(FrameCapture::GetFormatName(Format), Format == m_CaptureConfig.Format))
+                        m_CaptureConfig.Format = Format;
+                }
+                ImGui::EndCombo();
+            }
+            // #Sin descartar, un encoder lento frena el frame rate en vez de perder frames
+            ImGui::Checkbox("Drop frames when busy", &m_CaptureConfig.DropWhenBusy);
+            ImGui::EndDisabled();
+
+            if (ImGui::Button(Capturing ? "Stop capture" : "Start capture"))
+            {
+                if (Capturing)
+                    m_FrameCapture.Stop(m_pImmediateContext);
+                else
+                    m_FrameCapture.Start(m_pDevice, m_CaptureConfig);
+            }
+            ImGui::SameLine();
+            ImGui::TextUnformatted(m_CaptureConfig.Directory.c_str());
+
+            const auto Stats = m_FrameCapture.GetStats();
+            ImGui::Text("Written: %llu, dropped: %llu, failed: %llu", static_cast<unsigned long long>(Stats.Written),
+                        static_cast<unsigned long long>(Stats.Dropped), static_cast<unsigned long long>(Stats.Failed));
+            ImGui::Text("In flight: %u copying, %u encoding, %.2f ms per frame", Stats.Copying, Stats.Encoding, Stats.EncodeMs);
+            if (Stats.WaitMs > 0)
+                ImGui::Text("Waited %.3f ms for a free staging texture", Stats.WaitMs);
+        }
+
+        if (ImGui::CollapsingHeader("Trample mask"))
+        {
+            ImGui::Checkbox("Paint footprints", &m_UseTrampleMask);
+            ImGui::SliderFloat("Trample strength", &m_TrampleStrength, 0.f, 1.f);
+            if (ImGui::Button("Clear footprints"))
+                m_TrampleMask.Clear();
+
+            const auto& Stats = m_TrampleMask.GetStats();
+            ImGui::Text("Upload: %u regions (%u tiles), %llu bytes", Stats.Regions, Stats.Tiles, static_cast<unsigned long long>(Stats.Bytes));
+            ImGui::Text("Pending tiles: %u, %s", Stats.PendingTiles, m_TrampleBufferUploads ? "via staging buffer" : "direct UpdateTexture");
+        }
+
+        if (ImGui::CollapsingHeader("Wind"))
+        {
+            ImGui::SliderFloat("Idle frequency", &m_Wind.IdleFrequency, 0.f, 5.f);
+            ImGui::SliderFloat("Idle amplitude", &m_Wind.IdleAmplitude, 0.f, 4.f);
+            ImGui::SliderFloat("Time scale", &m_Wind.TimeScale, 0.f, 3.f);
+            ImGui::SliderFloat("Base amplitude", &m_Wind.BaseAmplitude, 0.f, 0.3f);
+            ImGui::SliderFloat("Height scale", &m_Wind.HeightScale, 0.f, 1.f);
+            ImGui::SliderFloat("Height gain", &m_Wind.HeightGain, 0.f, 4.f);
+            ImGui::SliderFloat("Height bias", &m_Wind.HeightBias, 0.f, 1.f);
+            ImGui::SliderFloat("Tall blade boost", &m_Wind.TallBladeBoost, 0.f, 3.f);
+            ImGui::SliderFloat("Phase per vertex", &m_Wind.PhasePerVertex, 0.f, 2.f);
+            ImGui::SliderFloat("Tilt", &m_Wind.Tilt, 0.f, 0.2f);
+            ImGui::SliderAngle("Direction", &m_Wind.DirectionAngle);
+            ImGui::SliderFloat2("Noise scroll", &m_Wind.NoiseScroll.x, -0.5f, 0.5f);
+            ImGui::SliderFloat("Noise frequency", &m_Wind.NoiseFrequency, 0.f, 0.2f);
+            ImGui::SliderFloat("Noise strength", &m_Wind.NoiseStrength, 0.f, 1.f);
+            ImGui::SliderFloat("Noise phase", &m_Wind.NoisePhase, 0.f, 2.f * PI_F);
+        }
+    }
+    ImGui::End();
+
+    if (m_ShowProfiler)
+        UpdateProfilerUI();
+}
+
+// #Tabla de zonas del profiler de CPU (promedio de las ultimas CpuProfiler::StatsWindow frames),
+// pasadas de GPU y export del trace
+void Tutorial11_ResourceUpdates::UpdateProfilerUI()
+{
+    auto& Profiler = CpuProfiler::Get();
+
+    ImGui::SetNextWindowPos(ImVec2(10, 420), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Profiler", &m_ShowProfiler, ImGuiWindowFlags_AlwaysAutoResize))
+    {
+        Profiler.GetZoneStats(m_ZoneStats);
+        if (ImGui::BeginTable("Zones", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+        {
+            ImGui::TableSetupColumn("Zone");
+            ImGui::TableSetupColumn("Avg ms");
+            ImGui::TableSetupColumn("Max ms");
+            ImGui::TableSetupColumn("Calls");
+            ImGui::TableHeadersRow();
+            for (const auto& Zone : m_ZoneStats)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(Zone.Name);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", Zone.AvgMs);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", Zone.MaxMs);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", Zone.CallsPerFrame);
+            }
+            ImGui::EndTable();
+        }
+        if (Profiler.GetDroppedEvents() > 0)
+            ImGui::TextColored(ImVec4{1.f, 0.5f, 0.2f, 1.f}, "Dropped events: %llu", static_cast<unsigned long long>(Profiler.GetDroppedEvents()));
+
+        ImGui::Separator();
+        UpdateGpuPassesUI();
+        ImGui::Separator();
+        UpdateConstantRingsUI();
+        ImGui::Separator();
+
+        const int MaxFrames = std::max(static_cast<int>(Profiler.GetHistorySize()), 1);
+        m_TraceExportFrames = std::min(m_TraceExportFrames, MaxFrames);
+        ImGui::SliderInt("Frames", &m_TraceExportFrames, 1, MaxFrames);
+        if (ImGui::Button("Export Chrome trace"))
+        {
+            if (Profiler.ExportChromeTrace(m_TracePath, static_cast<Uint32>(m_TraceExportFrames)))
+                LOG_INFO_MESSAGE("Exported ", m_TraceExportFrames, " frames of CPU profile to ", m_TracePath);
+            else
+                LOG_ERROR_MESSAGE("Failed to write CPU profile to ", m_TracePath);
+        }
+    }
+    ImGui::End();
+}
+
+// #Uso de los rings de constantes. Si el pico de un ring pasa su capacidad hay DISCARD extra
+// (overflows) y conviene agrandar GrassConstantRingSize
+void Tutorial11_ResourceUpdates::UpdateConstantRingsUI()
+{
+    const auto& Scene = m_SceneConstants.GetStats();
+    ImGui::Text("Scene constants: %u B, peak %u / %u B", Scene.FrameBytes, Scene.HighWaterBytes, Scene.Capacity);
+
+    // #Slot 0 solo se usa cuando no hay workers
+    Uint32 GrassBytes = 0, GrassMaps = 0, GrassPeak = 0, GrassCapacity = 0;
+    Uint64 GrassOverflows = 0;
+    for (size_t s = m_WorkerThreads.empty() ? 0 : 1; s <= m_WorkerThreads.size() && s < m_GrassSlots.size(); ++s)
+    {
+        const auto& Stats = m_GrassSlots[s].VSConstants.GetStats();
+        GrassBytes += Stats.FrameBytes;
+        GrassMaps += Stats.FrameMaps;
+        GrassPeak     = std::max(GrassPeak, Stats.HighWaterBytes);
+        GrassCapacity = Stats.Capacity;
+        GrassOverflows += Stats.Overflows;
+    }
+    ImGui::Text("Grass constants: %u B in %u maps, peak per ring %u / %u B", GrassBytes, GrassMaps, GrassPeak, GrassCapacity);
+    if (GrassOverflows > 0)
+        ImGui::TextColored(ImVec4{1.f, 0.5f, 0.2f, 1.f}, "Ring overflows: %llu", static_cast<unsigned long long>(GrassOverflows));
+
+    if (ImGui::Button("Reset peaks"))
+    {
+        m_SceneConstants.ResetHighWater();
+        for (auto& Slot : m_GrassSlots)
+            Slot.VSConstants.ResetHighWater();
+    }
+}
+
+// #Tabla de pasadas de GPU. PS/pixel es PSInvocations / pixeles de la pantalla: mas de 1 es overdraw
+void Tutorial11_ResourceUpdates::UpdateGpuPassesUI()
+{
+    if (!m_GpuQueries.IsTimingSupported() && !m_GpuQueries.IsPipelineStatsSupported())
+    {
+        ImGui::TextDisabled("GPU queries are not supported by this device");
+        return;
+    }
+
+    const auto&  SCDesc    = m_pSwapChain->GetDesc();
+    const double NumPixels = std::max(double{SCDesc.Width} * double{SCDesc.Height}, 1.0);
+    if (ImGui::BeginTable("GPU passes", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Pass");
+        ImGui::TableSetupColumn("GPU ms");
+        ImGui::TableSetupColumn("VS invocations");
+        ImGui::TableSetupColumn("Primitives");
+        ImGui::TableSetupColumn("PS invocations");
+        ImGui::TableSetupColumn("PS/pixel");
+        ImGui::TableHeadersRow();
+        for (Uint32 p = 0; p < GpuPassQueries::PASS_COUNT; ++p)
+        {
+            const auto  Pass  = static_cast<GpuPassQueries::PASS>(p);
+            const auto& Stats = m_GpuQueries.GetStats(Pass);
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(GpuPassQueries::GetPassName(Pass));
+            ImGui::TableNextColumn();
+            if (Stats.GPUTimeMs >= 0)
+                ImGui::Text("%.3f", Stats.GPUTimeMs);
+            else
+                ImGui::TextDisabled("n/a");
+            if (Stats.HasPipelineStats)
+            {
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(Stats.VSInvocations));
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(Stats.ClippingPrimitives));
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(Stats.PSInvocations));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", static_cast<double>(Stats.PSInvocations) / NumPixels);
+            }
+            else
+            {
+                for (int c = 0; c < 4; ++c)
+                {
+                    ImGui::TableNextColumn();
+                    ImGui::TextDisabled("n/a");
+                }
+            }
+        }
+        ImGui::EndTable();
+    }
+    if (!m_WorkerThreads.empty() && m_GpuQueries.IsPipelineStatsSupported())
+        ImGui::TextDisabled("Grass pipeline statistics need 0 worker threads");
 }
 
 } // namespace Diligent
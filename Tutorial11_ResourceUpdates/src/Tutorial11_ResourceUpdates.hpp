@@ -28,9 +28,35 @@
 #pragma once
 
 #include <array>
+#include <vector>
 #include <random>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <functional>
 #include "SampleBase.hpp"
+#include "TextureLoader.h"
 #include "BasicMath.hpp"
+#include "ThreadSignal.hpp"
+#include "GrassField.hpp"
+#include "GrassBend.hpp"
+#include "GrassDeformation.hpp"
+#include "GrassInteractors.hpp"
+#include "Benchmark.hpp"
+#include "CpuProfiler.hpp"
+#include "GpuPassQueries.hpp"
+#include "TransientConstantRing.hpp"
+#include "ShaderStateCache.hpp"
+#include "GrassGpuCulling.hpp"
+#include "TrampleMask.hpp"
+#include "MeshBuilder.hpp"
+#include "GrassChunkBaker.hpp"
+#include "FramePacer.hpp"
+#include "FrameCapture.hpp"
 
 namespace Diligent
 {
@@ -38,6 +64,10 @@ namespace Diligent
 class Tutorial11_ResourceUpdates final : public SampleBase
 {
 public:
+    ~Tutorial11_ResourceUpdates() override;
+
+    virtual CommandLineStatus ProcessCommandLine(int argc, const char* const* argv) override final;
+    virtual void              ModifyEngineInitInfo(const ModifyEngineInitInfoAttribs& Attribs) override final;
     virtual void Initialize(const SampleInitInfo& InitInfo) override final;
 
     virtual void Render() override final;
@@ -46,42 +76,322 @@ public:
     virtual const Char* GetSampleName() const override final { return "Tutorial11: Resource Updates"; }
 
 private:
-    void CreatePipelineStates();
+    struct StartupLoads;
+    void CreatePipelineStates(Uint32 Phase, const SwapChainDesc& SCDesc, StartupLoads& Loads);
+    void BuildMeshes();
     void CreateVertexBuffers();
     void CreateIndexBuffer();
-    void LoadTextures();    
 
     void UpdateBuffer(Uint32 BufferIndex);
-    void MapDynamicBuffer(Uint32 BufferIndex);
+    void UpdateUI();
+    void UpdateProfilerUI();
+    void UpdateGpuPassesUI();
+    void UpdateConstantRingsUI();
 
     // #Crea el jugador que se mueve como tal funcitones diferentes que el pasto
     void CreatePlayerCube();
-    void DrawPlayerCube(const float4x4& WVPMatrix, IShaderResourceBinding* pSRB);
+    void DrawPlayerCube(const float4x4& WVPMatrix, Uint32 TextureSlice);
 
     // #Actualiza la posicion del jugador
     void UpdatePlayerVelocity(float dt);
+    void UpdateGrassDeformation(GrassBendKernel Kernel, bool Parallel);
 
     // #El piso
     void CreateGroundPlane();
-    void DrawGroundPlane(const float4x4& WVPMatrix, IShaderResourceBinding* pSRB);
+    void DrawGroundPlane(const float4x4& WVPMatrix, const float4& WorldXZ, Uint32 TextureSlice);
     RefCntAutoPtr<IBuffer> m_GroundPlaneVertexBuffer;
     RefCntAutoPtr<IBuffer> m_GroundPlaneIndexBuffer;
 
+    // #Mallas ya convertidas al formato de los vertex buffers (ver MeshBuilder). El formato se
+    // elige con --compact_vertices antes de crear los PSOs, porque cambia el input layout
+    bool       m_CompactVertices = true;
+    PackedMesh m_GrassMesh;
+    PackedMesh m_PlayerMesh;
+    PackedMesh m_GroundMesh;
+
     RefCntAutoPtr<IPipelineState> m_pPSO, m_pPSO_NoCull;
     RefCntAutoPtr<IBuffer>        m_CubeVertexBuffer[3];
     RefCntAutoPtr<IBuffer>        m_CubeIndexBuffer;
-    RefCntAutoPtr<IBuffer>        m_VSConstants;
     RefCntAutoPtr<IBuffer>        m_TextureUpdateBuffer;
 
+    // #Constantes del piso y del jugador (immediate context)
+    TransientConstantRing m_SceneConstants;
+    // #Bytes de cada ring de constantes del pasto: 1024 draws con alineacion de 256 bytes
+    static constexpr Uint32 GrassConstantRingSize = 256 << 10;
+
+    // #Pasto instanciado: todo el campo en un solo DrawIndexed
+    struct GrassInstance
+    {
+        float4x4 World;
+        float4   Bend; // #x = bend en X, y = bend en Z, z = LOD, w = capa del texture array
+    };
+
+    // #LODs del pasto: 0 = malla completa, 1 = solo los quads altos, 2 = una tarjeta hacia la camara
+    static constexpr const Uint32 GrassNumLODs = 3;
+    static_assert(GrassNumLODs == GrassGpuCulling::NumLODs && sizeof(GrassInstance) == sizeof(GrassGpuCulling::Instance),
+                  "grass_cull.csh writes instances with the layout of GrassInstance");
+
+    struct LODStats
+    {
+        Uint32 Draws     = 0;
+        Uint32 Tufts     = 0;
+        Uint64 Triangles = 0;
+    };
+    Uint32 SelectGrassLOD(Uint32 CurrLOD, float Distance) const;
+
+    // #Todo lo que un contexto (immediate o deferred) escribe mientras graba pasto. Cada hilo
+    // tiene el suyo, asi nadie comparte constant buffers ni listas de instancias
+    struct GrassRecordSlot
+    {
+        TransientConstantRing                 VSConstants; // #Constantes de todos los draws del slot
+        RefCntAutoPtr<IBuffer>                GrassConstants;
+        RefCntAutoPtr<IBuffer>                InstanceBuffer;
+        RefCntAutoPtr<IShaderResourceBinding> GrassSRB;
+        RefCntAutoPtr<IShaderResourceBinding> GrassInstSRB;
+        IShaderResourceVariable*              pConstantsVar     = nullptr; // #"Constants" de GrassSRB
+        IShaderResourceVariable*              pInstConstantsVar = nullptr; // #"Constants" de GrassInstSRB
+
+        std::array<std::vector<GrassInstance>, GrassNumLODs> Instances; // #Una lista por LOD
+        std::array<LODStats, GrassNumLODs>                   Stats;
+        Uint64                                               UploadBytes = 0; // #Map + UpdateBuffer del frame
+    };
+
+    // #Datos del frame que leen los hilos mientras graban
+    struct GrassFrameData
+    {
+        float4x4 ViewProj;
+        float3   Eye;
+    };
+
     // #Funcion de creacion del pasto
-    void DrawCube(const float4x4& WVPMatrix, IBuffer* pVertexBuffer, IShaderResourceBinding* pSRB);
+    void DrawCube(IDeviceContext* pCtx, GrassRecordSlot& Slot, Uint32 ConstantsOffset, Uint32 LOD);
+    void DrawGrassCubes(IDeviceContext* pCtx, GrassRecordSlot& Slot, IBuffer* pVertexBuffer);
+    void DrawGrassInstanced(IDeviceContext* pCtx, GrassRecordSlot& Slot, IBuffer* pVertexBuffer);
+
+    void CreateGrassRecordSlots(Uint32 MaxInstances);
+    void CreateGrassSRBs(GrassRecordSlot& Slot);
+    void RecordGrassBand(IDeviceContext* pCtx, GrassRecordSlot& Slot, Uint32 FirstChunk, Uint32 NumChunks);
+    void RenderGrass(const float4x4& ViewProj, const float3& Eye);
+    void RenderGrassGpuCulled();
+    void UpdateGpuCullTufts();
+
+    void        StartWorkerThreads(Uint32 NumThreads);
+    void        StopWorkerThreads();
+    static void GrassWorkerThreadFunc(Tutorial11_ResourceUpdates* pThis, Uint32 ThreadNum);
+    void        UpdateScalingSweep();
+
+    RefCntAutoPtr<IPipelineState> m_pGrassPSO;
+    RefCntAutoPtr<IPipelineState> m_pGrassInstPSO;
+    bool                          m_UseInstancing = true; // #false = camino viejo de un DrawCube por tuft
+
+    std::array<LODStats, GrassNumLODs> m_LODStats; // #Suma de los Stats de todos los slots
+    std::vector<Uint8>                 m_TuftLOD;  // #LOD actual de cada tuft, para la histeresis
+
+    bool  m_UseLOD        = true;
+    bool  m_LODDebugView  = false;
+    float m_LODDistance[GrassNumLODs - 1] = {30.f, 50.f}; // #Distancia a la que se pasa al siguiente LOD
+    float m_LODHysteresis = 2.f;
+
+    // #Viento: el balanceo del pasto se calcula en el vertex shader. Estos eran los
+    // valores fijos que usaba MapDynamicBuffer() en la CPU (kIdleF, kIdleA, etc)
+    struct WindParams
+    {
+        float IdleFrequency  = 1.7f;  // #Antes kIdleF
+        float IdleAmplitude  = 1.35f; // #Antes kIdleA
+        float TimeScale      = 0.8f;
+        float BaseAmplitude  = 0.06f;
+        float HeightScale    = 1.0f / 3.0f;
+        float HeightGain     = 1.5f;
+        float HeightBias     = 0.1f;
+        float TallBladeBoost = 1.3f; // #Puntas de los quads altos
+        float PhasePerVertex = 0.3f;
+        float Tilt           = 0.02f;
+        float DirectionAngle = 0.0f; // #0 = eje X, como m_MovementDirection == 0
+        float2 NoiseScroll   = {0.05f, 0.02f};
+        float NoiseFrequency = 0.03f;
+        float NoiseStrength  = 0.6f;
+        float NoisePhase     = 6.2832f;
+    };
+    void CreateWindNoiseTexture();
+    void UpdateGrassConstants(IDeviceContext* pCtx, IBuffer* pGrassConstants);
+
+    static constexpr const Uint32 WindNoiseSize = 64;
+
+    // #Chunks del campo, carga alrededor del jugador y culling contra el frustum
+    void InitializeGrassField();
+
+    GrassField::Config    m_FieldConfig;
+    GrassField            m_GrassField;
+    GrassField::CullStats m_GrassCullStats;
+    std::vector<Uint32>   m_VisibleChunks;
+    bool                  m_FrustumCulling      = true;
+    bool                  m_CameraFollowsPlayer = false;
+
+    // #Culling, LOD e instancias del pasto en un compute shader, dibujado con DrawIndexedIndirect
+    // (ver GrassGpuCulling). Solo con instancing; los tufts se vuelven a subir cuando cambian los chunks
+    GrassGpuCulling                    m_GpuCulling;
+    std::vector<GrassGpuCulling::Tuft> m_GpuCullTufts;
+    bool                               m_GpuCullingSupported = false;
+    bool                               m_UseGpuCulling       = false;
+    bool                               m_GpuCullTuftsDirty   = true;
+    int                                m_GpuCullVariants     = -1; // #m_NumGrassVariants de la ultima subida
+    bool                               m_ValidateGpuCulling  = false;
+
+    // #Chunks lejanos y quietos dibujados desde un mesh horneado (ver GrassChunkBaker). Solo en
+    // el camino de la CPU; los que no se pueden hornear siguen en m_VisibleChunks
+    void SelectBakedChunks(const float3& Eye);
+    void DrawBakedChunks(const float4x4& ViewProj);
+
+    GrassChunkBaker                                 m_ChunkBaker;
+    std::vector<const GrassChunkBaker::BakedChunk*> m_BakedChunksToDraw;
+    bool                                            m_UseChunkBaking = true;
+    float                                           m_BakeDistance   = 50.f; // #Distancia minima de la caja del chunk a la camara, no menos que la del LOD 2
+    Uint32                                          m_BakedDraws     = 0;
+    Uint32                                          m_BakedTufts     = 0;
+
+    WindParams              m_Wind;
+    RefCntAutoPtr<ITexture> m_WindNoiseTexture;
+
+    // #Grabacion del pasto en paralelo: el campo visible se parte en bandas de chunks y cada
+    // hilo graba la suya en su deferred context. Las command lists se ejecutan en orden de banda
+    GrassFrameData                           m_GrassFrame;
+    std::vector<GrassRecordSlot>             m_GrassSlots; // #0 = immediate context, 1..N = worker threads
+    std::vector<std::pair<Uint32, Uint32>>   m_GrassBands; // #Primer chunk (en m_VisibleChunks) y cantidad, por worker
+    Uint32                                   m_MaxWorkerThreads = 0;
+    int                                      m_NumWorkerThreads = 0;
+    Threading::Signal                        m_RecordGrassSignal;
+    Threading::Signal                        m_ExecuteCommandListsSignal;
+    Threading::Signal                        m_GotoNextFrameSignal;
+    std::mutex                               m_NumThreadsCompletedMtx;
+    std::atomic<int>                         m_NumThreadsCompleted{0};
+    std::atomic<int>                         m_NumThreadsReady{0};
+    std::vector<std::thread>                 m_WorkerThreads;
+    std::vector<RefCntAutoPtr<ICommandList>> m_CmdLists;
+    std::vector<ICommandList*>               m_CmdListPtrs;
+
+    // #Escalado: ms de CPU del pasto (cull + bend + grabacion + envio) con 0..N workers
+    static constexpr const Uint32 ScalingSweepWarmupFrames = 10;
+    static constexpr const Uint32 ScalingSweepFrames       = 120;
+
+    double              m_GrassCPUTimeMs = 0;
+    std::vector<double> m_GrassCPUTimeByThreads; // #Resultado del ultimo barrido, < 0 si no se midio
+    int                 m_SweepThreads        = -1; // #-1 = no hay barrido en curso
+    Uint32              m_SweepFrame          = 0;
+    double              m_SweepAccumMs        = 0;
+    int                 m_SweepRestoreThreads = 0;
+
+    // #Benchmark: --benchmark <frames> mueve al jugador por un camino fijo y escribe los
+    // tiempos y contadores de cada frame en un JSON
+    struct FrameCounters
+    {
+        Uint32 DrawCalls   = 0;
+        Uint64 UploadBytes = 0;
+    };
+    void RecordBenchmarkFrame(std::chrono::high_resolution_clock::time_point UpdateStart);
+    void FinishBenchmark();
+
+    // #Para y espera todos los hilos del sample, termina la captura y suelta los recursos de GPU.
+    // Lo llaman el destructor y FinishBenchmark() antes de salir; la segunda vez no hace nada
+    void Shutdown();
+    bool m_IsShutDown = false;
+
+    Uint32             m_BenchmarkFrames  = 0; // #0 = modo normal
+    Uint32             m_BenchmarkWarmup  = 30;
+    Uint32             m_BenchmarkSeed    = 1;
+    int                m_BenchmarkWorkers = -1; // #-1 = los de siempre
+    std::string        m_BenchmarkOutput  = "Tutorial11_benchmark.json";
+    Uint32             m_BenchmarkFrame   = 0;
+    ScriptedPlayerPath m_BenchmarkPath;
+    BenchmarkRecorder  m_BenchmarkRecorder;
+
+    FrameCounters                                  m_FrameCounters; // #Del frame actual
+    double                                         m_UpdateCPUTimeMs = 0;
+    double                                         m_RenderCPUTimeMs = 0;
+    std::chrono::high_resolution_clock::time_point m_LastUpdateStart;
 
     static constexpr const size_t NumTextures         = 4;
     static constexpr const Uint32 MaxUpdateRegionSize = 128;
     static constexpr const Uint32 MaxMapRegionSize    = 128;
 
-    std::array<RefCntAutoPtr<ITexture>, NumTextures>               m_Textures;
-    std::array<RefCntAutoPtr<IShaderResourceBinding>, NumTextures> m_SRBs;
+    // #Pisadas del jugador en el piso y el pasto. Los cambios de cada frame se suben en lote por
+    // m_TextureUpdateBuffer (ver TrampleMask::Upload), en rectangulos de hasta MaxUpdateRegionSize
+    void UpdateTrampleMask();
+
+    TrampleMask m_TrampleMask;
+    float2      m_LastTramplePos;
+    bool        m_UseTrampleMask       = true;
+    bool        m_TrampleBufferUploads = false; // #false = UpdateTexture directo desde la copia en CPU
+    float       m_TrampleStrength      = 1.f;
+
+    // #Las texturas grassN.png van todas en un Texture2DArray: la capa N es grassN.png
+    RefCntAutoPtr<ITexture>               m_TextureArray;
+    RefCntAutoPtr<IShaderResourceBinding> m_SceneSRB; // #Piso y jugador comparten SRB
+
+    void                    CreatePlaceholderTexture();
+    RefCntAutoPtr<ITexture> CreateTextureArray(std::array<RefCntAutoPtr<ITextureLoader>, NumTextures>& Loaders);
+    void                    CreateSceneSRB();
+
+    static constexpr const Uint32 PlayerTextureSlice     = 0;
+    static constexpr const Uint32 GroundTextureSlice     = 1;
+    static constexpr const Uint32 FirstGrassTextureSlice = 1; // #Variantes del pasto: capas 1..NumTextures-1
+    int                           m_NumGrassVariants     = 1;
+
+    // #Arranque asincrono: los PSOs y las texturas se cargan en un thread pool mientras ya se
+    // dibujan frames con una textura de relleno y sin pasto (ver StartAsyncLoads)
+    enum STARTUP_PHASE : Uint32
+    {
+        STARTUP_PHASE_SCENE_PSO = 0,
+        STARTUP_PHASE_GRASS_PSO,
+        STARTUP_PHASE_GRASS_INST_PSO,
+        STARTUP_PHASE_GRASS_CULL_PSO,
+        STARTUP_PHASE_DECODE_TEXTURE, // #Una fase por cada grassN.png
+        STARTUP_PHASE_TEXTURE_ARRAY = STARTUP_PHASE_DECODE_TEXTURE + NumTextures,
+        STARTUP_PHASE_COUNT
+    };
+    struct StartupPhase
+    {
+        std::string Name;
+        double      StartMs     = -1; // #Desde el principio de Initialize()
+        double      EndMs       = -1;
+        Uint32      CacheHits   = 0; // #Shaders y PSOs que salieron de m_ShaderCache
+        Uint32      CacheMisses = 0;
+    };
+    // #Las tareas escriben aqui; el hilo principal solo lee lo de una fase cuando su tarea termino
+    struct StartupLoads
+    {
+        RefCntAutoPtr<IThreadPool>                                 pThreadPool;
+        std::array<RefCntAutoPtr<IAsyncTask>, STARTUP_PHASE_COUNT> Tasks; // #nullptr si la fase corre en el hilo principal
+        std::array<StartupPhase, STARTUP_PHASE_COUNT>              Phases;
+        bool                                                       DeviceOnMainThread = false;
+
+        RefCntAutoPtr<IPipelineState>                          pPSO, pPSO_NoCull, pAgentPSO;
+        RefCntAutoPtr<IPipelineState>                          pGrassPSO, pGrassInstPSO;
+        RefCntAutoPtr<IPipelineState>                          pGrassCullPSO;
+        std::array<RefCntAutoPtr<ITextureLoader>, NumTextures> Loaders;
+        std::atomic<Uint32>                                    NumDecoded{0};
+        RefCntAutoPtr<ITexture>                                pTextureArray;
+
+        bool SceneInstalled    = false;
+        bool GrassInstalled    = false;
+        bool CullInstalled     = false;
+        bool TexturesInstalled = false;
+    };
+    void StartAsyncLoads();
+    void RunStartupPhase(Uint32 Phase, const std::function<void()>& Job);
+    void PollAsyncLoads(bool Wait);
+
+    std::unique_ptr<StartupLoads>                  m_Startup; // #nullptr cuando ya se instalo todo
+    std::chrono::high_resolution_clock::time_point m_StartupStart;
+    double                                         m_StartupInitMs       = -1;
+    double                                         m_StartupFirstFrameMs = -1;
+    double                                         m_StartupLoadedMs     = -1;
+
+    // #Shaders y PSOs compilados de corridas anteriores (ver ShaderStateCache)
+    ShaderStateCache m_ShaderCache;
+    std::string      m_ShaderCachePath; // #--shader_cache: vacio = automatico, "off" = sin cache
+    Uint32           m_ShaderCacheHits    = 0;
+    Uint32           m_ShaderCacheMisses  = 0;
+    double           m_ShaderCacheSavedMs = 0;
 
     double       m_LastTextureUpdateTime = 0;
     double       m_LastBufferUpdateTime  = 0;
@@ -89,9 +399,6 @@ private:
     std::mt19937 m_gen{0}; //Use 0 as the seed to always generate the same sequence
     double       m_CurrTime = 0;
 
-    // #Vamos a usar esto para el movimiento del pasto
-    int m_MovementDirection = 0;
-
     // #Camara 
     Diligent::float3 m_CamPos    = {0, 15, 25};
     float            m_Pitch     = -0.2f;      
@@ -99,7 +406,8 @@ private:
     float            m_MoveSpeed = 10.0f;      
     float            m_MouseSens = 0.0025f;   
 
-    // #Info del jugador
+    // #Info del jugador. Es estado de la simulacion: solo lo toca el hilo de simulacion, o el
+    // principal mientras la simulacion esta parada (ver WaitForSimulation)
     float m_PlayerX = 0.0f;
     float m_PlayerZ = 0.0f;
 
@@ -113,10 +421,130 @@ private:
     float m_PlayerMoveZ = 0.0f;
     float3 m_PlayerVel{0, 0, 0};
 
-    std::vector<bool>  m_GrassDeformed;
-    std::vector<float> m_GrassDeformX;
-    std::vector<float> m_GrassDeformY;
-    std::vector<float> m_GrassDeformZ;
+    // #Bend de cada tuft: el jugador y los NPCs empujan los tufts cercanos y un resorte los endereza
+    GrassBendKernel  m_BendKernel = GrassBendKernel::Scalar;
+    GrassDeformation m_GrassDeform;
+    bool             m_ParallelDeform  = true;
+    double           m_DeformCPUTimeMs   = 0;
+
+    // #Cuerpos que doblan el pasto: en cada tick el jugador y los NPCs se insertan en un spatial
+    // hash con celdas del tamano de un chunk (ver GrassInteractorGrid). Los NPCs son estado de la
+    // simulacion; su cantidad solo se cambia con la simulacion parada
+    void ResetAgents();
+
+    // #Todos los NPCs van en un solo DrawIndexed instanciado con la malla del jugador
+    void DrawAgents(const float4x4& ViewProj);
+
+    WanderingAgents              m_Agents;
+    GrassInteractorGrid          m_InteractorGrid;
+    std::vector<GrassInteractor> m_Interactors;
+    int                          m_NumAgents        = 0;
+    bool                         m_DrawAgents       = true;
+    double                       m_SimInteractionMs = 0; // #Suma de GrassDeformation::Stats::DisturbMs de los ticks pedidos
+    double                       m_InteractionMs    = 0; // #La de los ticks del frame anterior
+    static constexpr const int   StressTestAgents   = 1000;
+
+    RefCntAutoPtr<IPipelineState>         m_pAgentPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_AgentSRB;
+    RefCntAutoPtr<IBuffer>                m_AgentInstanceBuffer; // #Una GrassInstance por NPC, solo crece
+
+    // #Simulacion a paso fijo en su propio hilo: el movimiento del jugador, su velocidad suavizada
+    // y la deformacion del pasto avanzan de a SimTimeStep sin importar el frame rate. Mientras el
+    // hilo simula los ticks del frame siguiente, el principal dibuja el actual interpolando entre
+    // los dos ultimos snapshots publicados
+    struct SimSnapshot
+    {
+        Uint64                                  Tick    = 0;
+        float                                   PlayerX = 0;
+        float                                   PlayerZ = 0;
+        std::vector<GrassDeformation::BentTuft> BentTufts; // #Solo los tufts activos, el resto tiene bend 0
+        std::vector<float2>                     Agents;
+    };
+    // #Lo que el hilo principal le pasa a los ticks de un frame
+    struct SimInput
+    {
+        float2          MoveDir;
+        bool            ScriptedPath   = false; // #Benchmark: la direccion sale de m_BenchmarkPath en cada tick
+        GrassBendKernel BendKernel     = GrassBendKernel::Scalar;
+        bool            ParallelDeform = true;
+    };
+
+    void        StartSimulationThread();
+    void        StopSimulationThread();
+    static void SimulationThreadFunc(Tutorial11_ResourceUpdates* pThis);
+    void        SimulateTick(const SimInput& Input);
+    void        PublishSimSnapshot();
+    void        WaitForSimulation();
+    void        ScheduleSimulation(double ElapsedTime, const SimInput& Input);
+    void        InterpolateSimSnapshots();
+    void        ResetSimSnapshots();
+
+    static constexpr const double SimTimeStep         = 1.0 / 60.0;
+    static constexpr const Uint32 SimMaxTicksPerFrame = 4; // #Si el frame tarda mas, la simulacion se atrasa en vez de trabarse
+    static constexpr const float  PlayerSpeed         = 2.0f; // #Unidades por segundo
+
+    std::thread             m_SimThread;
+    std::mutex              m_SimMtx; // #Lo tiene el hilo de simulacion mientras corre ticks
+    std::condition_variable m_SimCV;
+    bool                    m_SimStop         = false;
+    Uint64                  m_SimTick         = 0; // #Ticks ya simulados
+    Uint64                  m_SimTargetTick   = 0; // #Hasta donde tiene que llegar el hilo
+    SimInput                m_SimInput;
+    double                  m_SimAccumulator  = 0; // #Tiempo que todavia no alcanza para un tick
+    SimSnapshot             m_SimSnapshots[2];
+    Uint32                  m_SimCurrSnapshot = 0; // #El otro es el del tick anterior
+
+    // #Lo que dibuja el frame: jugador y bend interpolados entre los dos snapshots
+    float2              m_RenderPlayerPos;
+    std::vector<float2> m_RenderAgentPos;
+    AlignedFloatVector  m_RenderBendX;
+    AlignedFloatVector  m_RenderBendZ;
+    std::vector<Uint32> m_RenderBentTufts; // #Tufts con bend en m_RenderBendX/Z, para volverlos a 0
+
+    Uint32 m_SimTicksLastFrame = 0;
+    double m_SimTickMs         = 0; // #Del ultimo tick
+    double m_SimWaitMs         = 0; // #Lo que el hilo principal espero a la simulacion en este frame
+
+    // #Late latch: la posicion del jugador (y la de la camara si lo sigue) se calcula recien cuando
+    // se escriben sus constantes, extrapolando el ultimo tick con el input de este frame en vez de
+    // interpolar un tick atras. Los datos de la extrapolacion se copian en Update(), porque en
+    // Render() el hilo de simulacion ya esta escribiendo los snapshots
+    float2 LatchPlayerPosition() const;
+
+    bool                                           m_LateLatch = true;
+    float2                                         m_LatchBasePos; // #Jugador en el ultimo tick simulado
+    float2                                         m_LatchMoveDir; // #Lo que avanza por segundo, / PlayerSpeed
+    std::chrono::high_resolution_clock::time_point m_LatchBaseTime; // #Instante que le corresponde a ese tick
+    float2                                         m_LatchCameraPos; // #Jugador al empezar Render()
+
+    // #Frames en vuelo y latencia del input (ver FramePacer)
+    FramePacer m_FramePacer;
+    int        m_MaxFramesInFlight = 0; // #0 = lo que permita el swap chain
+    bool       m_LatencyMode       = false;
+    Uint64     m_LastLatencyFrame  = 0; // #Ultimo frame que se paso al benchmark
+
+    // #Presupuesto de memoria de GPU (ver GpuMemoryRegistry). 0 = sin presupuesto
+    int m_GpuMemoryBudgetMB = 512;
+
+    // #Captura de frames a PNG/raw sin esperar a la GPU (ver FrameCapture). --capture <carpeta> la
+    // arranca desde el primer frame con la escena
+    FrameCapture         m_FrameCapture;
+    FrameCapture::Config m_CaptureConfig;
+    std::string          m_CapturePath; // #Vacio = sin captura al arrancar
+    std::string          m_CaptureFormat = "png";
+
+    // #Hilos para el trabajo de CPU que no graba comandos (simulacion del pasto)
+    RefCntAutoPtr<IThreadPool> m_pThreadPool;
+    Uint32                     m_NumPoolThreads = 0;
+
+    // #Ventana del profiler de CPU y export del trace
+    bool                                m_ShowProfiler      = false;
+    int                                 m_TraceExportFrames = 60;
+    std::string                         m_TracePath         = "Tutorial11_trace.json";
+    std::vector<CpuProfiler::ZoneStats> m_ZoneStats;
+
+    // #Tiempo de GPU y pipeline statistics de cada pasada de Render()
+    GpuPassQueries m_GpuQueries;
 };
 
 } // namespace Diligent
@@ -0,0 +1,169 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+// #Compara los kernels SIMD del bend contra la version escalar con posiciones aleatorias,
+// punteros desalineados y todas las longitudes de cola (Count no multiplo de 4 ni de 8).
+// Los kernels que la CPU no soporta se saltan
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "GrassBend.hpp"
+
+using namespace Diligent;
+
+namespace
+{
+
+constexpr float Tolerance = 1e-5f;
+
+struct TestInput
+{
+    std::vector<float> X;
+    std::vector<float> Z;
+};
+
+// #Tufts repartidos alrededor del jugador, la mayoria dentro del radio, y uno justo debajo
+TestInput MakeInput(std::mt19937& Rng, const GrassBendParams& Params, size_t Count)
+{
+    std::uniform_real_distribution<float> Offset{-Params.Radius * 1.5f, Params.Radius * 1.5f};
+
+    TestInput Input;
+    Input.X.resize(Count);
+    Input.Z.resize(Count);
+    for (size_t i = 0; i < Count; ++i)
+    {
+        Input.X[i] = Params.PlayerX + Offset(Rng);
+        Input.Z[i] = Params.PlayerZ + Offset(Rng);
+    }
+    if (Count > 2)
+    {
+        Input.X[Count / 2] = Params.PlayerX;
+        Input.Z[Count / 2] = Params.PlayerZ;
+    }
+    return Input;
+}
+
+// #Corre el kernel sobre copias desplazadas Misalign floats para que ni las entradas ni las
+// salidas esten alineadas a 16/32 bytes, y compara con el escalar
+float CompareKernel(GrassBendKernel Kernel, const GrassBendParams& Params, const TestInput& Input, size_t Misalign)
+{
+    const size_t Count = Input.X.size();
+
+    std::vector<float> X(Count + Misalign), Z(Count + Misalign);
+    std::copy(Input.X.begin(), Input.X.end(), X.begin() + Misalign);
+    std::copy(Input.Z.begin(), Input.Z.end(), Z.begin() + Misalign);
+
+    std::vector<float> RefX(Count), RefZ(Count);
+    ComputeGrassBend(GrassBendKernel::Scalar, Params, Input.X.data(), Input.Z.data(), RefX.data(), RefZ.data(), Count);
+
+    // #Centinelas despues de Count para detectar escrituras fuera de rango en la cola
+    const float        Sentinel = 12345.f;
+    std::vector<float> BendX(Count + Misalign + 8, Sentinel), BendZ(Count + Misalign + 8, Sentinel);
+    ComputeGrassBend(Kernel, Params, X.data() + Misalign, Z.data() + Misalign, BendX.data() + Misalign, BendZ.data() + Misalign, Count);
+
+    float MaxDiff = 0;
+    for (size_t i = 0; i < Count; ++i)
+    {
+        MaxDiff = std::max(MaxDiff, std::abs(BendX[Misalign + i] - RefX[i]));
+        MaxDiff = std::max(MaxDiff, std::abs(BendZ[Misalign + i] - RefZ[i]));
+    }
+    for (size_t i = Misalign + Count; i < BendX.size(); ++i)
+    {
+        if (BendX[i] != Sentinel || BendZ[i] != Sentinel)
+            return INFINITY;
+    }
+    return MaxDiff;
+}
+
+} // namespace
+
+int main()
+{
+    std::mt19937 Rng{20240611u};
+
+    GrassBendParams Moving;
+    Moving.PlayerX = 3.25f;
+    Moving.PlayerZ = -7.5f;
+    Moving.VelDirX = 0.6f;
+    Moving.VelDirZ = -0.8f;
+
+    GrassBendParams Still;
+    Still.PlayerX = -12.f;
+    Still.PlayerZ = 40.f;
+
+    const GrassBendParams* ParamSets[] = {&Moving, &Still};
+    const size_t           Counts[]    = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 11, 12, 13, 15, 16, 17, 23, 31, 33, 1000, 1003, 4099};
+
+    int Failures = 0;
+    int Checks   = 0;
+    for (int k = 0; k < static_cast<int>(GrassBendKernel::Count); ++k)
+    {
+        const auto Kernel = static_cast<GrassBendKernel>(k);
+        if (!IsGrassBendKernelSupported(Kernel))
+        {
+            std::cout << GetGrassBendKernelName(Kernel) << ": not supported, skipped\n";
+            continue;
+        }
+
+        float KernelMaxDiff = 0;
+        for (const auto* pParams : ParamSets)
+        {
+            for (size_t Count : Counts)
+            {
+                const auto Input = MakeInput(Rng, *pParams, Count);
+                for (size_t Misalign = 0; Misalign < 4; ++Misalign)
+                {
+                    const float Diff = CompareKernel(Kernel, *pParams, Input, Misalign);
+                    ++Checks;
+                    if (!(Diff <= Tolerance))
+                    {
+                        std::cerr << GetGrassBendKernelName(Kernel) << ": count " << Count << ", misalign " << Misalign
+                                  << ": max diff " << Diff << "\n";
+                        ++Failures;
+                    }
+                    KernelMaxDiff = std::max(KernelMaxDiff, Diff);
+                }
+
+                if (Count > 0 && !(ValidateGrassBendKernel(Kernel, *pParams, Input.X.data(), Input.Z.data(), Count) <= Tolerance))
+                {
+                    std::cerr << GetGrassBendKernelName(Kernel) << ": ValidateGrassBendKernel failed for count " << Count << "\n";
+                    ++Failures;
+                }
+            }
+        }
+        std::cout << GetGrassBendKernelName(Kernel) << ": max diff " << KernelMaxDiff << "\n";
+    }
+
+    std::cout << Checks << " checks, " << Failures << " failures\n";
+    return Failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,191 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+// #Corre CullGrassReference() sobre un campo fijo de 24x24 tufts y compara los tufts visibles y
+// los LOD contra valores conocidos. Los valores salen de resolver el frustum a mano (camara
+// mirando hacia +Z con 90 grados de fov, asi cada plano es una recta a 45 grados) y el campo
+// esta corrido para que ningun tuft quede a menos de 0.01 de un plano o de un limite de LOD
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "GrassGpuCulling.hpp"
+
+using namespace Diligent;
+
+namespace
+{
+
+constexpr Uint32 GridSize  = 24;
+constexpr float  GridStep  = 2.f;
+constexpr float  GridMinX  = -23.75f;
+constexpr float  GridMinZ  = -11.4f;
+constexpr Uint32 NumLODs   = GrassGpuCulling::NumLODs;
+constexpr float  Tolerance = 1e-5f;
+
+struct Field
+{
+    std::vector<GrassGpuCulling::Tuft> Tufts;
+    std::vector<float>                 BendX;
+    std::vector<float>                 BendZ;
+};
+
+// #Uno de cada 7 tufts queda sin chunk cargado (Valid = 0)
+Field MakeField()
+{
+    Field F;
+    for (Uint32 j = 0; j < GridSize; ++j)
+    {
+        for (Uint32 i = 0; i < GridSize; ++i)
+        {
+            const Uint32 t = j * GridSize + i;
+
+            GrassGpuCulling::Tuft Tuft;
+            Tuft.X     = GridMinX + GridStep * static_cast<float>(i);
+            Tuft.Z     = GridMinZ + GridStep * static_cast<float>(j);
+            Tuft.Slice = static_cast<float>(t % 4);
+            Tuft.Valid = t % 7 == 3 ? 0.f : 1.f;
+            F.Tufts.push_back(Tuft);
+            F.BendX.push_back(0.02f * static_cast<float>(t % 5));
+            F.BendZ.push_back(-0.03f * static_cast<float>(t % 3));
+        }
+    }
+    return F;
+}
+
+GrassGpuCulling::Params MakeParams(const float3& Eye, bool IsGL)
+{
+    GrassGpuCulling::Params Params;
+    Params.ViewProj       = float4x4::Translation(-Eye.x, -Eye.y, -Eye.z) * float4x4::Projection(PI_F / 2.f, 1.f, 0.1f, 30.f, IsGL);
+    Params.Eye            = Eye;
+    Params.IsGL           = IsGL;
+    Params.LODDistance[0] = 8.f;
+    Params.LODDistance[1] = 18.f;
+    Params.TuftRadius     = 0.5f;
+    return Params;
+}
+
+struct Expected
+{
+    const char* Name;
+    Uint32      Count[NumLODs];
+    Uint32      IndexSum[NumLODs]; // #Suma de los indices de los tufts de cada lista
+};
+
+// #Recupera el tuft de cada instancia por su traslacion y revisa que el bend, la capa y el LOD
+// sean los del tuft y que las listas esten en orden de tuft
+bool CheckLists(const Expected& Exp, const Field& F, const GrassCullLists& Lists)
+{
+    bool Ok = true;
+    for (Uint32 LOD = 0; LOD < NumLODs; ++LOD)
+    {
+        const auto& List = Lists[LOD];
+
+        Uint32 IndexSum = 0;
+        Int32  PrevTuft = -1;
+        for (const auto& Inst : List)
+        {
+            const float  fi = (Inst.World._41 - GridMinX) / GridStep;
+            const float  fj = (Inst.World._43 - GridMinZ) / GridStep;
+            const Uint32 i  = static_cast<Uint32>(std::lround(fi));
+            const Uint32 j  = static_cast<Uint32>(std::lround(fj));
+            const Uint32 t  = j * GridSize + i;
+            if (std::abs(fi - static_cast<float>(i)) > 1e-3f || std::abs(fj - static_cast<float>(j)) > 1e-3f || i >= GridSize || j >= GridSize)
+            {
+                std::cerr << Exp.Name << ": LOD " << LOD << " has an instance that is not on the grid\n";
+                return false;
+            }
+
+            const auto& Tuft = F.Tufts[t];
+            if (Tuft.Valid == 0 || static_cast<Int32>(t) <= PrevTuft ||
+                std::abs(Inst.Bend.x - F.BendX[t]) > Tolerance || std::abs(Inst.Bend.y - F.BendZ[t]) > Tolerance ||
+                Inst.Bend.z != static_cast<float>(LOD) || Inst.Bend.w != Tuft.Slice)
+            {
+                std::cerr << Exp.Name << ": LOD " << LOD << ", tuft " << t << " has wrong instance data\n";
+                Ok = false;
+            }
+            PrevTuft = static_cast<Int32>(t);
+            IndexSum += t;
+        }
+
+        if (List.size() != Exp.Count[LOD] || IndexSum != Exp.IndexSum[LOD])
+        {
+            std::cerr << Exp.Name << ": LOD " << LOD << ": " << List.size() << " tufts (index sum " << IndexSum << "), expected "
+                      << Exp.Count[LOD] << " (index sum " << Exp.IndexSum[LOD] << ")\n";
+            Ok = false;
+        }
+    }
+    return Ok;
+}
+
+} // namespace
+
+int main()
+{
+    const Field F = MakeField();
+
+    std::vector<Uint32> LODState(F.Tufts.size(), 0);
+    GrassCullLists      Lists;
+    int                 Failures = 0;
+
+    const auto Run = [&](const Expected& Exp, const GrassGpuCulling::Params& Params) {
+        CullGrassReference(Params, F.Tufts, F.BendX.data(), F.BendZ.data(), LODState.data(), Lists);
+        if (!CheckLists(Exp, F, Lists))
+            ++Failures;
+        std::cout << Exp.Name << ": " << Lists[0].size() << " / " << Lists[1].size() << " / " << Lists[2].size() << "\n";
+    };
+
+    // #Frustum y LOD sin histeresis, todos los tufts empiezan en LOD 0
+    const Expected Frustum{"frustum", {9, 46, 129}, {757, 7890, 39327}};
+    Run(Frustum, MakeParams({0, 3, -10}, false));
+
+    // #El mismo frame con la proyeccion de OpenGL: cambia el plano near pero no el resultado
+    std::fill(LODState.begin(), LODState.end(), 0);
+    Run({"frustum GL", {9, 46, 129}, {757, 7890, 39327}}, MakeParams({0, 3, -10}, true));
+
+    // #La camara avanza 1.5 con histeresis 2: los tufts que se acercan se quedan en su LOD
+    // anterior, asi que el resultado depende del LOD del frame de antes
+    auto Closer          = MakeParams({0, 3, -8.5f}, false);
+    Closer.LODHysteresis = 2.f;
+    Run({"hysteresis", {6, 43, 146}, {550, 7432, 46640}}, Closer);
+
+    std::fill(LODState.begin(), LODState.end(), 0);
+    Run({"hysteresis from LOD 0", {17, 53, 125}, {1977, 11069, 41576}}, Closer);
+
+    // #Sin frustum ni LOD pasan todos los tufts validos, en LOD 0
+    auto All           = MakeParams({0, 3, -10}, false);
+    All.FrustumCulling = false;
+    All.UseLOD         = false;
+    Run({"no culling", {494, 0, 0}, {142107, 0, 0}}, All);
+
+    std::cout << (Failures == 0 ? "All checks passed\n" : "Some checks failed\n");
+    return Failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
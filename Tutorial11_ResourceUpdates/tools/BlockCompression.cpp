@@ -0,0 +1,315 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "BlockCompression.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+Uint16 PackRGB565(const float c[3])
+{
+    const auto Quantize = [](float v, int Max) {
+        return std::min(std::max(static_cast<int>(v * Max / 255.f + 0.5f), 0), Max);
+    };
+    return static_cast<Uint16>((Quantize(c[0], 31) << 11) | (Quantize(c[1], 63) << 5) | Quantize(c[2], 31));
+}
+
+void UnpackRGB565(Uint16 Packed, float c[3])
+{
+    const Uint32 r = (Packed >> 11) & 31;
+    const Uint32 g = (Packed >> 5) & 63;
+    const Uint32 b = Packed & 31;
+    c[0]           = static_cast<float>((r << 3) | (r >> 2));
+    c[1]           = static_cast<float>((g << 2) | (g >> 4));
+    c[2]           = static_cast<float>((b << 3) | (b >> 2));
+}
+
+// #Indices de cada texel para los extremos C0 > C1 (modo de 4 colores). Devuelve el error cuadratico
+float ChooseBC1Indices(const Uint8* pBlock, Uint16 C0, Uint16 C1, Uint32& Indices)
+{
+    Indices = 0;
+    if (C0 == C1)
+    {
+        // #Con C0 == C1 el bloque estaria en modo de 3 colores; se usa solo el indice 0
+        float Palette[3];
+        UnpackRGB565(C0, Palette);
+        float Error = 0;
+        for (Uint32 i = 0; i < 16; ++i)
+        {
+            for (Uint32 c = 0; c < 3; ++c)
+            {
+                const float d = pBlock[i * 4 + c] - Palette[c];
+                Error += d * d;
+            }
+        }
+        return Error;
+    }
+
+    float Palette[4][3];
+    UnpackRGB565(C0, Palette[0]);
+    UnpackRGB565(C1, Palette[1]);
+    for (Uint32 c = 0; c < 3; ++c)
+    {
+        Palette[2][c] = (2 * Palette[0][c] + Palette[1][c]) / 3;
+        Palette[3][c] = (Palette[0][c] + 2 * Palette[1][c]) / 3;
+    }
+
+    float Error = 0;
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        Uint32 Best     = 0;
+        float  BestDist = 0;
+        for (Uint32 p = 0; p < 4; ++p)
+        {
+            float Dist = 0;
+            for (Uint32 c = 0; c < 3; ++c)
+            {
+                const float d = pBlock[i * 4 + c] - Palette[p][c];
+                Dist += d * d;
+            }
+            if (p == 0 || Dist < BestDist)
+            {
+                Best     = p;
+                BestDist = Dist;
+            }
+        }
+        Indices |= Best << (i * 2);
+        Error += BestDist;
+    }
+    return Error;
+}
+
+// #Cuantiza los extremos y los ordena para que el bloque quede en modo de 4 colores
+float QuantizeBC1Endpoints(const Uint8* pBlock, const float E0[3], const float E1[3], Uint16& C0, Uint16& C1, Uint32& Indices)
+{
+    C0 = PackRGB565(E0);
+    C1 = PackRGB565(E1);
+    if (C0 < C1)
+        std::swap(C0, C1);
+    return ChooseBC1Indices(pBlock, C0, C1, Indices);
+}
+
+} // namespace
+
+// #Extremos sobre el eje principal de los colores del bloque y despues dos pasadas de minimos
+// cuadrados con los indices elegidos
+void EncodeBC1Block(const Uint8* pBlock, Uint8* pDst)
+{
+    float Mean[3] = {};
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        for (Uint32 c = 0; c < 3; ++c)
+            Mean[c] += pBlock[i * 4 + c] / 16.f;
+    }
+
+    float Cov[6] = {}; // #rr, rg, rb, gg, gb, bb
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        const float r = pBlock[i * 4 + 0] - Mean[0];
+        const float g = pBlock[i * 4 + 1] - Mean[1];
+        const float b = pBlock[i * 4 + 2] - Mean[2];
+        Cov[0] += r * r;
+        Cov[1] += r * g;
+        Cov[2] += r * b;
+        Cov[3] += g * g;
+        Cov[4] += g * b;
+        Cov[5] += b * b;
+    }
+
+    // #Eje principal por iteracion de potencias
+    float Axis[3] = {1, 1, 1};
+    for (Uint32 Iter = 0; Iter < 8; ++Iter)
+    {
+        const float x = Cov[0] * Axis[0] + Cov[1] * Axis[1] + Cov[2] * Axis[2];
+        const float y = Cov[1] * Axis[0] + Cov[3] * Axis[1] + Cov[4] * Axis[2];
+        const float z = Cov[2] * Axis[0] + Cov[4] * Axis[1] + Cov[5] * Axis[2];
+        const float m = std::max(std::max(std::abs(x), std::abs(y)), std::abs(z));
+        if (m < 1e-6f)
+            break;
+        Axis[0] = x / m;
+        Axis[1] = y / m;
+        Axis[2] = z / m;
+    }
+
+    Uint32 MinTexel = 0, MaxTexel = 0;
+    float  MinProj = 0, MaxProj = 0;
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        const float Proj = pBlock[i * 4 + 0] * Axis[0] + pBlock[i * 4 + 1] * Axis[1] + pBlock[i * 4 + 2] * Axis[2];
+        if (i == 0 || Proj < MinProj)
+        {
+            MinProj  = Proj;
+            MinTexel = i;
+        }
+        if (i == 0 || Proj > MaxProj)
+        {
+            MaxProj  = Proj;
+            MaxTexel = i;
+        }
+    }
+
+    float E0[3], E1[3];
+    for (Uint32 c = 0; c < 3; ++c)
+    {
+        E0[c] = pBlock[MaxTexel * 4 + c];
+        E1[c] = pBlock[MinTexel * 4 + c];
+    }
+
+    Uint16 C0, C1;
+    Uint32 Indices;
+    float  Error = QuantizeBC1Endpoints(pBlock, E0, E1, C0, C1, Indices);
+
+    for (Uint32 Pass = 0; Pass < 2 && Error > 0 && C0 != C1; ++Pass)
+    {
+        // #Peso de C0 en cada uno de los 4 colores de la paleta
+        static constexpr float Weights[4] = {1.f, 0.f, 2.f / 3.f, 1.f / 3.f};
+
+        float AA = 0, AB = 0, BB = 0;
+        float AX[3] = {}, BX[3] = {};
+        for (Uint32 i = 0; i < 16; ++i)
+        {
+            const float a = Weights[(Indices >> (i * 2)) & 3];
+            const float b = 1.f - a;
+            AA += a * a;
+            AB += a * b;
+            BB += b * b;
+            for (Uint32 c = 0; c < 3; ++c)
+            {
+                AX[c] += a * pBlock[i * 4 + c];
+                BX[c] += b * pBlock[i * 4 + c];
+            }
+        }
+        const float Det = AA * BB - AB * AB;
+        if (std::abs(Det) < 1e-6f)
+            break;
+
+        for (Uint32 c = 0; c < 3; ++c)
+        {
+            E0[c] = (BB * AX[c] - AB * BX[c]) / Det;
+            E1[c] = (AA * BX[c] - AB * AX[c]) / Det;
+        }
+
+        Uint16 NewC0, NewC1;
+        Uint32 NewIndices;
+        const float NewError = QuantizeBC1Endpoints(pBlock, E0, E1, NewC0, NewC1, NewIndices);
+        if (NewError >= Error)
+            break;
+        C0      = NewC0;
+        C1      = NewC1;
+        Indices = NewIndices;
+        Error   = NewError;
+    }
+
+    pDst[0] = static_cast<Uint8>(C0 & 0xFF);
+    pDst[1] = static_cast<Uint8>(C0 >> 8);
+    pDst[2] = static_cast<Uint8>(C1 & 0xFF);
+    pDst[3] = static_cast<Uint8>(C1 >> 8);
+    for (Uint32 b = 0; b < 4; ++b)
+        pDst[4 + b] = static_cast<Uint8>(Indices >> (b * 8));
+}
+
+// #Bloque de alfa en modo de 8 valores (A0 > A1) seguido de un bloque de color BC1
+void EncodeBC3Block(const Uint8* pBlock, Uint8* pDst)
+{
+    Uint8 A0 = 0, A1 = 255;
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        A0 = std::max(A0, pBlock[i * 4 + 3]);
+        A1 = std::min(A1, pBlock[i * 4 + 3]);
+    }
+
+    Uint64 AlphaIndices = 0;
+    if (A0 > A1)
+    {
+        float Palette[8] = {static_cast<float>(A0), static_cast<float>(A1)};
+        for (Uint32 p = 1; p < 7; ++p)
+            Palette[p + 1] = ((7 - p) * A0 + p * A1) / 7.f;
+
+        for (Uint32 i = 0; i < 16; ++i)
+        {
+            Uint64 Best     = 0;
+            float  BestDist = 256;
+            for (Uint32 p = 0; p < 8; ++p)
+            {
+                const float Dist = std::abs(pBlock[i * 4 + 3] - Palette[p]);
+                if (Dist < BestDist)
+                {
+                    Best     = p;
+                    BestDist = Dist;
+                }
+            }
+            AlphaIndices |= Best << (i * 3);
+        }
+    }
+
+    pDst[0] = A0;
+    pDst[1] = A1;
+    for (Uint32 b = 0; b < 6; ++b)
+        pDst[2 + b] = static_cast<Uint8>(AlphaIndices >> (b * 8));
+
+    EncodeBC1Block(pBlock, pDst + 8);
+}
+
+void CompressImageBC(const Uint8* pSrc, Uint32 Width, Uint32 Height, size_t Stride, BC_FORMAT Format, std::vector<Uint8>& Dst)
+{
+    const Uint32 BlocksX   = (Width + 3) / 4;
+    const Uint32 BlocksY   = (Height + 3) / 4;
+    const Uint32 BlockSize = GetBCBlockSize(Format);
+    Dst.resize(size_t{BlocksX} * BlocksY * BlockSize);
+
+    Uint8 Block[16 * 4];
+    for (Uint32 by = 0; by < BlocksY; ++by)
+    {
+        for (Uint32 bx = 0; bx < BlocksX; ++bx)
+        {
+            for (Uint32 y = 0; y < 4; ++y)
+            {
+                const Uint32 SrcY = std::min(by * 4 + y, Height - 1);
+                for (Uint32 x = 0; x < 4; ++x)
+                {
+                    const Uint32 SrcX = std::min(bx * 4 + x, Width - 1);
+                    std::memcpy(Block + (y * 4 + x) * 4, pSrc + SrcY * Stride + SrcX * 4, 4);
+                }
+            }
+
+            Uint8* pBlockDst = Dst.data() + (size_t{by} * BlocksX + bx) * BlockSize;
+            if (Format == BC_FORMAT_BC1)
+                EncodeBC1Block(Block, pBlockDst);
+            else
+                EncodeBC3Block(Block, pBlockDst);
+        }
+    }
+}
+
+} // namespace Diligent
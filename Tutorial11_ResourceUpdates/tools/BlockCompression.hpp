@@ -0,0 +1,60 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "BasicTypes.h"
+
+namespace Diligent
+{
+
+// #Formatos que escribe el baker. BC1 es RGB con alfa de 1 bit (8 bytes por bloque de 4x4) y
+// BC3 agrega un bloque de alfa de 8 bytes (16 bytes por bloque)
+enum BC_FORMAT : Uint32
+{
+    BC_FORMAT_BC1 = 0,
+    BC_FORMAT_BC3
+};
+
+inline Uint32 GetBCBlockSize(BC_FORMAT Format)
+{
+    return Format == BC_FORMAT_BC1 ? 8 : 16;
+}
+
+// #pBlock son los 16 texels RGBA8 del bloque fila por fila. Los colores se comprimen tal cual
+// vienen (en sRGB), igual que los interpola el hardware con los formatos _SRGB
+void EncodeBC1Block(const Uint8* pBlock, Uint8* pDst);
+void EncodeBC3Block(const Uint8* pBlock, Uint8* pDst);
+
+// #Comprime una imagen RGBA8 completa. Los bloques del borde repiten el ultimo texel si el lado
+// no es multiplo de 4. Los bloques quedan fila por fila en Dst
+void CompressImageBC(const Uint8* pSrc, Uint32 Width, Uint32 Height, size_t Stride, BC_FORMAT Format, std::vector<Uint8>& Dst);
+
+} // namespace Diligent
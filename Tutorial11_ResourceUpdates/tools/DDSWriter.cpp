@@ -0,0 +1,126 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include <fstream>
+
+#include "DDSWriter.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// #Estructuras del formato DDS tal como estan en el archivo (todo en little endian)
+struct DDSPixelFormat
+{
+    Uint32 Size        = sizeof(DDSPixelFormat);
+    Uint32 Flags       = 0x4; // DDPF_FOURCC
+    Uint32 FourCC      = 0x30315844; // 'DX10'
+    Uint32 RGBBitCount = 0;
+    Uint32 RBitMask    = 0;
+    Uint32 GBitMask    = 0;
+    Uint32 BBitMask    = 0;
+    Uint32 ABitMask    = 0;
+};
+
+struct DDSHeader
+{
+    Uint32         Size              = sizeof(DDSHeader);
+    Uint32         Flags             = 0;
+    Uint32         Height            = 0;
+    Uint32         Width             = 0;
+    Uint32         PitchOrLinearSize = 0;
+    Uint32         Depth             = 0;
+    Uint32         MipMapCount       = 0;
+    Uint32         Reserved1[11]     = {};
+    DDSPixelFormat PixelFormat;
+    Uint32         Caps      = 0;
+    Uint32         Caps2     = 0;
+    Uint32         Caps3     = 0;
+    Uint32         Caps4     = 0;
+    Uint32         Reserved2 = 0;
+};
+static_assert(sizeof(DDSHeader) == 124, "DDS header must be 124 bytes");
+
+struct DDSHeaderDX10
+{
+    Uint32 DXGIFormat        = 0;
+    Uint32 ResourceDimension = 3; // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+    Uint32 MiscFlag          = 0;
+    Uint32 ArraySize         = 1;
+    Uint32 MiscFlags2        = 0;
+};
+static_assert(sizeof(DDSHeaderDX10) == 20, "DDS DX10 header must be 20 bytes");
+
+constexpr Uint32 DDSD_CAPS        = 0x1;
+constexpr Uint32 DDSD_HEIGHT      = 0x2;
+constexpr Uint32 DDSD_WIDTH       = 0x4;
+constexpr Uint32 DDSD_PIXELFORMAT = 0x1000;
+constexpr Uint32 DDSD_MIPMAPCOUNT = 0x20000;
+constexpr Uint32 DDSD_LINEARSIZE  = 0x80000;
+
+constexpr Uint32 DDSCAPS_COMPLEX = 0x8;
+constexpr Uint32 DDSCAPS_TEXTURE = 0x1000;
+constexpr Uint32 DDSCAPS_MIPMAP  = 0x400000;
+
+constexpr Uint32 DXGI_FORMAT_BC1_UNORM_SRGB = 72;
+constexpr Uint32 DXGI_FORMAT_BC3_UNORM_SRGB = 78;
+
+} // namespace
+
+bool WriteBCTextureDDS(const std::string& Path, BC_FORMAT Format, Uint32 Width, Uint32 Height, const std::vector<std::vector<Uint8>>& Mips)
+{
+    if (Mips.empty())
+        return false;
+
+    DDSHeader Header;
+    Header.Flags             = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+    Header.Height            = Height;
+    Header.Width             = Width;
+    Header.PitchOrLinearSize = static_cast<Uint32>(Mips[0].size());
+    Header.MipMapCount       = static_cast<Uint32>(Mips.size());
+    Header.Caps              = DDSCAPS_TEXTURE | (Mips.size() > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+
+    DDSHeaderDX10 HeaderDX10;
+    HeaderDX10.DXGIFormat = Format == BC_FORMAT_BC1 ? DXGI_FORMAT_BC1_UNORM_SRGB : DXGI_FORMAT_BC3_UNORM_SRGB;
+
+    std::ofstream File{Path, std::ios::binary};
+    if (!File)
+        return false;
+
+    const Uint32 Magic = 0x20534444; // 'DDS '
+    File.write(reinterpret_cast<const char*>(&Magic), sizeof(Magic));
+    File.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+    File.write(reinterpret_cast<const char*>(&HeaderDX10), sizeof(HeaderDX10));
+    for (const auto& Mip : Mips)
+        File.write(reinterpret_cast<const char*>(Mip.data()), static_cast<std::streamsize>(Mip.size()));
+
+    return static_cast<bool>(File);
+}
+
+} // namespace Diligent
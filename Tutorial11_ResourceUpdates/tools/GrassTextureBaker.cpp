@@ -0,0 +1,201 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+// #Herramienta offline que convierte las texturas del pasto en DDS comprimidos (BC1, o BC3 si
+// alguna tiene alfa) con todos los mips ya calculados, para que el sample no tenga que
+// decodificar PNGs ni generar mips al arrancar:
+//
+//   Tutorial11_GrassTextureBaker [--format auto|bc1|bc3] [--size <ancho> <alto>] <imagen.png>...
+//
+// Cada imagen.png se escribe como imagen.dds en la misma carpeta. Todas las salidas tienen el
+// mismo formato y tamano (el de la imagen mas grande si no se da --size), porque el sample las
+// pone en un solo Texture2DArray y solo usa los DDS si coinciden
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "TextureLoader.h"
+#include "ImageResample.hpp"
+#include "BlockCompression.hpp"
+#include "DDSWriter.hpp"
+
+using namespace Diligent;
+
+namespace
+{
+
+struct SourceImage
+{
+    std::string        Path;
+    Uint32             Width  = 0;
+    Uint32             Height = 0;
+    std::vector<Uint8> Texels; // #RGBA8 sRGB sin padding
+};
+
+bool LoadImage(const std::string& Path, SourceImage& Image)
+{
+    TextureLoadInfo LoadInfo;
+    LoadInfo.IsSRGB       = true;
+    LoadInfo.GenerateMips = false;
+
+    RefCntAutoPtr<ITextureLoader> pLoader;
+    CreateTextureLoaderFromFile(Path.c_str(), IMAGE_FILE_FORMAT_UNKNOWN, LoadInfo, &pLoader);
+    if (!pLoader || pLoader->GetTextureDesc().Format != TEX_FORMAT_RGBA8_UNORM_SRGB)
+        return false;
+
+    const auto& Desc = pLoader->GetTextureDesc();
+    const auto& Data = pLoader->GetSubresourceData(0);
+
+    Image.Path   = Path;
+    Image.Width  = Desc.Width;
+    Image.Height = Desc.Height;
+    Image.Texels.resize(size_t{Desc.Width} * Desc.Height * 4);
+    for (Uint32 y = 0; y < Desc.Height; ++y)
+        std::memcpy(&Image.Texels[size_t{y} * Desc.Width * 4], static_cast<const Uint8*>(Data.pData) + y * Data.Stride, size_t{Desc.Width} * 4);
+    return true;
+}
+
+bool HasAlpha(const SourceImage& Image)
+{
+    for (size_t i = 3; i < Image.Texels.size(); i += 4)
+    {
+        if (Image.Texels[i] != 255)
+            return true;
+    }
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string              FormatName = "auto";
+    Uint32                   Width = 0, Height = 0;
+    std::vector<std::string> Inputs;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string Arg = argv[i];
+        if (Arg == "--format" && i + 1 < argc)
+        {
+            FormatName = argv[++i];
+        }
+        else if (Arg == "--size" && i + 2 < argc)
+        {
+            Width  = static_cast<Uint32>(std::atoi(argv[++i]));
+            Height = static_cast<Uint32>(std::atoi(argv[++i]));
+        }
+        else
+        {
+            Inputs.push_back(Arg);
+        }
+    }
+    if (Inputs.empty() || (FormatName != "auto" && FormatName != "bc1" && FormatName != "bc3"))
+    {
+        std::cerr << "Usage: " << argv[0] << " [--format auto|bc1|bc3] [--size <width> <height>] <image.png>...\n";
+        return EXIT_FAILURE;
+    }
+
+    std::vector<SourceImage> Images(Inputs.size());
+    bool                     AnyAlpha = false;
+    for (size_t i = 0; i < Inputs.size(); ++i)
+    {
+        if (!LoadImage(Inputs[i], Images[i]))
+        {
+            std::cerr << "Failed to load " << Inputs[i] << " as an RGBA8 image\n";
+            return EXIT_FAILURE;
+        }
+        AnyAlpha = AnyAlpha || HasAlpha(Images[i]);
+    }
+
+    if (Width == 0 || Height == 0)
+    {
+        for (const auto& Image : Images)
+        {
+            Width  = std::max(Width, Image.Width);
+            Height = std::max(Height, Image.Height);
+        }
+    }
+
+    // #BC1 solo guarda alfa de 1 bit y el sample no lo usa, asi que con alfa se usa BC3
+    const BC_FORMAT Format = FormatName == "bc1" ? BC_FORMAT_BC1 :
+        FormatName == "bc3"                      ? BC_FORMAT_BC3 :
+                                                   (AnyAlpha ? BC_FORMAT_BC3 : BC_FORMAT_BC1);
+
+    for (auto& Image : Images)
+    {
+        std::vector<Uint8> Level;
+        if (Image.Width != Width || Image.Height != Height)
+        {
+            Level.resize(size_t{Width} * Height * 4);
+            ResampleRGBA8(Image.Texels.data(), Image.Width, Image.Height, size_t{Image.Width} * 4, Level.data(), Width, Height);
+        }
+        else
+        {
+            Level = std::move(Image.Texels);
+        }
+
+        // #Todos los mips hasta 1x1; cada uno sale del anterior
+        std::vector<std::vector<Uint8>> Mips;
+        Uint64                          RGBA8Bytes = 0;
+        Uint32                          MipW = Width, MipH = Height;
+        for (;;)
+        {
+            Mips.emplace_back();
+            CompressImageBC(Level.data(), MipW, MipH, size_t{MipW} * 4, Format, Mips.back());
+            RGBA8Bytes += Level.size();
+            if (MipW == 1 && MipH == 1)
+                break;
+
+            std::vector<Uint8> NextLevel(size_t{std::max(MipW / 2, 1u)} * std::max(MipH / 2, 1u) * 4);
+            DownsampleRGBA8_SRGB(Level.data(), MipW, MipH, size_t{MipW} * 4, NextLevel.data());
+            Level = std::move(NextLevel);
+            MipW  = std::max(MipW / 2, 1u);
+            MipH  = std::max(MipH / 2, 1u);
+        }
+
+        const auto ExtPos     = Image.Path.find_last_of('.');
+        const auto OutputPath = Image.Path.substr(0, ExtPos) + ".dds";
+        Uint64     BCBytes    = 0;
+        for (const auto& Mip : Mips)
+            BCBytes += Mip.size();
+
+        if (!WriteBCTextureDDS(OutputPath, Format, Width, Height, Mips))
+        {
+            std::cerr << "Failed to write " << OutputPath << "\n";
+            return EXIT_FAILURE;
+        }
+        std::cout << Image.Path << " -> " << OutputPath << ": " << Width << "x" << Height << ", " << Mips.size() << " mips, "
+                  << (Format == BC_FORMAT_BC1 ? "BC1" : "BC3") << ", " << (BCBytes >> 10) << " KB (" << (RGBA8Bytes >> 10)
+                  << " KB as RGBA8)\n";
+    }
+
+    return EXIT_SUCCESS;
+}